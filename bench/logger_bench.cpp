@@ -0,0 +1,241 @@
+#include "LoggerHandler.hpp"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+// logger_bench – throughput, call latency and allocations of the logger.
+//
+// Every benchmark reports, besides Google Benchmark's own timings:
+//   items_per_second   lines logged per second (per thread for threaded runs)
+//   p50_ns .. p999_ns  latency of one logging call, averaged over threads
+//   allocs_per_record  heap allocations per record, writer thread included
+//   alloc_bytes_per_record
+//
+// Asynchronous runs measure the calls; the writer is drained after the
+// timed loop, and the Block overflow policy makes a long run settle at the
+// writer's pace. Files go to bench_logs/ and are removed after each run.
+
+namespace {
+
+// Count every allocation while a run is being measured
+std::atomic<bool> countingEnabled{false};
+std::atomic<std::uint64_t> allocationCount{0};
+std::atomic<std::uint64_t> allocatedBytes{0};
+
+}
+
+void* operator new(std::size_t size) {
+    if (countingEnabled.load(std::memory_order_relaxed)) {
+        allocationCount.fetch_add(1, std::memory_order_relaxed);
+        allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    }
+    if (void* memory = std::malloc(size ? size : 1)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+namespace {
+
+enum SinkKind : std::int64_t { NullSink, FileSink, MmapSink, ConsoleSink };
+enum Mode : std::int64_t { Sync, Async, ThreadBuffered };
+enum Sharing : std::int64_t { SharedLogger, LoggerPerThread };
+
+const char* const benchDirectory = "bench_logs";
+constexpr std::size_t maxLatencySamples = 1 << 20; // per thread
+
+// Takes every batch and does nothing with it: the logger's own cost
+class DiscardSink : public LogSink {
+public:
+    void write(const LogSinkBatch&) override {
+    }
+};
+
+// Swallows console output so the sink does its work without flooding the report
+class DiscardBuffer : public std::streambuf {
+protected:
+    std::streamsize xsputn(const char*, std::streamsize count) override {
+        return count;
+    }
+    int_type overflow(int_type character) override {
+        return traits_type::not_eof(character);
+    }
+};
+
+// What the current run logs through (built before its threads start)
+struct BenchSetup {
+    std::vector<std::unique_ptr<LoggerHandler>> loggers;
+    std::vector<std::vector<std::uint32_t>> latencies; // nanoseconds, one list per thread
+    std::string message;
+    DiscardBuffer discard;
+    std::streambuf* savedCout = nullptr;
+};
+
+BenchSetup bench;
+
+void configureLoggers(std::size_t loggerCount, SinkKind sink, Mode mode,
+                      std::size_t messageSize, int threads) {
+    std::filesystem::create_directories(benchDirectory);
+    if (sink == ConsoleSink) {
+        bench.savedCout = std::cout.rdbuf(&bench.discard);
+    }
+
+    for (std::size_t i = 0; i < loggerCount; ++i) {
+        auto logger = std::make_unique<LoggerHandler>("Bench" + std::to_string(i));
+        std::string path = std::string(benchDirectory) + "/bench_" + std::to_string(i) + ".txt";
+
+        if (sink != ConsoleSink) {
+            logger->removeSink(logger->getConsoleSink());
+        }
+        if (sink == NullSink) {
+            logger->addSink(std::make_shared<DiscardSink>());
+        } else if (sink == FileSink) {
+            logger->enableFileLogging(path);
+        } else if (sink == MmapSink) {
+            logger->enableMappedFileLogging(path);
+        }
+
+        if (mode == Async) {
+            logger->enableAsyncLogging();
+        } else if (mode == ThreadBuffered) {
+            logger->enableThreadBufferedLogging();
+        }
+        bench.loggers.push_back(std::move(logger));
+    }
+
+    bench.message.assign(messageSize, 'm');
+    bench.latencies.assign(static_cast<std::size_t>(threads), std::vector<std::uint32_t>());
+    for (auto& samples : bench.latencies) {
+        samples.reserve(maxLatencySamples);
+    }
+
+    allocationCount = 0;
+    allocatedBytes = 0;
+    countingEnabled = true;
+}
+
+void teardown(const benchmark::State&) {
+    countingEnabled = false;
+    bench.loggers.clear();
+    bench.latencies.clear();
+    if (bench.savedCout != nullptr) {
+        std::cout.rdbuf(bench.savedCout);
+        bench.savedCout = nullptr;
+    }
+    std::error_code ignored;
+    std::filesystem::remove_all(benchDirectory, ignored);
+}
+
+std::uint32_t percentile(std::vector<std::uint32_t>& samples, double fraction) {
+    if (samples.empty()) {
+        return 0;
+    }
+    std::size_t rank = static_cast<std::size_t>(fraction * static_cast<double>(samples.size() - 1));
+    std::nth_element(samples.begin(), samples.begin() + static_cast<std::ptrdiff_t>(rank), samples.end());
+    return samples[rank];
+}
+
+// The timed loop shared by every benchmark
+void logLines(benchmark::State& state, LoggerHandler& logger) {
+    std::vector<std::uint32_t>& samples = bench.latencies[static_cast<std::size_t>(state.thread_index())];
+    const std::string& message = bench.message;
+
+    for (auto _ : state) {
+        auto started = std::chrono::steady_clock::now();
+        logger.logMessage(message);
+        auto elapsed = std::chrono::steady_clock::now() - started;
+        if (samples.size() < maxLatencySamples) {
+            samples.push_back(static_cast<std::uint32_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+        }
+    }
+    logger.flush();
+
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()));
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * message.size()));
+    state.counters["p50_ns"] = benchmark::Counter(percentile(samples, 0.5), benchmark::Counter::kAvgThreads);
+    state.counters["p99_ns"] = benchmark::Counter(percentile(samples, 0.99), benchmark::Counter::kAvgThreads);
+    state.counters["p999_ns"] = benchmark::Counter(percentile(samples, 0.999), benchmark::Counter::kAvgThreads);
+
+    // Every thread's records, against allocations made by all threads so far
+    double records = static_cast<double>(state.iterations()) * state.threads();
+    state.counters["allocs_per_record"] =
+        benchmark::Counter(static_cast<double>(allocationCount.load()) / records, benchmark::Counter::kAvgThreads);
+    state.counters["alloc_bytes_per_record"] =
+        benchmark::Counter(static_cast<double>(allocatedBytes.load()) / records, benchmark::Counter::kAvgThreads);
+}
+
+// Sinks: {sink, message size}, synchronous, one thread
+void setupSinks(const benchmark::State& state) {
+    configureLoggers(1, static_cast<SinkKind>(state.range(0)), Sync,
+                     static_cast<std::size_t>(state.range(1)), state.threads());
+}
+
+void BM_Sinks(benchmark::State& state) {
+    logLines(state, *bench.loggers.front());
+}
+
+// Modes: {mode, sink}, 256-byte messages, 1..N threads on one logger
+void setupModes(const benchmark::State& state) {
+    configureLoggers(1, static_cast<SinkKind>(state.range(1)), static_cast<Mode>(state.range(0)),
+                     256, state.threads());
+}
+
+void BM_Modes(benchmark::State& state) {
+    logLines(state, *bench.loggers.front());
+}
+
+// Sharing: {sharing, sink}, synchronous, 1..N threads on one logger (one
+// sink lock) or on a logger each (a lock per thread)
+void setupSharing(const benchmark::State& state) {
+    std::size_t loggerCount = state.range(0) == SharedLogger ? 1 : static_cast<std::size_t>(state.threads());
+    configureLoggers(loggerCount, static_cast<SinkKind>(state.range(1)), Sync, 256, state.threads());
+}
+
+void BM_Sharing(benchmark::State& state) {
+    std::size_t index = state.range(0) == SharedLogger ? 0 : static_cast<std::size_t>(state.thread_index());
+    logLines(state, *bench.loggers[index]);
+}
+
+}
+
+BENCHMARK(BM_Sinks)
+    ->ArgNames({"sink", "bytes"})
+    ->ArgsProduct({{NullSink, FileSink, MmapSink, ConsoleSink}, {16, 256, 4096, 16384}})
+    ->Setup(setupSinks)
+    ->Teardown(teardown);
+
+BENCHMARK(BM_Modes)
+    ->ArgNames({"mode", "sink"})
+    ->ArgsProduct({{Sync, Async, ThreadBuffered}, {NullSink, FileSink}})
+    ->ThreadRange(1, 8)
+    ->UseRealTime()
+    ->Setup(setupModes)
+    ->Teardown(teardown);
+
+BENCHMARK(BM_Sharing)
+    ->ArgNames({"sharing", "sink"})
+    ->ArgsProduct({{SharedLogger, LoggerPerThread}, {NullSink, FileSink}})
+    ->ThreadRange(1, 8)
+    ->UseRealTime()
+    ->Setup(setupSharing)
+    ->Teardown(teardown);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "LoggerExport.hpp"
+
+struct LogArenaSlab;
+
+// Bytes of one queued record, held in a slab of the thread that logged it.
+// Move-only; the bytes go back to their slab when the block is destroyed or
+// assigned over.
+class LOGGER_API LogArenaBlock {
+public:
+    LogArenaBlock() = default;
+    ~LogArenaBlock() {
+        release();
+    }
+
+    LogArenaBlock(LogArenaBlock&& other) noexcept
+    : slab(other.slab), bytes(other.bytes), length(other.length) {
+        other.slab = nullptr;
+        other.bytes = nullptr;
+        other.length = 0;
+    }
+
+    LogArenaBlock& operator=(LogArenaBlock&& other) noexcept {
+        if (this != &other) {
+            release();
+            slab = other.slab;
+            bytes = other.bytes;
+            length = other.length;
+            other.slab = nullptr;
+            other.bytes = nullptr;
+            other.length = 0;
+        }
+        return *this;
+    }
+
+    LogArenaBlock(const LogArenaBlock&) = delete;
+    LogArenaBlock& operator=(const LogArenaBlock&) = delete;
+
+    const char* data() const {
+        return bytes != nullptr ? bytes : "";
+    }
+
+    std::size_t size() const {
+        return length;
+    }
+
+    bool empty() const {
+        return length == 0;
+    }
+
+    // Give the bytes back now instead of at destruction
+    void release() {
+        if (slab != nullptr) {
+            releaseSlab();
+        }
+    }
+
+private:
+    friend class LogArena;
+
+    void releaseSlab();
+
+    LogArenaSlab* slab = nullptr;
+    char* bytes = nullptr;
+    std::size_t length = 0;
+};
+
+// Per-thread slab allocator for queued record payloads.
+//
+// Each thread carves its records' bytes out of its own 64 KiB slab with a
+// pointer bump; a slab counts the blocks still alive in it. Once the writer
+// thread has written (and so released) every record of a slab the thread
+// has moved past, the slab returns to that thread's free list and is reused,
+// so after warm-up an asynchronous logger neither allocates nor frees per
+// record. Slabs are only exchanged under a per-thread lock, once per slab,
+// never per record.
+//
+// Payloads larger than a quarter slab get a block of their own from the
+// heap. A thread's free slabs are released when it exits; slabs still in
+// use are released by whoever frees their last block.
+class LOGGER_API LogArena {
+public:
+    static constexpr std::size_t slabSize = 64 * 1024;
+    static constexpr std::size_t largestSlabBlock = slabSize / 4;
+
+    // Copy first then second into one block from the calling thread's arena
+    static LogArenaBlock copy(std::string_view first, std::string_view second = std::string_view());
+
+    // Slabs currently allocated by all threads (each slabSize bytes)
+    static std::size_t getAllocatedSlabs();
+};
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "LoggerExport.hpp"
+#include "LogFileWriter.hpp"
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <sys/uio.h>
+#endif
+
+// File writer that keeps several writes in flight.
+//
+// Each write() copies its bytes into a free buffer and submits it at the
+// file offset it will occupy, then returns: the caller goes back to
+// formatting while the disk works. Buffers are recycled as their writes
+// complete; only when all of them are in flight does write() wait for the
+// oldest. Because every write carries its own offset, completions may
+// arrive in any order without reordering the file.
+//
+// Linux uses io_uring through its system calls directly (no liburing),
+// Windows overlapped WriteFile with one event per buffer. open() fails where
+// neither is available (or io_uring is disabled), and LogFileWriter::open
+// then falls back to blocking writes. Short writes are resubmitted. A failed
+// write would leave a hole the later writes are already placed behind, so
+// the writer waits for those, truncates the file back to where the failed
+// one stopped and carries on from there; every write lost that way counts
+// as failed. Writes go to explicit offsets from the size the file had when
+// opened, so nothing else may append to the file meanwhile.
+class LOGGER_API LogAsyncFileWriter : public LogFileWriter {
+public:
+    static constexpr std::size_t defaultBuffersInFlight = 4;
+
+    LogAsyncFileWriter() = default;
+    ~LogAsyncFileWriter() override;
+
+    LogAsyncFileWriter(const LogAsyncFileWriter&) = delete;
+    LogAsyncFileWriter& operator=(const LogAsyncFileWriter&) = delete;
+
+    bool open(const std::string& filePath, std::size_t buffersInFlight = defaultBuffersInFlight);
+    bool isOpen() const;
+
+    void write(const char* data, std::size_t length) override;
+    void flush() override;
+    void close() override;
+    // Only system calls and memory accesses on the rings
+    void crashFlush() override;
+
+    std::uint64_t getFailedWrites() const;
+
+private:
+    struct Buffer {
+        std::vector<char> data;
+        std::size_t length = 0;    // bytes still to write
+        std::size_t written = 0;   // bytes already written (after a short write)
+        std::uint64_t offset = 0;  // file offset of data[0]
+        bool inFlight = false;
+        bool failed = false;
+#ifdef _WIN32
+        OVERLAPPED overlapped{};
+#else
+        iovec vector{};
+#endif
+    };
+
+    bool submit(std::size_t index);
+    // Wait for at least one completion (or reap what is ready when wait is false)
+    void reap(bool wait);
+    void complete(std::size_t index, long long result);
+    // Give up on a buffer's write and mark the file for truncation where it stopped
+    void fail(std::size_t index);
+    // After a failure: wait for every write, then cut the file back to the failed one
+    void rewind();
+    std::size_t inFlightCount() const;
+
+    std::vector<Buffer> buffers;
+    std::size_t nextBuffer = 0;
+    std::uint64_t fileOffset = 0;
+    std::uint64_t failedWrites = 0;
+    static constexpr std::uint64_t noRewind = ~std::uint64_t{0};
+    std::uint64_t rewindOffset = noRewind; // lowest offset a failed write stopped at
+    bool opened = false;
+
+#ifdef _WIN32
+    HANDLE fileHandle = INVALID_HANDLE_VALUE;
+#else
+    int descriptor = -1;
+
+    // io_uring: the ring descriptor and the rings shared with the kernel
+    int ringDescriptor = -1;
+    void* submissionRing = nullptr;
+    std::size_t submissionRingSize = 0;
+    void* completionRing = nullptr;
+    std::size_t completionRingSize = 0;
+    void* submissionEntries = nullptr;
+    std::size_t submissionEntriesSize = 0;
+    unsigned* submissionHead = nullptr;
+    unsigned* submissionTail = nullptr;
+    unsigned* submissionMask = nullptr;
+    unsigned* submissionArray = nullptr;
+    unsigned* completionHead = nullptr;
+    unsigned* completionTail = nullptr;
+    unsigned* completionMask = nullptr;
+    void* completionEntries = nullptr;
+#endif
+};
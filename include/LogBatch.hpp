@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+#include "LoggerHandler.hpp"
+
+// Lines collected on the caller's side and written as one block.
+//
+//     LogBatch batch(logger);
+//     for (const auto& row : rows) {
+//         batch.log(LogLevel::Message, "row {} -> {}", row.id, row.status);
+//     }
+//     batch.commit(); // or let the destructor do it
+//
+// Each line keeps its own timestamp, taken when it was added. A commit
+// renders every line into one buffer and hands it to each sink in a single
+// call under a single lock, so the lines of a batch are never interleaved
+// with lines from other threads. In asynchronous mode the batch is queued
+// as one record. A batch must not be shared between threads.
+class LOGGER_API LogBatch {
+public:
+    explicit LogBatch(LoggerHandler& logger);
+    ~LogBatch();
+
+    LogBatch(const LogBatch&) = delete;
+    LogBatch& operator=(const LogBatch&) = delete;
+
+    void log(LogLevel level, std::string_view message);
+
+    // "{}" formatting; arguments are formatted when the line is added
+    template <typename... Args>
+    std::enable_if_t<(sizeof...(Args) > 0)> log(LogLevel level, std::string_view format, const Args&... args) {
+        if (!logger.isEnabled(level) || level == LogLevel::Off) {
+            return;
+        }
+        scratch.clear();
+        LogFormatter::format(scratch, format, args...);
+        add(level, scratch.data(), scratch.size());
+    }
+
+    // Write the pending lines (the batch can then be reused)
+    void commit();
+
+    // Lines waiting for commit()
+    std::size_t size() const;
+
+private:
+    void add(LogLevel level, const char* message, std::size_t length);
+
+    LoggerHandler& logger;
+    std::string payload;
+    std::size_t lineCount = 0;
+    LogLevel highestLevel = LogLevel::Message;
+    LogLineBuffer scratch;
+};
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "LoggerExport.hpp"
+#include "LogCallSite.hpp"
+#include "LogLevel.hpp"
+#include "LogLineBuffer.hpp"
+
+// Binary log file layout. Integers are little-endian; varints are LEB128.
+//
+//   file header  'L' 'O' 'G' 'B' version:u8
+//   logger name  0x01 id:varint length:varint bytes
+//   record       0x02 timestamp:i64 (ns since the epoch) level:u8
+//                     loggerId:varint length:varint bytes
+//   call site    0x03 id:varint line:varint level:u8 file function format
+//                     (each string length:varint bytes; version 2)
+//   site record  0x04 timestamp:i64 level:u8 loggerId:varint thread:varint
+//                     callSite:varint length:varint bytes (version 2)
+//
+// Logger names are interned: each is written once, before the first record
+// that uses its id, instead of being padded into every line. Call sites
+// (see LogCallSites) are interned the same way, so a record logged through
+// the LOGGER_*_AT macros carries two ids instead of a file name, line and
+// function. A file header
+// may appear again later in a file (after a rotation or when a process
+// appends to an existing file); the names that follow it replace earlier
+// definitions of the same ids.
+class LOGGER_API LogBinaryFormat {
+public:
+    static constexpr std::uint8_t version = 2;
+
+    enum Tag : std::uint8_t {
+        LoggerNameTag  = 0x01,
+        RecordTag      = 0x02,
+        CallSiteTag    = 0x03,
+        SiteRecordTag  = 0x04,
+        FileHeaderTag  = 'L'
+    };
+
+    static void appendFileHeader(std::string& out);
+    static void appendLoggerName(std::string& out, std::uint32_t loggerId, std::string_view loggerName);
+    static void appendRecord(LogLineBuffer& out, std::int64_t timestampNanoseconds, LogLevel level,
+                             std::uint32_t loggerId, const char* message, std::size_t messageLength);
+    static void appendCallSite(LogLineBuffer& out, std::uint32_t callSiteId, const LogCallSite& site);
+    static void appendSiteRecord(LogLineBuffer& out, std::int64_t timestampNanoseconds, LogLevel level,
+                                 std::uint32_t loggerId, std::uint32_t thread, std::uint32_t callSiteId,
+                                 const char* message, std::size_t messageLength);
+
+    static void appendVarint(LogLineBuffer& out, std::uint64_t value);
+};
+
+// One decoded record
+struct LogBinaryRecord {
+    std::int64_t timestampNanoseconds = 0;
+    LogLevel level = LogLevel::Message;
+    std::uint32_t loggerId = 0;
+    std::uint32_t thread = 0;   // 0 unless logged with a call site
+    std::uint32_t callSite = 0; // LogCallSites::none without one
+    std::string message;
+};
+
+// A call site as defined in a binary log
+struct LogBinaryCallSite {
+    std::string file;
+    std::uint32_t line = 0;
+    std::string function;
+    LogLevel level = LogLevel::Message;
+    std::string format;
+};
+
+// Reads records back from a binary log stream
+class LOGGER_API LogBinaryReader {
+public:
+    explicit LogBinaryReader(std::istream& input);
+
+    // Next record, or false at the end of the stream or on corrupt data
+    bool next(LogBinaryRecord& record);
+
+    // True if reading stopped on data that is not in the format
+    bool failed() const;
+
+    // Name interned for a logger id (empty if it was never defined)
+    const std::string& loggerName(std::uint32_t loggerId) const;
+
+    // Call site defined for an id, or null
+    const LogBinaryCallSite* callSite(std::uint32_t callSiteId) const;
+
+private:
+    bool readVarint(std::uint64_t& value);
+    bool readBytes(char* data, std::size_t length);
+    bool readString(std::string& text);
+    bool readRecord(LogBinaryRecord& record, bool withSite);
+
+    std::istream& input;
+    std::vector<std::string> loggerNames;
+    std::vector<LogBinaryCallSite> callSites;
+    bool corrupt = false;
+};
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "LoggerExport.hpp"
+#include "LogLevel.hpp"
+
+// Where a record was logged from: one entry per logging statement
+struct LogCallSite {
+    const char* file;
+    std::uint32_t line;
+    const char* function;
+    LogLevel level;
+    const char* format; // the format or message literal, or null if it was not a literal
+};
+
+class LogCallSiteHandle;
+
+// The process-wide table of call sites.
+//
+// Each LOGGER_*_AT statement registers itself once, on its first record, and
+// after that its records carry only the site's 32-bit id; sinks look the id
+// up when they write. The table only grows and its entries never move, so
+// find() takes no lock and is safe from the crash handler.
+class LOGGER_API LogCallSites {
+public:
+    static constexpr std::uint32_t none = 0;
+    static constexpr std::uint32_t unregistered = UINT32_MAX; // the table was full
+    static constexpr std::size_t capacity = 1 << 20;
+
+    // Register a call site (the strings must outlive the process, as literals
+    // and __FILE__ do); unregistered once the table is full
+    static std::uint32_t intern(const char* file, std::uint32_t line, const char* function,
+                                LogLevel level, const char* format);
+
+    // Register a statement's handle unless another thread just did
+    static std::uint32_t intern(LogCallSiteHandle& handle, const char* format);
+
+    // The site registered under an id, or null
+    static const LogCallSite* find(std::uint32_t id);
+
+    static std::uint32_t count();
+};
+
+// A logging statement's call site, declared by the LOGGER_*_AT macros as a
+// function-local static (constant-initialized, so it costs no guard check)
+class LogCallSiteHandle {
+public:
+    constexpr LogCallSiteHandle(const char* file, std::uint32_t line, const char* function, LogLevel level)
+    : file(file), line(line), function(function), level(level) {
+    }
+
+    LogCallSiteHandle(const LogCallSiteHandle&) = delete;
+    LogCallSiteHandle& operator=(const LogCallSiteHandle&) = delete;
+
+    // The site's id, registering it with the given format on first use
+    std::uint32_t id(const char* format) {
+        std::uint32_t registered = siteId.load(std::memory_order_acquire);
+        return registered != LogCallSites::none ? registered : LogCallSites::intern(*this, format);
+    }
+
+private:
+    friend class LogCallSites;
+
+    const char* file;
+    std::uint32_t line;
+    const char* function;
+    LogLevel level;
+    std::atomic<std::uint32_t> siteId{LogCallSites::none};
+};
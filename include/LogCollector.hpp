@@ -0,0 +1,90 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "LoggerExport.hpp"
+#include "LogSink.hpp"
+#include "LogSharedMemoryChannel.hpp"
+
+struct LogCollectorOptions {
+    std::string channelName = "logger";
+    LogSinkFormat format = LogSinkFormat::Text; // the lines the channel carries
+    std::size_t ringCount = LogSharedMemoryChannel::defaultRingCount;  // producers at once
+    std::size_t ringBytes = LogSharedMemoryChannel::defaultRingBytes;  // per producer
+    std::chrono::milliseconds idleWait{5};      // sleep after a round that found nothing
+    std::chrono::milliseconds reclaimInterval{1000}; // how often rings of dead producers are freed
+};
+
+// The one writer for many processes: creates a shared-memory channel (see
+// LogSharedMemoryChannel) and drains every producer's ring into its own
+// sinks (file with rotation, network, console, ...).
+//
+// Each round takes everything the rings hold, orders it by timestamp and
+// hands it to each sink as one batch, so lines from different processes
+// reach the file in time order (within a round) from a single writer.
+// Producers are never woken or waited for, and the collector only sleeps
+// for idleWait after a round that found nothing. Rings released by their
+// process, or left behind by one that died, are freed once drained.
+//
+// Sinks must take the channel's format. The collector's thread is their
+// only caller (or the thread calling collect() when it is not started).
+class LOGGER_API LogCollector {
+public:
+    explicit LogCollector(const LogCollectorOptions& options = LogCollectorOptions());
+    // Stops, drains what is left and removes the channel
+    ~LogCollector();
+
+    LogCollector(const LogCollector&) = delete;
+    LogCollector& operator=(const LogCollector&) = delete;
+
+    // False if the channel could not be created
+    bool isOpen() const;
+    const LogCollectorOptions& getOptions() const;
+
+    // Add sinks before start(); false for a sink of another format
+    bool addSink(std::shared_ptr<LogSink> sink);
+
+    // Drain on a background thread until stop()
+    void start();
+    void stop();
+
+    // One round on the calling thread; returns the records written
+    std::size_t collect();
+    void flush();
+
+    std::uint64_t getCollectedRecords() const;
+    // Records producers dropped because their ring was full
+    std::uint64_t getDroppedRecords() const;
+    // Rings claimed by producers as of the last reclaim
+    std::size_t getProducerCount() const;
+
+private:
+    void collectorLoop();
+
+    LogCollectorOptions options;
+    LogSharedMemoryChannel channel;
+    std::vector<std::shared_ptr<LogSink>> sinks;
+    std::atomic<std::uint64_t> collectedRecords{0};
+    std::atomic<std::uint64_t> droppedRecords{0};
+    std::atomic<std::size_t> producerCount{0};
+    std::chrono::steady_clock::time_point nextReclaim{};
+
+    // Owned by whichever thread collects
+    LogSinkBatch roundBatch;
+    LogSinkBatch orderedBatch;
+    std::vector<std::size_t> order;
+
+    std::mutex stateMutex;
+    std::condition_variable wake;
+    bool stopping = false;
+    std::thread collectorThread;
+};
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "LoggerExport.hpp"
+
+// Compression formats for log files
+enum class LogCompression {
+    None,
+    Gzip, // needs zlib (LOGGER_WITH_ZLIB)
+    Zstd  // needs libzstd (LOGGER_WITH_ZSTD)
+};
+
+// Block compression for log files.
+//
+// Every block becomes a complete gzip member or zstd frame. Both formats
+// allow members/frames to be concatenated, so a file built block by block
+// is a normal .gz/.zst file, and one cut short by a crash still
+// decompresses up to its last complete block.
+class LOGGER_API LogCompressor {
+public:
+    // Whether this build was compiled with support for the format
+    static bool isAvailable(LogCompression compression);
+
+    // File name extension including the dot (".gz", ".zst"), empty for None
+    static const char* extension(LogCompression compression);
+
+    // Compress one self-contained block into out (replacing its contents)
+    static bool compressBlock(LogCompression compression, int level,
+                              const char* data, std::size_t size, std::vector<char>& out);
+
+    // Compress sourcePath into destinationPath block by block
+    static bool compressFile(LogCompression compression, int level,
+                             const std::string& sourcePath, const std::string& destinationPath);
+
+    static constexpr std::size_t fileBlockSize = 1024 * 1024;
+};
@@ -0,0 +1,162 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "LoggerExport.hpp"
+#include "LogLevel.hpp"
+
+// The settings a logger reads on every record, as one immutable snapshot.
+//
+// A change copies the current snapshot, edits the copy and publishes it
+// with a single atomic pointer swap (see LoggerHandler::setConfig), so a
+// logging thread reads its settings with one pointer load and no lock, under
+// the LogReclaimer guard it pins once per record, and each record sees
+// either the old settings or the new ones, never a mix.
+struct LogConfig {
+    static constexpr std::size_t levelCount = static_cast<std::size_t>(LogLevel::Off) + 1;
+
+    LogLevel minLevel = LogLevel::Message;
+
+    // Sampling per level (Off included so any level indexes safely): the
+    // fraction of records kept, and whether that is one in every n records
+    // (counted) or a probability
+    float sampleRates[levelCount] = {1.0f, 1.0f, 1.0f, 1.0f, 1.0f};
+    bool sampleCounted[levelCount] = {false, false, false, false, false};
+
+    bool collapseRepeats = false;
+
+    bool enables(LogLevel level) const {
+        return static_cast<std::uint8_t>(level) >= static_cast<std::uint8_t>(minLevel);
+    }
+
+    bool operator==(const LogConfig& other) const {
+        for (std::size_t index = 0; index < levelCount; ++index) {
+            if (sampleRates[index] != other.sampleRates[index] ||
+                sampleCounted[index] != other.sampleCounted[index]) {
+                return false;
+            }
+        }
+        return minLevel == other.minLevel && collapseRepeats == other.collapseRepeats;
+    }
+};
+
+// One level's sampling as read from a config file
+struct LogSampling {
+    float rate = 1.0f;
+    bool counted = false;
+};
+
+// What a config file sets for one logger; unset settings are left as they are
+struct LogConfigSettings {
+    std::optional<LogLevel> minLevel;
+    std::optional<LogSampling> sampling[LogConfig::levelCount];
+    std::optional<bool> collapseRepeats;
+    std::optional<std::chrono::milliseconds> metricsInterval;
+    std::optional<std::string> pattern;  // line layout (see LogPattern)
+    std::optional<std::string> filePath; // text file logging; "" turns it off
+};
+
+// A config file: "key = value" lines, '#' or ';' comments.
+//
+//   level = warning                     message, success, warning, error, off
+//   sample_every = 10                   every level; or sample_every.message = 10
+//   sample_probability.success = 0.25
+//   collapse_repeats = true
+//   metrics_interval_ms = 60000         0 turns the summary line off
+//   pattern = "{utc} {level} "          quotes keep the spaces around a value
+//   file = logs/app.log
+//
+//   [Database]
+//   level = message
+//
+// Keys before the first section apply to every logger; a "[name]" section's
+// keys apply to that logger only, on top of the global ones. The whole file
+// is parsed before anything is applied, and a file with a bad line applies
+// nothing.
+class LOGGER_API LogConfigFile {
+public:
+    // False on the first bad line (see error())
+    bool parse(std::string_view text);
+    bool load(const std::string& path);
+
+    bool isValid() const;
+    const std::string& error() const;
+
+    // The global settings with the logger's own section on top
+    LogConfigSettings settingsFor(const std::string& loggerName) const;
+
+private:
+    bool parseSetting(std::string_view key, std::string_view value, LogConfigSettings& settings);
+
+    bool valid = false;
+    std::string errorText = "nothing parsed";
+    LogConfigSettings global;
+    std::vector<std::pair<std::string, LogConfigSettings>> sections;
+};
+
+class LoggerHandler;
+
+// Re-reads a config file and applies it to every logger in LogRegistry,
+// and to the ones passed to watch(), when the process gets SIGHUP (POSIX
+// only), when reload() is called, or, given a poll interval, when the
+// file's modification time changes.
+//
+// The signal handler only bumps a counter; the file is read and applied on
+// the reloader's own thread, so neither the handler nor any logging thread
+// does the work. Loggers keep logging throughout: levels and sampling
+// switch with an atomic swap, and only a changed file path reopens a file.
+class LOGGER_API LogConfigReloader {
+public:
+    // How often the reloader's thread looks for a SIGHUP
+    static constexpr std::chrono::milliseconds signalCheckInterval{100};
+
+    explicit LogConfigReloader(const std::string& path,
+                               std::chrono::milliseconds pollInterval = std::chrono::milliseconds(0));
+    ~LogConfigReloader();
+
+    LogConfigReloader(const LogConfigReloader&) = delete;
+    LogConfigReloader& operator=(const LogConfigReloader&) = delete;
+
+    // Also reconfigure a logger outside the registry (unwatch it, or destroy
+    // the reloader, before the logger goes away)
+    void watch(LoggerHandler& logger);
+    void unwatch(LoggerHandler& logger);
+
+    // Read and apply the file now, on the calling thread; false if it could
+    // not be read or parsed (each logger reports why on its console)
+    bool reload();
+    std::uint64_t getReloadCount() const;
+
+    // Hook SIGHUP (done by the constructor; nothing on Windows)
+    static void installSignalHandler();
+
+private:
+    void run();
+    bool fileChanged();
+
+    std::string path;
+    std::chrono::milliseconds pollInterval;
+    std::filesystem::file_time_type lastWriteTime{};
+    std::uint64_t hangupsSeen = 0;
+    std::atomic<std::uint64_t> reloads{0};
+
+    std::mutex reloadMutex; // one reload at a time; guards watched
+    std::vector<LoggerHandler*> watched;
+
+    std::mutex stateMutex;
+    std::condition_variable wake;
+    bool stopping = false;
+    std::thread thread;
+};
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "LoggerExport.hpp"
+#include "LogSink.hpp"
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    // Linux/macOS console colours via ANSI escape codes
+    #define FOREGROUND_RED          0x0001
+    #define FOREGROUND_GREEN        0x0002
+    #define FOREGROUND_BLUE         0x0004
+    #define FOREGROUND_INTENSITY    0x0008
+    typedef unsigned short WORD;
+#endif
+
+// Colour-coded text lines on standard output.
+//
+// Each line is assembled as colour + text + reset + newline from escape
+// sequences computed once per process, and a whole batch reaches stdout in
+// one write. Output is collected and flushed by a LogFlushPolicy: on a
+// terminal every batch is written straight away, otherwise (pipes,
+// journald, docker) lines collect up to the policy's size, age or level
+// limits; a process-wide flusher thread writes out lines older than
+// maxDelay when no later write does. Loggers that print to the same
+// terminal share one console mutex so their lines never interleave: sinks
+// on the same mutex also share one collected buffer, so lines keep the
+// order they were written in. The sink takes the mutex once per batch.
+struct LogConsoleOutput;
+
+class LOGGER_API LogConsoleSink : public LogSink {
+public:
+    LogConsoleSink();
+    explicit LogConsoleSink(std::mutex& consoleMutex);
+    ~LogConsoleSink() override;
+
+    void setFlushPolicy(const LogFlushPolicy& flushPolicy);
+    LogFlushPolicy getFlushPolicy();
+
+    void write(const LogSinkBatch& batch) override;
+    void flush() override;
+    void flushIfDue() override;
+
+    // Plain write() to standard output, without colours
+    void crashFlush() override;
+    void crashWrite(const char* record, std::size_t length) override;
+
+private:
+    void initConsole();
+    void makeRoom(std::size_t length);
+    void appendLine(const LogSinkBatch& batch, const LogSinkEntry& entry);
+    void writePending();
+    void scheduleFlush();
+#ifdef _WIN32
+    void writeWithAttributes(const LogSinkBatch& batch);
+#endif
+
+    std::mutex ownMutex;
+    std::mutex& consoleMutex;
+
+    // Collected output, shared with the other sinks on consoleMutex
+    std::shared_ptr<LogConsoleOutput> output;
+
+    // Guarded by consoleMutex
+    LogFlushPolicy policy;
+    bool useColors = false;
+
+#ifdef _WIN32
+    HANDLE consoleHandle = nullptr;
+    bool useAttributes = false; // legacy console without escape sequence support
+#endif
+};
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+
+#include "LoggerExport.hpp"
+
+class LoggerHandler;
+
+// Last-chance output of buffered log data when the process dies.
+//
+// install() hooks fatal signals (SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT;
+// unhandled structured exceptions on Windows) and std::terminate. On a
+// crash every live logger writes out what its sinks have buffered, then
+// every record still queued for its writer thread, then a marker line,
+// using only async-signal-safe calls (open/write, no locks, no
+// allocation). The signal is then re-raised with its default action so the
+// process still dies and dumps core as it would have. Lines longer than
+// LogLineBuffer::inlineCapacity are cut short in the dump, and timestamps
+// use the UTC offset in effect at install(). Per logger, at most 32 sinks
+// and 256 thread buffers are dumped.
+class LOGGER_API LogCrashHandler {
+public:
+    // Loggers that can be registered at once; later ones are not dumped
+    static constexpr std::size_t maxLoggers = 256;
+
+    static void install();
+    static bool isInstalled();
+
+    // Dump every registered logger now (what the handlers call)
+    static void dump(const char* reason);
+
+    // Called by LoggerHandler's constructors and destructor
+    static void registerLogger(LoggerHandler* logger);
+    static void unregisterLogger(LoggerHandler* logger);
+};
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "LoggerExport.hpp"
+#include "LogLevel.hpp"
+#include "LogCompressor.hpp"
+#include "LogSink.hpp"
+#include "LogFileWriter.hpp"
+
+// Time-based rotation boundaries (local time)
+enum class LogRotationInterval {
+    None,
+    Hourly,
+    Daily
+};
+
+// When a file sink starts a new file, and how many old files it keeps
+struct LogRotationPolicy {
+    std::uint64_t maxFileBytes = 0;                      // rotate once a file reaches this size (0 = never)
+    LogRotationInterval interval = LogRotationInterval::None;
+    std::size_t maxFiles = 0;                            // rotated files of the path to keep (0 = keep all)
+};
+
+// Optional compression of a file sink's output
+struct LogCompressionPolicy {
+    LogCompression rotatedFiles = LogCompression::None; // compress files once rotated
+    LogCompression stream = LogCompression::None;       // compress each buffer flush as it is written
+    int level = 6;
+};
+
+// Append-only log file with a large user-space buffer.
+//
+// Lines collect in the buffer and reach the file in one write when the
+// flush policy says so, instead of once per line. The time limit is checked
+// whenever a line is written and by flushIfDue(), which the asynchronous
+// writer calls while idle.
+//
+// With a rotation policy, a background thread owned by the sink does the
+// slow part of rotation: closing the full file, renaming it to
+// "<path>.<YYYYMMDD-HHMMSS>", opening a fresh file at <path> and deleting
+// the oldest rotated files beyond maxFiles (every file next to <path> named
+// that way, including those of earlier runs). The writing side only hands its stream to
+// that thread and keeps buffering until the new stream is ready to be
+// swapped in, so rotation never blocks on the filesystem. Rotated files
+// to be compressed go to a second thread at low priority, which also does
+// the pruning then, so the hand-off never waits behind a compression.
+//
+// With the Async I/O backend (LogFlushPolicy::ioBackend) a full buffer is
+// submitted and the sink carries on buffering while the write completes;
+// only flush() waits for the writes in flight.
+//
+// With stream compression every buffer flush is written as one
+// self-contained compressed block, so the file stays readable up to the
+// last flush even if the process dies.
+//
+// Not thread-safe: the owner serialises access.
+class LOGGER_API LogFileSink : public LogSink {
+public:
+    explicit LogFileSink(LogSinkFormat format = LogSinkFormat::Text);
+    ~LogFileSink() override;
+
+    LogFileSink(const LogFileSink&) = delete;
+    LogFileSink& operator=(const LogFileSink&) = delete;
+
+    bool open(const std::string& filePath);
+    void close();
+    bool isOpen() const;
+
+    void setFlushPolicy(const LogFlushPolicy& flushPolicy);
+    const LogFlushPolicy& getFlushPolicy() const;
+
+    // Takes effect the next time the sink is opened
+    void setRotationPolicy(const LogRotationPolicy& rotationPolicy);
+    const LogRotationPolicy& getRotationPolicy() const;
+
+    // Takes effect the next time the sink is opened
+    void setCompressionPolicy(const LogCompressionPolicy& compressionPolicy);
+    const LogCompressionPolicy& getCompressionPolicy() const;
+
+    // Bytes written at the start of every file the sink opens, including
+    // after each rotation (e.g. the header of a binary log)
+    void setFilePreamble(const std::string& preamble);
+
+    // Append one line (a newline is added) and apply the flush and rotation policies
+    void writeLine(const char* text, std::size_t length, LogLevel level);
+    // Append one record as-is and apply the flush and rotation policies
+    void writeRecord(const char* data, std::size_t length, LogLevel level);
+    // Append text as-is, without applying the flush policy
+    void writeRaw(const char* text, std::size_t length);
+
+    // Append a batch of records and apply the policies once for all of them
+    void write(const LogSinkBatch& batch) override;
+
+    void flush() override;
+    void flushIfDue() override;
+
+    // Reopens the file by path with a plain descriptor (stream-compressed files are skipped)
+    void crashFlush() override;
+    void crashWrite(const char* record, std::size_t length) override;
+
+    std::size_t getBufferedBytes() const;
+
+private:
+    void writeEntry(const char* text, std::size_t length, bool newline, LogLevel level);
+    void applyFlushPolicy(LogLevel level);
+    void submitBuffered();
+    void append(const char* text, std::size_t length);
+    void writeOut(const char* text, std::size_t length);
+
+    // Rotation
+    bool rotationEnabled() const;
+    bool rotationDue() const;
+    void startRotation();
+    bool adoptRotatedFile(bool wait);
+    void rotationLoop();
+    void compressionLoop();
+    void compressRotatedFile(const std::string& rotatedPath);
+    void pruneRotatedFiles();
+
+    std::unique_ptr<LogFileWriter> file;
+    std::string path;
+    bool opened = false;
+    std::vector<char> buffer;
+    std::size_t bufferedBytes = 0;
+    LogFlushPolicy policy;
+    std::chrono::steady_clock::time_point oldestBuffered;
+    std::string filePreamble;
+    int crashDescriptor = -1;
+
+    LogCompressionPolicy compression;
+    std::vector<char> compressedBlock;
+
+    LogRotationPolicy rotation;
+    std::uint64_t currentFileBytes = 0;
+    std::chrono::system_clock::time_point nextRotationTime;
+
+    // Hand-off with the rotation thread (guarded by rotationMutex)
+    std::thread rotationThread;
+    std::mutex rotationMutex;
+    std::condition_variable rotationWake;
+    std::unique_ptr<LogFileWriter> retiringFile;
+    std::unique_ptr<LogFileWriter> rotatedFile;
+    bool rotationPending = false;
+    bool rotationDone = false;
+    bool stopRotation = false;
+
+    // Compression of rotated files, queued by the rotation thread
+    // (compressing is set by open(); the rest is guarded by compressionMutex)
+    bool compressing = false;
+    std::thread compressionThread;
+    std::mutex compressionMutex;
+    std::condition_variable compressionWake;
+    std::deque<std::string> compressionQueue;
+    bool stopCompression = false;
+};
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include "LoggerExport.hpp"
+
+// How a file sink hands its buffers to the operating system
+enum class LogFileIoBackend {
+    Blocking, // write() on the calling thread
+    Async     // io_uring on Linux, overlapped WriteFile on Windows (Blocking elsewhere)
+};
+
+// The open file behind a LogFileSink.
+//
+// write() may return before the bytes reach the operating system (the
+// asynchronous backend copies them into one of several buffers in flight);
+// flush() waits until they have. Bytes always land in the order written.
+class LOGGER_API LogFileWriter {
+public:
+    // Open filePath for appending; null if it cannot be opened. The Async
+    // backend falls back to Blocking where asynchronous I/O is unavailable.
+    static std::unique_ptr<LogFileWriter> open(const std::string& filePath, LogFileIoBackend backend,
+                                               std::size_t buffersInFlight);
+
+    virtual ~LogFileWriter();
+
+    virtual void write(const char* data, std::size_t length) = 0;
+    virtual void flush() = 0;
+    // Flush and close (also done by the destructor)
+    virtual void close() = 0;
+
+    // Crash path: let writes in flight land before the sink appends to the
+    // file by other means (async-signal-safe; nothing to do by default)
+    virtual void crashFlush();
+};
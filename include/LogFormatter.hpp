@@ -0,0 +1,142 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "LoggerExport.hpp"
+#include "LogLineBuffer.hpp"
+
+// fmt-style "{}" formatting straight into a LogLineBuffer.
+//
+// Each "{}" in the pattern is replaced by the next argument; "{{" and "}}"
+// produce literal braces. Arguments are integers, floating point values,
+// bool, char, strings, pointers and enums. The same arguments can instead
+// be captured in a compact binary payload (encode) and formatted later on
+// another thread (formatEncoded), which is what asynchronous mode does.
+class LOGGER_API LogFormatter {
+public:
+    template <typename... Args>
+    static void format(LogLineBuffer& out, std::string_view pattern, const Args&... args) {
+        std::size_t position = 0;
+        ((nextPlaceholder(out, pattern, position) ? appendArgument(out, args) : void()), ...);
+        appendRemainder(out, pattern, position);
+    }
+
+    // Append the binary form of args to payload
+    template <typename... Args>
+    static void encode(std::string& payload, const Args&... args) {
+        (encodeArgument(payload, args), ...);
+    }
+
+    // Format a payload produced by encode() against its pattern
+    static void formatEncoded(LogLineBuffer& out, std::string_view pattern,
+                              const char* payload, std::size_t payloadSize);
+
+    // Type tags of the binary encoding
+    enum class ArgumentType : std::uint8_t {
+        Int, UInt, Double, Bool, Char, String, Pointer
+    };
+
+    // One argument read back from a payload (text points into the payload)
+    struct Argument {
+        ArgumentType type;
+        union {
+            long long intValue;
+            unsigned long long uintValue;
+            double doubleValue;
+            bool boolValue;
+            char charValue;
+            const void* pointerValue;
+        };
+        std::string_view text;
+    };
+
+    // Read the argument at offset and advance past it; false at the end of
+    // the payload or if it is corrupt
+    static bool decodeArgument(const char* payload, std::size_t payloadSize,
+                               std::size_t& offset, Argument& argument);
+
+    // Append an argument the way "{}" formats it
+    static void appendArgument(LogLineBuffer& out, const Argument& argument);
+
+    // Plain value formatting (std::to_chars based, locale independent)
+    static void appendValue(LogLineBuffer& out, long long value);
+    static void appendValue(LogLineBuffer& out, unsigned long long value);
+    static void appendValue(LogLineBuffer& out, double value);
+    static void appendValue(LogLineBuffer& out, bool value);
+    static void appendValue(LogLineBuffer& out, char value);
+    static void appendValue(LogLineBuffer& out, std::string_view value);
+    static void appendValue(LogLineBuffer& out, const void* value);
+
+private:
+    // Copy literal text up to the next "{}"; false if there is none left
+    static bool nextPlaceholder(LogLineBuffer& out, std::string_view pattern, std::size_t& position);
+    static void appendRemainder(LogLineBuffer& out, std::string_view pattern, std::size_t position);
+
+    template <typename T>
+    static void appendArgument(LogLineBuffer& out, const T& value) {
+        using Type = std::decay_t<T>;
+        if constexpr (std::is_same_v<Type, bool> || std::is_same_v<Type, char>) {
+            appendValue(out, value);
+        } else if constexpr (std::is_enum_v<Type>) {
+            appendArgument(out, static_cast<std::underlying_type_t<Type>>(value));
+        } else if constexpr (std::is_integral_v<Type> && std::is_signed_v<Type>) {
+            appendValue(out, static_cast<long long>(value));
+        } else if constexpr (std::is_integral_v<Type>) {
+            appendValue(out, static_cast<unsigned long long>(value));
+        } else if constexpr (std::is_floating_point_v<Type>) {
+            appendValue(out, static_cast<double>(value));
+        } else if constexpr (std::is_array_v<T>) {
+            appendValue(out, std::string_view(value));
+        } else if constexpr (std::is_same_v<Type, const char*> || std::is_same_v<Type, char*>) {
+            appendValue(out, value != nullptr ? std::string_view(value) : std::string_view("(null)"));
+        } else if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+            appendValue(out, std::string_view(value));
+        } else if constexpr (std::is_pointer_v<Type>) {
+            appendValue(out, static_cast<const void*>(value));
+        } else {
+            static_assert(sizeof(Type) == 0, "LogFormatter: unsupported argument type");
+        }
+    }
+
+    template <typename T>
+    static void encodeArgument(std::string& payload, const T& value) {
+        using Type = std::decay_t<T>;
+        if constexpr (std::is_same_v<Type, bool>) {
+            encodeRaw(payload, ArgumentType::Bool, static_cast<std::uint8_t>(value ? 1 : 0));
+        } else if constexpr (std::is_same_v<Type, char>) {
+            encodeRaw(payload, ArgumentType::Char, value);
+        } else if constexpr (std::is_enum_v<Type>) {
+            encodeArgument(payload, static_cast<std::underlying_type_t<Type>>(value));
+        } else if constexpr (std::is_integral_v<Type> && std::is_signed_v<Type>) {
+            encodeRaw(payload, ArgumentType::Int, static_cast<long long>(value));
+        } else if constexpr (std::is_integral_v<Type>) {
+            encodeRaw(payload, ArgumentType::UInt, static_cast<unsigned long long>(value));
+        } else if constexpr (std::is_floating_point_v<Type>) {
+            encodeRaw(payload, ArgumentType::Double, static_cast<double>(value));
+        } else if constexpr (std::is_array_v<T>) {
+            encodeString(payload, std::string_view(value));
+        } else if constexpr (std::is_same_v<Type, const char*> || std::is_same_v<Type, char*>) {
+            encodeString(payload, value != nullptr ? std::string_view(value) : std::string_view("(null)"));
+        } else if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+            encodeString(payload, std::string_view(value));
+        } else if constexpr (std::is_pointer_v<Type>) {
+            encodeRaw(payload, ArgumentType::Pointer, static_cast<const void*>(value));
+        } else {
+            static_assert(sizeof(Type) == 0, "LogFormatter: unsupported argument type");
+        }
+    }
+
+    template <typename T>
+    static void encodeRaw(std::string& payload, ArgumentType type, const T& value) {
+        char bytes[1 + sizeof(T)];
+        bytes[0] = static_cast<char>(type);
+        std::memcpy(bytes + 1, &value, sizeof(T));
+        payload.append(bytes, sizeof(bytes));
+    }
+
+    static void encodeString(std::string& payload, std::string_view value);
+};
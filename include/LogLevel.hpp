@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstdint>
+
+#include "LoggerExport.hpp"
+
+// Severity levels, lowest to highest
+enum class LogLevel : std::uint8_t {
+    Message = 0,
+    Success = 1,
+    Warning = 2,
+    Error   = 3,
+    Off     = 4 // minimum level that disables all output
+};
+
+LOGGER_API const char* logLevelName(LogLevel level);
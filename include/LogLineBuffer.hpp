@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+
+// Reusable output buffer for one formatted log line.
+//
+// Lines are built in a fixed inline array; a line that does not fit moves to
+// a heap string that keeps its capacity, so a buffer that lives for the life
+// of a thread stops allocating once it has seen its largest line.
+class LogLineBuffer {
+public:
+    static constexpr std::size_t inlineCapacity = 4096;
+
+    void clear() {
+        length = 0;
+        messageStart = 0;
+        usingOverflow = false;
+    }
+
+    // Note that the message starts here (after the line prefix)
+    void markMessageStart() {
+        messageStart = length;
+    }
+
+    std::size_t messageOffset() const {
+        return messageStart;
+    }
+
+    void append(const char* text, std::size_t textLength) {
+        if (!usingOverflow && length + textLength <= inlineCapacity) {
+            std::memcpy(inlineBuffer + length, text, textLength);
+        } else if (truncating) {
+            std::size_t room = length < inlineCapacity ? inlineCapacity - length : 0;
+            std::memcpy(inlineBuffer + length, text, room);
+            length += room;
+            return;
+        } else {
+            if (!usingOverflow) {
+                overflow.assign(inlineBuffer, length);
+                usingOverflow = true;
+            }
+            overflow.append(text, textLength);
+        }
+        length += textLength;
+    }
+
+    void append(const std::string& text) {
+        append(text.data(), text.size());
+    }
+
+    void append(char character) {
+        append(&character, 1);
+    }
+
+    // Never allocate: text beyond inlineCapacity is dropped (crash dumps)
+    void truncateAtInlineCapacity() {
+        truncating = true;
+    }
+
+    // Append count '.' padding characters
+    void appendPadding(std::size_t count) {
+        static const char dots[] = "................";
+        while (count > 0) {
+            std::size_t chunk = count < sizeof(dots) - 1 ? count : sizeof(dots) - 1;
+            append(dots, chunk);
+            count -= chunk;
+        }
+    }
+
+    const char* data() const {
+        return usingOverflow ? overflow.data() : inlineBuffer;
+    }
+
+    std::size_t size() const {
+        return length;
+    }
+
+private:
+    char inlineBuffer[inlineCapacity];
+    std::string overflow;
+    std::size_t length = 0;
+    std::size_t messageStart = 0;
+    bool usingOverflow = false;
+    bool truncating = false;
+};
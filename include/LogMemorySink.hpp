@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "LoggerExport.hpp"
+#include "LogSink.hpp"
+
+// Keeps the most recent records in memory (tests, in-process log viewers).
+//
+// Text, Json and Logfmt records are stored without their newline. Safe to
+// read from any thread while loggers write to it.
+class LOGGER_API LogMemorySink : public LogSink {
+public:
+    // maxRecords = 0 keeps everything
+    explicit LogMemorySink(LogSinkFormat format = LogSinkFormat::Text, std::size_t maxRecords = 0);
+
+    void write(const LogSinkBatch& batch) override;
+
+    std::vector<std::string> getRecords() const;
+    std::size_t getRecordCount() const;
+    void clear();
+
+private:
+    mutable std::mutex recordsMutex;
+    std::deque<std::string> records;
+    std::size_t maxRecords;
+};
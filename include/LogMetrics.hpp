@@ -0,0 +1,214 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "LoggerExport.hpp"
+#include "LogLevel.hpp"
+#include "LogRingBuffer.hpp"
+#include "LogSink.hpp"
+
+#ifdef _MSC_VER
+    #include <intrin.h>
+#endif
+
+// A latency distribution in power-of-two buckets: bucket i holds samples
+// below 2^i ns (and at least 2^(i-1) ns), the last one everything slower
+struct LOGGER_API LogLatencySnapshot {
+    static constexpr std::size_t bucketCount = 32;
+
+    std::uint64_t buckets[bucketCount] = {};
+    std::uint64_t count = 0;
+    std::uint64_t totalNanoseconds = 0;
+
+    // Upper bound of the bucket the given fraction of samples falls in
+    // (0.5 for the median, 0.999 for p99.9); 0 without samples
+    std::uint64_t percentile(double fraction) const;
+    std::uint64_t meanNanoseconds() const;
+    void merge(const LogLatencySnapshot& other);
+};
+
+// Lock-free latency histogram (relaxed atomics)
+class LOGGER_API LogLatencyHistogram {
+public:
+    void record(std::uint64_t nanoseconds) {
+        buckets[bucketIndex(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+        totalNanoseconds.fetch_add(nanoseconds, std::memory_order_relaxed);
+    }
+
+    void addTo(LogLatencySnapshot& snapshot) const;
+
+    // Number of significant bits, capped at the last bucket
+    static std::size_t bucketIndex(std::uint64_t nanoseconds) {
+        if (nanoseconds == 0) {
+            return 0;
+        }
+#ifdef _MSC_VER
+        unsigned long highest;
+        _BitScanReverse64(&highest, nanoseconds);
+        std::size_t bits = static_cast<std::size_t>(highest) + 1;
+#else
+        std::size_t bits = 64 - static_cast<std::size_t>(__builtin_clzll(nanoseconds));
+#endif
+        return bits < LogLatencySnapshot::bucketCount ? bits : LogLatencySnapshot::bucketCount - 1;
+    }
+
+private:
+    std::atomic<std::uint64_t> buckets[LogLatencySnapshot::bucketCount] = {};
+    std::atomic<std::uint64_t> totalNanoseconds{0};
+};
+
+// Counters of one sink (totals over every logger writing to it)
+struct LogSinkMetrics {
+    const LogSink* sink = nullptr;
+    LogSinkFormat format = LogSinkFormat::Text;
+    std::uint64_t records = 0; // records handed to the sink
+    std::uint64_t bytes = 0;   // bytes of those records, in the sink's format
+    std::uint64_t flushes = 0; // hand-offs of buffered data to the destination
+};
+
+// What a logger (or every logger, see LogMetrics::globalSnapshot) has done
+struct LOGGER_API LogMetricsSnapshot {
+    static constexpr std::size_t levelCount = static_cast<std::size_t>(LogLevel::Off);
+
+    std::uint64_t records[levelCount] = {}; // records logged, per level
+    std::uint64_t droppedRecords = 0;       // lost to a full asynchronous queue
+    std::uint64_t rateLimitedRecords = 0;
+    std::uint64_t sampledOutRecords = 0;
+    std::uint64_t collapsedRecords = 0;
+    std::size_t queueHighWater = 0;         // deepest the asynchronous queue has been seen
+    std::size_t queueCapacity = 0;
+
+    LogLatencySnapshot enqueueLatency;      // publishing a record to the queue
+    LogLatencySnapshot formatLatency;       // rendering a record into its text line
+    LogLatencySnapshot writeLatency;        // one sink's write() of a batch
+
+    std::vector<LogSinkMetrics> sinks;      // per sink (per logger only)
+
+    std::uint64_t totalRecords() const;
+    std::uint64_t totalBytes() const;
+    std::uint64_t totalFlushes() const;
+
+    // Add another snapshot's counters (sinks are not merged)
+    void merge(const LogMetricsSnapshot& other);
+
+    // "records=120 message=100 ... write_p99=8192ns" (logfmt)
+    std::string summary() const;
+};
+
+// A logger's self-measurement.
+//
+// Counters bumped by logging threads are spread over cache-line-sized
+// shards, one picked per thread, so threads logging at once rarely touch the
+// same line and the counters never become a point of contention; each is a
+// relaxed atomic. Counters of the write side are only touched under the
+// logger's sink lock. A snapshot sums the shards, so it is exact for
+// records that have finished and may miss ones in progress.
+//
+// Latencies cost two clock readings per measurement and are off until
+// setTiming(true).
+class LOGGER_API LogMetrics {
+public:
+    LogMetrics();
+    ~LogMetrics();
+
+    LogMetrics(const LogMetrics&) = delete;
+    LogMetrics& operator=(const LogMetrics&) = delete;
+
+    void countRecord(LogLevel level) {
+        shard().records[static_cast<std::size_t>(level)].fetch_add(1, std::memory_order_relaxed);
+    }
+    void countDropped() {
+        shard().dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+    void countRateLimited() {
+        shard().rateLimited.fetch_add(1, std::memory_order_relaxed);
+    }
+    void countSampledOut() {
+        shard().sampledOut.fetch_add(1, std::memory_order_relaxed);
+    }
+    void countCollapsed() {
+        shard().collapsed.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void noteQueueDepth(std::size_t depth) {
+        std::size_t highest = queueHighWater.load(std::memory_order_relaxed);
+        while (depth > highest &&
+               !queueHighWater.compare_exchange_weak(highest, depth, std::memory_order_relaxed)) {
+        }
+    }
+
+    // Latency timing: startTimer() is 0 while timing is off, and the
+    // record* calls ignore a 0 start
+    void setTiming(bool enabled) {
+        timing.store(enabled, std::memory_order_relaxed);
+    }
+    bool getTiming() const {
+        return timing.load(std::memory_order_relaxed);
+    }
+    std::uint64_t startTimer() const {
+        return timing.load(std::memory_order_relaxed) ? now() : 0;
+    }
+    void recordEnqueue(std::uint64_t started) {
+        if (started != 0) {
+            shard().enqueueLatency.record(now() - started);
+        }
+    }
+    void recordFormat(std::uint64_t started) {
+        if (started != 0) {
+            shard().formatLatency.record(now() - started);
+        }
+    }
+    void recordWrite(std::uint64_t started) {
+        if (started != 0) {
+            writeLatency.record(now() - started);
+        }
+    }
+
+    // Counters summed over the shards
+    std::uint64_t getDroppedRecords() const;
+    std::uint64_t getRateLimitedRecords() const;
+    std::uint64_t getSampledOutRecords() const;
+    std::uint64_t getCollapsedRecords() const;
+
+    // Everything but the sinks and the queue capacity, which the logger adds
+    void snapshot(LogMetricsSnapshot& out) const;
+
+    // Every logger's counters: the live ones plus those already destroyed
+    static LogMetricsSnapshot globalSnapshot();
+
+    // Steady clock in nanoseconds (never 0)
+    static std::uint64_t now() {
+        auto ticks = std::chrono::steady_clock::now().time_since_epoch();
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(ticks).count()) | 1;
+    }
+
+private:
+    static constexpr std::size_t shardCount = 8;
+
+    struct alignas(logCacheLineSize) Shard {
+        std::atomic<std::uint64_t> records[LogMetricsSnapshot::levelCount + 1] = {}; // Off included
+        std::atomic<std::uint64_t> dropped{0};
+        std::atomic<std::uint64_t> rateLimited{0};
+        std::atomic<std::uint64_t> sampledOut{0};
+        std::atomic<std::uint64_t> collapsed{0};
+        LogLatencyHistogram enqueueLatency;
+        LogLatencyHistogram formatLatency;
+    };
+
+    Shard& shard() {
+        return shards[threadShard()];
+    }
+    static std::size_t threadShard();
+
+    std::uint64_t sum(std::atomic<std::uint64_t> Shard::* counter) const;
+
+    Shard shards[shardCount];
+    std::atomic<bool> timing{false};
+    alignas(logCacheLineSize) std::atomic<std::size_t> queueHighWater{0};
+    LogLatencyHistogram writeLatency;
+};
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "LoggerExport.hpp"
+#include "LogLevel.hpp"
+#include "LogSink.hpp"
+
+#ifdef _WIN32
+    #include <windows.h>
+#endif
+
+// Append-only log file written through a memory mapping.
+//
+// The file is grown in chunks and the current chunk is mapped, so appending
+// a line is a memcpy into the page cache: no syscall and no iostream layer
+// per write. When a chunk fills, the file is extended and the next chunk
+// mapped. close() truncates the file to the bytes actually written; a file
+// left by a crashed process keeps its zero-filled tail up to the chunk end.
+// Not thread-safe: the owner serialises access.
+class LOGGER_API LogMmapSink : public LogSink {
+public:
+    static constexpr std::size_t defaultChunkSize = 16 * 1024 * 1024;
+
+    explicit LogMmapSink(LogSinkFormat format = LogSinkFormat::Text);
+    ~LogMmapSink() override;
+
+    LogMmapSink(const LogMmapSink&) = delete;
+    LogMmapSink& operator=(const LogMmapSink&) = delete;
+
+    bool open(const std::string& filePath, std::size_t chunkSize = defaultChunkSize);
+    void close();
+    bool isOpen() const;
+
+    // Append one line (a newline is added)
+    void writeLine(const char* text, std::size_t length, LogLevel level);
+    // Append text as-is
+    void writeRaw(const char* text, std::size_t length);
+
+    // Append a batch of records
+    void write(const LogSinkBatch& batch) override;
+
+    // Ask the OS to start writing dirty pages back (does not wait)
+    void flush() override;
+
+    // The mapping is already in the page cache; records are copied in as usual
+    void crashWrite(const char* record, std::size_t length) override;
+
+    // End of the data in the mapped file: what it held when opened plus all
+    // written since (getWrittenBytes() counts this sink's records only)
+    std::uint64_t getMappedBytes() const;
+
+private:
+    bool mapChunk(std::uint64_t offset);
+    void unmapChunk();
+
+#ifdef _WIN32
+    HANDLE fileHandle = INVALID_HANDLE_VALUE;
+    HANDLE mappingHandle = nullptr;
+#else
+    int fileDescriptor = -1;
+#endif
+
+    char* mappedView = nullptr;
+    std::uint64_t viewOffset = 0;   // file offset of mappedView[0]
+    std::size_t viewSize = 0;
+    std::uint64_t writeOffset = 0;  // real end of the log data
+    std::size_t chunkSize = defaultChunkSize;
+    std::size_t granularity = 4096; // mapping offsets must be multiples of this
+};
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "LoggerExport.hpp"
+#include "LogLevel.hpp"
+#include "LogSink.hpp"
+
+// How a network sink frames records on the wire
+enum class LogNetworkProtocol {
+    SyslogUdp, // RFC 5424 message per datagram (RFC 5426)
+    SyslogTcp, // RFC 5424 messages with octet-counting framing (RFC 6587)
+    Stream     // TCP, each record preceded by its length as a little-endian u32
+};
+
+struct LogNetworkOptions {
+    std::string host = "127.0.0.1";
+    std::uint16_t port = 514;
+    LogNetworkProtocol protocol = LogNetworkProtocol::SyslogUdp;
+
+    // Syslog header fields (empty: this machine's name / "-")
+    std::string hostname;
+    std::string appName;
+    int facility = 1;                                 // user-level messages
+
+    std::size_t spillBytes = 4 * 1024 * 1024;         // records held while disconnected or behind
+    std::chrono::milliseconds reconnectDelay{1000};   // wait between connection attempts
+    std::chrono::milliseconds connectTimeout{1000};   // longest one connection attempt waits
+    std::chrono::milliseconds flushTimeout{1000};     // longest flush() waits for the collector
+
+    // Bytes sent at the start of every connection (e.g. a binary log header)
+    std::string streamPreamble;
+};
+
+// Ships records to a remote collector.
+//
+// write() only frames each record into an in-memory spill buffer and wakes
+// the sink's sender thread; logging threads never touch a socket. The
+// sender connects (and reconnects after a failure, every reconnectDelay),
+// then takes everything spilled so far and sends it in one go: one send()
+// for a TCP stream, one sendmmsg() for a run of UDP datagrams (where
+// available). Records that arrive while the spill buffer is full are
+// dropped and counted.
+//
+// A connection attempt gives up after connectTimeout, so the destructor of
+// a sink that is still connecting returns within about that long. Resolving
+// a host name cannot be interrupted, though: with a slow resolver the
+// destructor also waits for getaddrinfo (numeric addresses never do).
+//
+// Text sinks send the message after the text prefix, Json and Logfmt sinks
+// the whole record; with the syslog protocols it becomes the MSG part
+// behind an RFC 5424 header (UTC timestamp, severity from the level).
+// Binary sinks always use Stream framing.
+class LOGGER_API LogNetworkSink : public LogSink {
+public:
+    explicit LogNetworkSink(const LogNetworkOptions& options,
+                            LogSinkFormat format = LogSinkFormat::Text);
+    ~LogNetworkSink() override;
+
+    LogNetworkSink(const LogNetworkSink&) = delete;
+    LogNetworkSink& operator=(const LogNetworkSink&) = delete;
+
+    void write(const LogSinkBatch& batch) override;
+
+    // Wait (up to flushTimeout) for the collector to take what was written
+    void flush() override;
+
+    bool isConnected() const;
+    std::uint64_t getSentRecords() const;
+    std::uint64_t getDroppedRecords() const;
+    std::size_t getSpilledBytes() const;
+
+private:
+    // A SOCKET on Windows, a descriptor elsewhere (-1 when closed)
+    using SocketHandle = std::intptr_t;
+
+    void appendSyslog(const LogSinkEntry& entry, const char* message, std::size_t messageLength);
+    void appendStream(const char* record, std::size_t length);
+    bool beginFrame(const char* header, std::size_t headerLength, std::size_t bodyLength);
+    void formatSyslogTimestamp(std::chrono::system_clock::time_point timestamp, char* out);
+
+    void senderLoop();
+    void requeueUnsent(std::size_t sentFrames);
+    bool connectSocket();
+    void closeSocket();
+    std::size_t sendFrames(const std::string& data, const std::vector<std::size_t>& frameEnds);
+
+    LogNetworkOptions options;
+    bool datagrams;
+    std::string syslogFields; // " HOSTNAME APP-NAME PROCID - - "
+
+    // Spilled frames (guarded by spillMutex)
+    mutable std::mutex spillMutex;
+    std::condition_variable spillWake;
+    std::condition_variable spillSent;
+    std::string spill;
+    std::vector<std::size_t> spillFrameEnds;
+    bool sending = false;
+    bool stopSender = false;
+
+    // UTC second cached by the syslog timestamp formatter (used under spillMutex)
+    std::int64_t cachedSecond = INT64_MIN;
+    char cachedSecondText[20] = {};
+
+    // Owned by the sender thread
+    std::string outgoing;
+    std::vector<std::size_t> outgoingFrameEnds;
+    SocketHandle socketHandle = -1;
+
+    std::atomic<bool> connected{false};
+    std::atomic<std::uint64_t> sentRecords{0};
+    std::atomic<std::uint64_t> droppedRecords{0};
+    std::thread senderThread;
+};
@@ -0,0 +1,293 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "LoggerExport.hpp"
+#include "LogCallSite.hpp"
+#include "LogLevel.hpp"
+#include "LogLineBuffer.hpp"
+#include "LogTextLayout.hpp"
+#include "LogTimestamp.hpp"
+
+// Line patterns: the prefix written before each text line's message.
+//
+// Fields are written in braces, everything else is copied as it is ("{{"
+// and "}}" for literal braces):
+//   {time}    local time, "YYYY-MM-DD HH:MM:SS.mmm"
+//   {utc}     ISO-8601 UTC, "YYYY-MM-DDTHH:MM:SS.mmmZ"
+//   {name}    logger name, padded with '.' to LogTextLayout::loggerNameWidth
+//   {level}   level name, padded with '.' to 7 characters
+//   {thread}  id of the thread that logged the record
+//   {file}    source file of the call site (see LogCallSites)
+//   {line}    source line of the call site
+//   {function} function of the call site
+//
+// The call-site fields are empty for records logged without a call site
+// (through the plain log methods rather than the LOGGER_*_AT macros).
+//
+// The default, logDefaultPattern, is the classic layout:
+// "[2024-05-01 12:00:00.000] [Main...........] [MESSAGE] ".
+
+enum class LogPatternField : std::uint8_t {
+    Literal,
+    Time,
+    UtcTime,
+    Name,
+    Level,
+    Thread,
+    File,
+    Line,
+    Function
+};
+
+// One field, or a run of literal text (offset and length into the pattern)
+struct LogPatternToken {
+    LogPatternField field = LogPatternField::Literal;
+    std::size_t offset = 0;
+    std::size_t length = 0;
+};
+
+// What a layout needs to know about one line
+struct LogLineContext {
+    std::chrono::system_clock::time_point timestamp;
+    LogLevel level;
+    std::uint32_t thread;
+    std::uint32_t callSite = LogCallSites::none;
+};
+
+// The calling thread's OS thread id (looked up once per thread)
+LOGGER_API std::uint32_t logThreadId();
+
+inline constexpr char logDefaultPattern[] = "[{time}] [{name}] [{level}] ";
+
+// Pattern parsing; constexpr so compiled layouts are parsed by the compiler
+class LogPatternParser {
+public:
+    static constexpr std::size_t invalid = static_cast<std::size_t>(-1);
+
+    // Split a pattern into tokens, storing up to capacity of them in out;
+    // returns the token count, or invalid for an unknown field or stray brace
+    static constexpr std::size_t parse(std::string_view pattern, LogPatternToken* out, std::size_t capacity) {
+        std::size_t count = 0;
+        std::size_t position = 0;
+        while (position < pattern.size()) {
+            char character = pattern[position];
+            LogPatternToken token;
+            if (character == '{' || character == '}') {
+                if (position + 1 < pattern.size() && pattern[position + 1] == character) {
+                    token = LogPatternToken{LogPatternField::Literal, position, 1};
+                    position += 2;
+                } else if (character == '}') {
+                    return invalid;
+                } else {
+                    std::size_t close = pattern.find('}', position);
+                    if (close == std::string_view::npos) {
+                        return invalid;
+                    }
+                    LogPatternField field = fieldNamed(pattern.substr(position + 1, close - position - 1));
+                    if (field == LogPatternField::Literal) {
+                        return invalid;
+                    }
+                    token = LogPatternToken{field, position, close + 1 - position};
+                    position = close + 1;
+                }
+            } else {
+                std::size_t end = position;
+                while (end < pattern.size() && pattern[end] != '{' && pattern[end] != '}') {
+                    ++end;
+                }
+                token = LogPatternToken{LogPatternField::Literal, position, end - position};
+                position = end;
+            }
+
+            if (count < capacity) {
+                out[count] = token;
+            }
+            ++count;
+        }
+        return count;
+    }
+
+    static constexpr std::size_t count(std::string_view pattern) {
+        return parse(pattern, nullptr, 0);
+    }
+
+    // Literal for any name that is not a field
+    static constexpr LogPatternField fieldNamed(std::string_view name) {
+        if (name == "time") {
+            return LogPatternField::Time;
+        }
+        if (name == "utc") {
+            return LogPatternField::UtcTime;
+        }
+        if (name == "name") {
+            return LogPatternField::Name;
+        }
+        if (name == "level") {
+            return LogPatternField::Level;
+        }
+        if (name == "thread") {
+            return LogPatternField::Thread;
+        }
+        if (name == "file") {
+            return LogPatternField::File;
+        }
+        if (name == "line") {
+            return LogPatternField::Line;
+        }
+        if (name == "function") {
+            return LogPatternField::Function;
+        }
+        return LogPatternField::Literal;
+    }
+
+    // Literals and the name are the same on every line of a logger
+    static constexpr bool isStatic(LogPatternField field) {
+        return field == LogPatternField::Literal || field == LogPatternField::Name;
+    }
+
+    template <std::size_t Count>
+    static constexpr std::array<LogPatternToken, Count> tokens(std::string_view pattern) {
+        std::array<LogPatternToken, Count> parsed{};
+        parse(pattern, parsed.data(), Count);
+        return parsed;
+    }
+
+    template <std::size_t Count>
+    static constexpr std::size_t dynamicCount(const std::array<LogPatternToken, Count>& tokens) {
+        std::size_t dynamic = 0;
+        for (const LogPatternToken& token : tokens) {
+            dynamic += isStatic(token.field) ? 0 : 1;
+        }
+        return dynamic;
+    }
+
+    // The fields that change per line, in pattern order
+    template <std::size_t Dynamic, std::size_t Count>
+    static constexpr std::array<LogPatternField, Dynamic> dynamicFields(const std::array<LogPatternToken, Count>& tokens) {
+        std::array<LogPatternField, Dynamic> fields{};
+        std::size_t index = 0;
+        for (const LogPatternToken& token : tokens) {
+            if (!isStatic(token.field)) {
+                fields[index++] = token.field;
+            }
+        }
+        return fields;
+    }
+};
+
+// A line layout bound to one logger
+class LOGGER_API LogLayout {
+public:
+    virtual ~LogLayout() = default;
+
+    // Replace out's contents with the line prefix and mark where the message starts
+    virtual void formatPrefix(LogLineBuffer& out, const LogLineContext& line,
+                              LogTimestampCache& timestampCache) const = 0;
+
+    // Append one field that changes from line to line
+    static void appendTime(LogLineBuffer& out, const LogLineContext& line, LogTimestampCache& timestampCache);
+    static void appendUtcTime(LogLineBuffer& out, const LogLineContext& line, LogTimestampCache& timestampCache);
+    static void appendThread(LogLineBuffer& out, const LogLineContext& line);
+    static void appendCallSite(LogPatternField field, LogLineBuffer& out, const LogLineContext& line);
+    static void appendLevel(LogLineBuffer& out, const LogLineContext& line) {
+        // The padded "[LEVEL..] " field without its brackets
+        out.append(LogTextLayout::paddedLevel(line.level) + 1, LogTextLayout::paddedLevelLength - 3);
+    }
+
+    static void appendField(LogPatternField field, LogLineBuffer& out, const LogLineContext& line,
+                            LogTimestampCache& timestampCache);
+
+protected:
+    // The text of the static tokens between fields that change per line:
+    // runs[i] comes before the i-th changing field, and the last run ends the
+    // prefix. Done once per logger, so the padded name is copied along with
+    // the literals around it.
+    static void renderRuns(std::string_view pattern, const LogPatternToken* tokens, std::size_t tokenCount,
+                           const std::string& loggerName, std::string* runs);
+};
+
+// A layout compiled from a pattern known at compile time: the pattern is
+// parsed by the compiler, and formatting a line is a fixed sequence of
+// appends with no interpretation left. The pattern must be a constexpr char
+// array with linkage:
+//
+//   constexpr char isoPattern[] = "{utc} {level} ";
+//   logger.setLayout<isoPattern>();
+template <const char* Pattern>
+class LogPatternLayout : public LogLayout {
+public:
+    static constexpr std::string_view pattern = Pattern;
+    static constexpr std::size_t parsedCount = LogPatternParser::count(pattern);
+    static_assert(parsedCount != LogPatternParser::invalid, "unknown field or stray brace in log pattern");
+    static constexpr std::size_t tokenCount = parsedCount != LogPatternParser::invalid ? parsedCount : 0;
+
+    explicit LogPatternLayout(const std::string& loggerName) {
+        renderRuns(pattern, tokens.data(), tokens.size(), loggerName, runs.data());
+    }
+
+    void formatPrefix(LogLineBuffer& out, const LogLineContext& line,
+                      LogTimestampCache& timestampCache) const override {
+        out.clear();
+        appendFields(out, line, timestampCache, std::make_index_sequence<dynamicCount>());
+        out.append(runs[dynamicCount]);
+        out.markMessageStart();
+    }
+
+private:
+    static constexpr auto tokens = LogPatternParser::tokens<tokenCount>(pattern);
+    static constexpr std::size_t dynamicCount = LogPatternParser::dynamicCount(tokens);
+    static constexpr auto dynamicFields = LogPatternParser::dynamicFields<dynamicCount>(tokens);
+
+    template <std::size_t... Index>
+    void appendFields(LogLineBuffer& out, const LogLineContext& line, LogTimestampCache& timestampCache,
+                      std::index_sequence<Index...>) const {
+        (appendDynamic<Index>(out, line, timestampCache), ...);
+    }
+
+    template <std::size_t Index>
+    void appendDynamic(LogLineBuffer& out, const LogLineContext& line, LogTimestampCache& timestampCache) const {
+        constexpr LogPatternField field = dynamicFields[Index];
+        out.append(runs[Index]);
+        if constexpr (field == LogPatternField::Time) {
+            appendTime(out, line, timestampCache);
+        } else if constexpr (field == LogPatternField::UtcTime) {
+            appendUtcTime(out, line, timestampCache);
+        } else if constexpr (field == LogPatternField::Level) {
+            appendLevel(out, line);
+        } else if constexpr (field == LogPatternField::Thread) {
+            appendThread(out, line);
+        } else {
+            appendCallSite(field, out, line);
+        }
+    }
+
+    std::array<std::string, dynamicCount + 1> runs;
+};
+
+// The fallback for patterns only known at run time (read from configuration,
+// say): parsed once, then each line walks the list of changing fields
+class LOGGER_API LogRuntimeLayout : public LogLayout {
+public:
+    LogRuntimeLayout(const std::string& pattern, const std::string& loggerName);
+
+    // False if the pattern has an unknown field or a stray brace
+    bool isValid() const {
+        return valid;
+    }
+
+    void formatPrefix(LogLineBuffer& out, const LogLineContext& line,
+                      LogTimestampCache& timestampCache) const override;
+
+private:
+    bool valid = false;
+    std::vector<LogPatternField> fields; // the fields that change per line, in order
+    std::vector<std::string> runs;       // fields.size() + 1 static runs around them
+};
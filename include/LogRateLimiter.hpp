@@ -0,0 +1,64 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include "LoggerExport.hpp"
+
+// Token bucket for one call site, checked before anything is formatted.
+//
+// Implemented as the generic cell rate algorithm: the whole bucket is one
+// atomic "next allowed time", advanced by one interval per admitted record
+// with a single compare-and-swap, so concurrent callers never lock. Up to
+// burst records may arrive back to back; after that one per interval.
+// Rejected records are only counted. Intervals stop at about 31 years (a
+// rate of zero gets that one) and the bucket at about 126 years ahead, so
+// at such rates the burst saturates instead of overflowing.
+class LOGGER_API LogRateLimiter {
+public:
+    LogRateLimiter(double recordsPerSecond, std::uint32_t burst = 1);
+
+    // True if a record may be written now; false counts it as suppressed
+    bool tryAcquire() {
+        std::int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+        std::int64_t arrival = nextArrival.load(std::memory_order_relaxed);
+
+        while (true) {
+            std::int64_t start = arrival > now ? arrival : now;
+            if (start - now > tolerance) {
+                suppressed.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            if (nextArrival.compare_exchange_weak(arrival, start + interval, std::memory_order_relaxed)) {
+                return true;
+            }
+        }
+    }
+
+    // Records suppressed since the last call
+    std::uint64_t takeSuppressed() {
+        if (suppressed.load(std::memory_order_relaxed) == 0) {
+            return 0;
+        }
+        return suppressed.exchange(0, std::memory_order_relaxed);
+    }
+
+private:
+    std::int64_t interval;  // nanoseconds per record
+    std::int64_t tolerance; // how far ahead of now the bucket may run (the burst)
+    std::atomic<std::int64_t> nextArrival{0};
+    std::atomic<std::uint64_t> suppressed{0};
+};
+
+// 64-bit FNV-1a, used to recognise repeated messages without comparing them
+inline std::uint64_t logMessageHash(const void* data, std::size_t length,
+                                    std::uint64_t hash = 14695981039346656037ull) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (std::size_t i = 0; i < length; ++i) {
+        hash = (hash ^ bytes[i]) * 1099511628211ull;
+    }
+    return hash;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "LoggerExport.hpp"
+
+// Deferred freeing for objects published through an atomic pointer and read
+// without a lock (a logger's config snapshots and line layouts).
+//
+// Epoch based: every thread that reads owns a reader slot on a cache line of
+// its own. A ReadGuard pins the slot at the current epoch while the thread
+// uses what it loaded (one store to that slot, no shared writes; nested
+// guards only count). A writer that has replaced an object hands the old one
+// to retire(), which tags it with the epoch, advances the epoch and frees
+// every retired object older than the oldest pinned slot. A reader that
+// keeps logging re-pins at a newer epoch on every record, so no steady load
+// holds off freeing: with guards held for one record, a retire() frees all
+// but the objects replaced while some record was in progress.
+//
+// Slots and the epoch are shared by every reclaimer in the process, so a
+// thread pins one slot whichever logger it writes to. The pointer store that
+// unpublishes an object and the pointer loads of guarded readers must be
+// seq_cst, so a reader whose pin a writer did not see is sure to load the
+// newer object. Guards are not async-signal-safe (the first one on a thread
+// allocates its slot).
+class LOGGER_API LogReclaimer {
+public:
+    class ReadGuard {
+    public:
+        ReadGuard() {
+            enter();
+        }
+        ~ReadGuard() {
+            leave();
+        }
+
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+    };
+
+    LogReclaimer() = default;
+    LogReclaimer(const LogReclaimer&) = delete;
+    LogReclaimer& operator=(const LogReclaimer&) = delete;
+
+    // An object no reader can load any more; freed once none can hold it
+    void retire(std::shared_ptr<const void> object);
+
+    // Retired objects not freed yet (after freeing the ones no reader holds)
+    std::size_t getRetiredCount() const;
+
+private:
+    struct Retired {
+        std::shared_ptr<const void> object;
+        std::uint64_t epoch;
+    };
+
+    static void enter();
+    static void leave();
+    void freeUnpinned() const;
+
+    mutable std::mutex retireMutex;
+    mutable std::vector<Retired> retired; // guarded by retireMutex
+};
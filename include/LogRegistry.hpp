@@ -0,0 +1,65 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "LoggerExport.hpp"
+#include "LoggerHandler.hpp"
+#include "LogSharedSink.hpp"
+
+// Process-wide home for named loggers and the sinks they share.
+//
+// Loggers made by the registry are attached to its default sinks (one
+// console sink for the whole process unless changed), so creating one
+// opens nothing and probes nothing: it is cheap enough to do per request
+// or per thread. File sinks are shared by path: every logger that asks for
+// the same file gets the same sink, i.e. one file handle, one buffer and
+// one banner. A file sink closes when its last user lets go of it.
+class LOGGER_API LogRegistry {
+public:
+    static LogRegistry& instance();
+
+    LogRegistry(const LogRegistry&) = delete;
+    LogRegistry& operator=(const LogRegistry&) = delete;
+
+    // The logger registered under name, created with the default sinks on first use
+    std::shared_ptr<LoggerHandler> getLogger(const std::string& name);
+    // A new logger on the default sinks that the registry does not keep
+    std::shared_ptr<LoggerHandler> createLogger(const std::string& name);
+    void dropLogger(const std::string& name);
+    void dropAllLoggers();
+
+    // Apply a config file to every registered logger (see
+    // LoggerHandler::applyConfig); false if any of them did not take it
+    bool applyConfig(const LogConfigFile& file);
+
+    // The sink for a file path, opened on first use. The first caller's
+    // policies win: while the file is open, later calls get the same sink
+    // and the policies they pass are ignored, even when they differ.
+    std::shared_ptr<LogSink> getFileSink(const std::string& filePath,
+                                         const LogFlushPolicy& flushPolicy = LogFlushPolicy(),
+                                         const LogRotationPolicy& rotationPolicy = LogRotationPolicy(),
+                                         const LogCompressionPolicy& compressionPolicy = LogCompressionPolicy());
+
+    // The process-wide console sink
+    std::shared_ptr<LogConsoleSink> getConsoleSink();
+
+    // Sinks given to loggers the registry creates from now on
+    void setDefaultSinks(const std::vector<std::shared_ptr<LogSink>>& sinks);
+    std::vector<std::shared_ptr<LogSink>> getDefaultSinks();
+
+private:
+    LogRegistry() = default;
+
+    const std::vector<std::shared_ptr<LogSink>>& defaultSinksLocked();
+
+    std::mutex registryMutex;
+    std::unordered_map<std::string, std::shared_ptr<LoggerHandler>> loggers;
+    std::unordered_map<std::string, std::weak_ptr<LogSink>> fileSinks;
+    std::shared_ptr<LogConsoleSink> consoleSink;
+    std::vector<std::shared_ptr<LogSink>> defaultSinks;
+    bool defaultSinksSet = false;
+};
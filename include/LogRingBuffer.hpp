@@ -0,0 +1,136 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+// Size of a cache line on the platforms we target
+constexpr std::size_t logCacheLineSize = 64;
+
+// Bounded lock-free ring buffer (Dmitry Vyukov's sequence-per-slot design).
+//
+// Producers claim a slot with a single compare-and-swap on the write index
+// and publish it by bumping the slot's sequence number, so no thread ever
+// takes a lock. The logger uses it as a multi-producer / single-consumer
+// queue; tryPop() is also safe to call from producers, which is how the
+// drop-oldest overflow policy evicts the head of a full ring.
+template <typename T>
+class LogRingBuffer {
+public:
+    // Capacity is rounded up to the next power of two
+    explicit LogRingBuffer(std::size_t requestedCapacity)
+    : capacityMask(roundUpToPowerOfTwo(requestedCapacity) - 1),
+    slots(new Slot[capacityMask + 1]) {
+        for (std::size_t i = 0; i <= capacityMask; ++i) {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    LogRingBuffer(const LogRingBuffer&) = delete;
+    LogRingBuffer& operator=(const LogRingBuffer&) = delete;
+
+    // Returns false (leaving value untouched) if the ring is full
+    bool tryPush(T&& value) {
+        std::size_t position = writeIndex.load(std::memory_order_relaxed);
+        Slot* slot;
+
+        while (true) {
+            slot = &slots[position & capacityMask];
+            std::size_t sequence = slot->sequence.load(std::memory_order_acquire);
+            std::intptr_t difference = static_cast<std::intptr_t>(sequence) -
+                                       static_cast<std::intptr_t>(position);
+
+            if (difference == 0) {
+                if (writeIndex.compare_exchange_weak(position, position + 1,
+                                                     std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (difference < 0) {
+                return false;
+            } else {
+                position = writeIndex.load(std::memory_order_relaxed);
+            }
+        }
+
+        slot->value = std::move(value);
+        slot->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Returns false if no published record is available
+    bool tryPop(T& value) {
+        std::size_t position = readIndex.load(std::memory_order_relaxed);
+        Slot* slot;
+
+        while (true) {
+            slot = &slots[position & capacityMask];
+            std::size_t sequence = slot->sequence.load(std::memory_order_acquire);
+            std::intptr_t difference = static_cast<std::intptr_t>(sequence) -
+                                       static_cast<std::intptr_t>(position + 1);
+
+            if (difference == 0) {
+                if (readIndex.compare_exchange_weak(position, position + 1,
+                                                    std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (difference < 0) {
+                return false;
+            } else {
+                position = readIndex.load(std::memory_order_relaxed);
+            }
+        }
+
+        value = std::move(slot->value);
+        slot->sequence.store(position + capacityMask + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Visit the published, unconsumed values oldest first without consuming
+    // them. Only for last-resort readers such as a crash dump: nothing stops
+    // a value from being popped while it is being visited.
+    template <typename Visitor>
+    void peekAll(Visitor visit) const {
+        std::size_t read = readIndex.load(std::memory_order_acquire);
+        std::size_t write = writeIndex.load(std::memory_order_acquire);
+        for (std::size_t position = read; position != write; ++position) {
+            const Slot& slot = slots[position & capacityMask];
+            if (slot.sequence.load(std::memory_order_acquire) == position + 1) {
+                visit(slot.value);
+            }
+        }
+    }
+
+    // Number of claimed slots not yet consumed (a snapshot, may be stale)
+    std::size_t size() const {
+        std::size_t write = writeIndex.load(std::memory_order_acquire);
+        std::size_t read = readIndex.load(std::memory_order_acquire);
+        return write > read ? write - read : 0;
+    }
+
+    std::size_t capacity() const {
+        return capacityMask + 1;
+    }
+
+private:
+    struct alignas(logCacheLineSize) Slot {
+        std::atomic<std::size_t> sequence;
+        T value;
+    };
+
+    static std::size_t roundUpToPowerOfTwo(std::size_t value) {
+        std::size_t result = 2;
+        while (result < value) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    const std::size_t capacityMask;
+    std::unique_ptr<Slot[]> slots;
+
+    // Producer and consumer indices live on separate cache lines
+    alignas(logCacheLineSize) std::atomic<std::size_t> writeIndex{0};
+    alignas(logCacheLineSize) std::atomic<std::size_t> readIndex{0};
+};
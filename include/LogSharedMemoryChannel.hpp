@@ -0,0 +1,101 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "LoggerExport.hpp"
+#include "LogLevel.hpp"
+#include "LogSink.hpp"
+
+#ifdef _WIN32
+    #include <windows.h>
+#endif
+
+// A named shared-memory segment that carries log lines from many processes
+// to one collector (see LogSharedMemorySink and LogCollector).
+//
+// The collector creates the segment with a fixed number of rings; each
+// producing process claims a ring of its own, so every ring has exactly one
+// writer and one reader and needs no lock. A ring is a circular byte buffer
+// with two positions shared through atomics at the top of the ring: the
+// writer copies a record in and publishes it with one release store, the
+// reader takes every record up to the write position and releases the
+// space with one store of its own. Nothing in the path makes a system call.
+//
+//   segment   header (magic "LOGSHM01", format, ring count, ring bytes)
+//             ring controls (state, owner pid, write / read positions, drops)
+//             ring data, ringBytes per ring
+//   record    timestamp:i64 (ns since the epoch) length:u32 messageOffset:u32
+//             messageLength:u32 level:u8 (3 bytes padding), then the line
+//             without its newline, padded to 8 bytes
+//
+// A record that does not fit before the end of the ring is written at its
+// start; the gap is marked so the reader skips it. Rings are released by
+// their process (and reclaimed by the collector from processes that died),
+// so a restarted worker gets a ring again.
+class LOGGER_API LogSharedMemoryChannel {
+public:
+    static constexpr std::size_t defaultRingCount = 64;
+    static constexpr std::size_t defaultRingBytes = 1024 * 1024;
+    static constexpr std::size_t noRing = static_cast<std::size_t>(-1);
+
+    LogSharedMemoryChannel() = default;
+    ~LogSharedMemoryChannel();
+
+    LogSharedMemoryChannel(const LogSharedMemoryChannel&) = delete;
+    LogSharedMemoryChannel& operator=(const LogSharedMemoryChannel&) = delete;
+
+    // Collector side: create the segment, replacing one left by an earlier
+    // collector (whose producers see it closed and attach again). Ring
+    // bytes are rounded up to a power of two of at least 4 KiB.
+    bool create(const std::string& name, LogSinkFormat format,
+                std::size_t ringCount = defaultRingCount, std::size_t ringBytes = defaultRingBytes);
+    // Producer side: map a segment the collector created
+    bool open(const std::string& name);
+    // Unmap; a creating collector also marks the segment closed and removes its name
+    void close();
+
+    bool isOpen() const;
+    // True once the collector that created the segment has closed it
+    bool isClosed() const;
+    LogSinkFormat getFormat() const;
+    std::size_t getRingCount() const;
+    std::size_t getRingBytes() const;
+
+    // Producer side: take a free ring for this process (noRing if all are
+    // taken), and hand it back once done with it
+    std::size_t claimRing();
+    void releaseRing(std::size_t ring);
+
+    // Producer side: copy one line into a ring and publish it; false (and
+    // counted as dropped) if the ring has no room for it
+    bool push(std::size_t ring, std::int64_t timestampNanoseconds, LogLevel level,
+              const char* line, std::size_t length, std::size_t messageOffset, std::size_t messageLength);
+
+    // Collector side: append every record ready in a ring to the batch
+    // (as lines, see LogSinkBatch::appendLine) and release their space;
+    // returns the number of records taken
+    std::size_t drain(std::size_t ring, LogSinkBatch& batch);
+
+    // Collector side: free the rings of producers that released them or
+    // died, once they are empty; returns the number of rings still in use
+    std::size_t reclaimRings();
+
+    // Records producers dropped because their ring was full (rings freed
+    // by reclaimRings() included)
+    std::uint64_t getDroppedRecords() const;
+
+private:
+    bool map(std::size_t size, bool creating);
+
+#ifdef _WIN32
+    HANDLE mappingHandle = nullptr;
+#endif
+    char* segment = nullptr;
+    std::size_t segmentSize = 0;
+    std::string segmentName;
+    bool creator = false;
+    std::uint64_t reclaimedDrops = 0;
+};
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "LoggerExport.hpp"
+#include "LogLevel.hpp"
+#include "LogSink.hpp"
+#include "LogSharedMemoryChannel.hpp"
+
+// Hands records to a collector process through a shared-memory ring (see
+// LogSharedMemoryChannel), for servers whose worker processes should not
+// each open, write and rotate the same file.
+//
+// The sink claims a ring of the channel for its process and copies every
+// record into it: a memcpy and one atomic store, no system call, and never
+// a wait for the collector. Records that find the ring full, or no
+// collector yet, are dropped and counted. While detached the sink looks for
+// the channel again every reattachDelay, so workers may start before the
+// collector and survive its restart. A process forked from the sink's
+// process claims a ring of its own on its first write.
+//
+// Text, Json and Logfmt sinks carry their lines as formatted here (the
+// logger's layout and name included); the channel's format must match.
+// Not thread-safe: the owner serialises access (wrap it in LogSharedSink to
+// attach it to several loggers).
+class LOGGER_API LogSharedMemorySink : public LogSink {
+public:
+    static constexpr std::chrono::milliseconds reattachDelay{1000};
+
+    explicit LogSharedMemorySink(const std::string& channelName, LogSinkFormat format = LogSinkFormat::Text);
+    ~LogSharedMemorySink() override;
+
+    LogSharedMemorySink(const LogSharedMemorySink&) = delete;
+    LogSharedMemorySink& operator=(const LogSharedMemorySink&) = delete;
+
+    void write(const LogSinkBatch& batch) override;
+
+    // Only copies into the mapped ring, so safe from the crash handler
+    void crashWrite(const char* record, std::size_t length) override;
+
+    // True while the sink holds a ring of a live channel
+    bool isAttached() const;
+    std::uint64_t getDroppedRecords() const;
+
+private:
+    bool attach();
+    void detach();
+    void push(std::chrono::system_clock::time_point timestamp, LogLevel level, const char* record,
+              std::size_t length, std::size_t messageOffset, std::size_t messageLength);
+
+    std::string channelName;
+    LogSharedMemoryChannel channel;
+    std::size_t ring = LogSharedMemoryChannel::noRing;
+    std::uint64_t ringGeneration = 0; // process generation (bumped by fork) the ring was claimed in
+    std::chrono::steady_clock::time_point nextAttach{};
+    std::uint64_t droppedRecords = 0;
+};
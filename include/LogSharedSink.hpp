@@ -0,0 +1,33 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+
+#include "LoggerExport.hpp"
+#include "LogSink.hpp"
+
+// Makes a sink safe to attach to several loggers.
+//
+// Every call is forwarded to the wrapped sink under one mutex, taken once
+// per batch. Records below the wrapper's own level are left out (the same
+// check the logger's metrics and crash dumps make); the wrapped sink's
+// level threshold still applies after it.
+class LOGGER_API LogSharedSink : public LogSink {
+public:
+    explicit LogSharedSink(std::shared_ptr<LogSink> sink);
+
+    void write(const LogSinkBatch& batch) override;
+    void flush() override;
+    void flushIfDue() override;
+
+    // Forwarded without the mutex: the crashed thread may hold it
+    void crashFlush() override;
+    void crashWrite(const char* record, std::size_t length) override;
+
+    const std::shared_ptr<LogSink>& getSink() const;
+
+private:
+    std::shared_ptr<LogSink> sink;
+    std::mutex sinkMutex;
+    LogSinkBatch accepted; // the records of a batch this level takes (under sinkMutex)
+};
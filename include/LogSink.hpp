@@ -0,0 +1,220 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "LoggerExport.hpp"
+#include "LogLevel.hpp"
+#include "LogLineBuffer.hpp"
+#include "LogFileWriter.hpp"
+
+// When a buffering sink hands what it has collected to the operating system
+struct LogFlushPolicy {
+    std::size_t maxBufferedBytes = 64 * 1024;       // flush once this much is buffered
+    std::chrono::milliseconds maxDelay{1000};      // flush data older than this (0 = never)
+    LogLevel flushLevel = LogLevel::Error;         // flush after records at or above this level
+
+    // File sinks: how buffers reach the file (applied when the file is opened)
+    LogFileIoBackend ioBackend = LogFileIoBackend::Blocking;
+    std::size_t buffersInFlight = 4;               // Async: writes submitted but not yet completed
+};
+
+// Byte layout a sink wants its records in
+enum class LogSinkFormat : std::uint8_t {
+    Text,   // "[timestamp] [name...] [LEVEL..] message\n" (LogTextLayout)
+    Binary, // LogBinaryFormat records
+    Json,   // one JSON object per line (LogStructuredFormat)
+    Logfmt  // one logfmt line per record (LogStructuredFormat)
+};
+
+// One record inside a LogSinkBatch
+struct LogSinkEntry {
+    std::chrono::system_clock::time_point timestamp;
+    LogLevel level;
+    std::size_t offset;        // start of the record in the batch data
+    std::size_t length;        // record bytes, including a text line's newline
+    std::size_t messageOffset; // start of the message within the record (text lines)
+    std::size_t messageLength; // message bytes, excluding the fields rendered after them
+    std::size_t fieldsOffset;  // structured fields, in the batch's field data
+    std::size_t fieldsLength;  // (a LogStructuredFormat payload; 0 if none)
+    std::uint32_t thread;      // id of the thread that logged the record (0 if unknown)
+    std::uint32_t callSite;    // LogCallSites id (0 if none)
+};
+
+// Records of one format laid out back to back in one buffer.
+//
+// A sink can write the whole run in one call, or walk the entries when it
+// filters by level or decorates each line. Batches are meant to be reused:
+// clear() keeps the capacity of both the data and the entry list.
+class LogSinkBatch {
+public:
+    explicit LogSinkBatch(LogSinkFormat format = LogSinkFormat::Text)
+    : batchFormat(format) {
+    }
+
+    void clear() {
+        bytes.clear();
+        fieldBytes.clear();
+        entryList.clear();
+        lowest = LogLevel::Off;
+        highest = LogLevel::Message;
+    }
+
+    // Append one record as-is
+    void append(std::chrono::system_clock::time_point timestamp, LogLevel level,
+                const char* record, std::size_t length, std::size_t messageOffset = 0,
+                std::uint32_t thread = 0, std::uint32_t callSite = 0) {
+        entryList.push_back(LogSinkEntry{timestamp, level, bytes.size(), length, messageOffset,
+                                         length - messageOffset, fieldBytes.size(), 0, thread, callSite});
+        bytes.append(record, length);
+        noteLevel(level);
+    }
+
+    // Append one text line and its newline. By default the message runs to
+    // the end of the line; a structured record passes where its message ends
+    // and the encoded fields shown after it.
+    void appendLine(std::chrono::system_clock::time_point timestamp, LogLevel level,
+                    const char* line, std::size_t length, std::size_t messageOffset,
+                    std::size_t messageLength = noMessageLength,
+                    const char* fields = nullptr, std::size_t fieldsLength = 0,
+                    std::uint32_t thread = 0, std::uint32_t callSite = 0) {
+        if (messageLength == noMessageLength) {
+            messageLength = length - messageOffset;
+        }
+        entryList.push_back(LogSinkEntry{timestamp, level, bytes.size(), length + 1, messageOffset,
+                                         messageLength, fieldBytes.size(), fieldsLength, thread, callSite});
+        bytes.append(line, length);
+        bytes.append('\n');
+        if (fieldsLength > 0) {
+            fieldBytes.append(fields, fieldsLength);
+        }
+        noteLevel(level);
+    }
+
+    // Append a copy of another batch's record, fields included
+    void appendEntry(const LogSinkBatch& from, const LogSinkEntry& entry) {
+        LogSinkEntry copied = entry;
+        copied.offset = bytes.size();
+        copied.fieldsOffset = fieldBytes.size();
+        entryList.push_back(copied);
+        bytes.append(from.data() + entry.offset, entry.length);
+        if (entry.fieldsLength > 0) {
+            fieldBytes.append(from.fieldData() + entry.fieldsOffset, entry.fieldsLength);
+        }
+        noteLevel(entry.level);
+    }
+
+    static constexpr std::size_t noMessageLength = static_cast<std::size_t>(-1);
+
+    LogSinkFormat format() const { return batchFormat; }
+    const char* data() const { return bytes.data(); }
+    std::size_t size() const { return bytes.size(); }
+    bool empty() const { return entryList.empty(); }
+    std::size_t count() const { return entryList.size(); }
+    const std::vector<LogSinkEntry>& entries() const { return entryList; }
+    const char* fieldData() const { return fieldBytes.data(); }
+
+    // Range of levels in the batch (meaningless while empty)
+    LogLevel lowestLevel() const { return lowest; }
+    LogLevel highestLevel() const { return highest; }
+
+private:
+    void noteLevel(LogLevel level) {
+        lowest = level < lowest ? level : lowest;
+        highest = level > highest ? level : highest;
+    }
+
+    LogSinkFormat batchFormat;
+    LogLineBuffer bytes;
+    LogLineBuffer fieldBytes;
+    std::vector<LogSinkEntry> entryList;
+    LogLevel lowest = LogLevel::Off;
+    LogLevel highest = LogLevel::Message;
+};
+
+// A destination for log records (console, file, memory, network, ...).
+//
+// A logger formats each record once per format its sinks ask for and hands
+// every sink whole batches: one virtual call per sink per batch, made while
+// the logger holds its single sink lock. A sink attached to more than one
+// logger must serialise write() itself. Each sink has its own level
+// threshold on top of the logger's.
+class LOGGER_API LogSink {
+public:
+    explicit LogSink(LogSinkFormat format = LogSinkFormat::Text);
+    virtual ~LogSink();
+
+    LogSink(const LogSink&) = delete;
+    LogSink& operator=(const LogSink&) = delete;
+
+    LogSinkFormat getFormat() const {
+        return format;
+    }
+
+    void setMinLevel(LogLevel level) {
+        minLevel.store(static_cast<std::uint8_t>(level), std::memory_order_relaxed);
+    }
+
+    LogLevel getMinLevel() const {
+        return static_cast<LogLevel>(minLevel.load(std::memory_order_relaxed));
+    }
+
+    bool accepts(LogLevel level) const {
+        return static_cast<std::uint8_t>(level) >= minLevel.load(std::memory_order_relaxed);
+    }
+
+    // True if every record in the batch passes this sink's level
+    bool acceptsAll(const LogSinkBatch& batch) const {
+        return accepts(batch.lowestLevel());
+    }
+
+    // Write the records of a batch that pass this sink's level
+    virtual void write(const LogSinkBatch& batch) = 0;
+
+    // Hand everything written so far to the destination
+    virtual void flush();
+
+    // Apply time-based flushing (called by an idle asynchronous writer)
+    virtual void flushIfDue();
+
+    // Crash path (LogCrashHandler): write out anything buffered, then take
+    // single records. Implementations may only use async-signal-safe calls:
+    // no locks, no allocation, no iostreams.
+    virtual void crashFlush();
+    virtual void crashWrite(const char* record, std::size_t length);
+
+    // Self-metrics (see LogMetrics): records and bytes handed to write() by
+    // loggers, and the times buffered data was handed on to the destination
+    std::uint64_t getWrittenRecords() const {
+        return writtenRecords.load(std::memory_order_relaxed);
+    }
+    std::uint64_t getWrittenBytes() const {
+        return writtenBytes.load(std::memory_order_relaxed);
+    }
+    std::uint64_t getFlushes() const {
+        return flushes.load(std::memory_order_relaxed);
+    }
+
+protected:
+    // Buffering sinks call this for every hand-off of buffered data
+    void countFlush() {
+        flushes.fetch_add(1, std::memory_order_relaxed);
+    }
+
+private:
+    friend class LoggerHandler;
+
+    void countWritten(std::uint64_t records, std::uint64_t bytes) {
+        writtenRecords.fetch_add(records, std::memory_order_relaxed);
+        writtenBytes.fetch_add(bytes, std::memory_order_relaxed);
+    }
+
+    const LogSinkFormat format;
+    std::atomic<std::uint8_t> minLevel{static_cast<std::uint8_t>(LogLevel::Message)};
+    std::atomic<std::uint64_t> writtenRecords{0};
+    std::atomic<std::uint64_t> writtenBytes{0};
+    std::atomic<std::uint64_t> flushes{0};
+};
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+
+#include "LoggerExport.hpp"
+#include "LogLevel.hpp"
+#include "LogLineBuffer.hpp"
+#include "LogTimestamp.hpp"
+
+// The text line layout: "[timestamp] [name...........] [LEVEL..] message".
+//
+// Shared by the logger and by tools that turn other formats back into text,
+// so both produce byte-identical lines.
+class LOGGER_API LogTextLayout {
+public:
+    static constexpr std::size_t loggerNameWidth = 15;
+    static constexpr std::size_t paddedLevelLength = 10;
+
+    // "[name.....] ", padded with '.' to loggerNameWidth (longer names are kept whole)
+    static std::string padName(const std::string& loggerName);
+
+    // "[LEVEL..] ", always paddedLevelLength characters
+    static const char* paddedLevel(LogLevel level);
+
+    // Length of the line prefix for a given padded name
+    static std::size_t prefixLength(const std::string& paddedName) {
+        return 1 + logTimestampLength + 2 + paddedName.size() + paddedLevelLength;
+    }
+
+    // Replace out's contents with the line prefix
+    static void formatPrefix(LogLineBuffer& out, std::chrono::system_clock::time_point timestamp,
+                             const std::string& paddedName, LogLevel level,
+                             LogTimestampCache& timestampCache);
+};
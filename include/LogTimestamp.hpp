@@ -0,0 +1,52 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include "LoggerExport.hpp"
+
+// Length of "YYYY-MM-DD HH:MM:SS.mmm"
+constexpr std::size_t logTimestampLength = 23;
+
+// Length of "YYYY-MM-DDTHH:MM:SS.mmmZ" (ISO-8601, UTC)
+constexpr std::size_t logUtcTimestampLength = 24;
+
+// Formats local-time timestamps without going through iostreams.
+//
+// The date and time-of-day text is cached and only the changing digits are
+// patched: milliseconds on every call, seconds when the second changes.
+// The time-zone conversion (localtime_r / localtime_s) runs only when the
+// minute changes. UTC text has a cache of its own and needs no conversion
+// call at all. A cache is not thread-safe; give each thread its own.
+//
+// After setFixedUtcOffset() local time is UTC plus that offset, computed
+// without any library call: async-signal-safe, but blind to later
+// daylight-saving or time-zone changes (the crash handler's cache).
+class LOGGER_API LogTimestampCache {
+public:
+    // Writes exactly logTimestampLength characters to out (no terminator)
+    void format(std::chrono::system_clock::time_point timestamp, char* out);
+
+    // Writes exactly logUtcTimestampLength characters to out (no terminator)
+    void formatUtc(std::chrono::system_clock::time_point timestamp, char* out);
+
+    // Use this offset from UTC instead of the time-zone database
+    void setFixedUtcOffset(std::int64_t offsetSeconds);
+
+    // Local time minus UTC at timestamp, in seconds (calls localtime_r / localtime_s)
+    static std::int64_t utcOffsetAt(std::chrono::system_clock::time_point timestamp);
+
+private:
+    void refresh(std::int64_t second);
+    void refreshFixedOffset(std::int64_t second);
+
+    std::int64_t cachedSecond = INT64_MIN;
+    std::int64_t minuteStart = INT64_MIN;
+    char cachedText[19] = {};
+    bool hasFixedOffset = false;
+    std::int64_t fixedOffset = 0;
+
+    std::int64_t cachedUtcSecond = INT64_MIN;
+    char cachedUtcText[19] = {};
+};
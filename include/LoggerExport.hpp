@@ -0,0 +1,16 @@
+#pragma once
+
+// DLL export / import (Windows only)
+#ifdef _WIN32
+    #if defined(LOGGER_DYNAMIC)
+        #if defined(LOGGER_BUILD)
+            #define LOGGER_API __declspec(dllexport)
+        #else
+            #define LOGGER_API __declspec(dllimport)
+        #endif
+    #else
+        #define LOGGER_API
+    #endif
+#else
+    #define LOGGER_API
+#endif
@@ -1,75 +1,652 @@
-#pragma once
-
-#include <string>
-#include <mutex>
-#include <iostream>
-#include <fstream>
-#include <iomanip>
-#include <chrono>
-#include <sstream>
-
-// DLL export / import (Windows only)
-#ifdef _WIN32
-    #if defined(LOGGER_DYNAMIC)
-        #if defined(LOGGER_BUILD)
-            #define LOGGER_API __declspec(dllexport)
-        #else
-            #define LOGGER_API __declspec(dllimport)
-        #endif
-    #else
-        #define LOGGER_API
-    #endif
-#else
-    #define LOGGER_API
-#endif
-
-#ifdef _WIN32
-    #include <windows.h>
-#else
-    // Linux/macOS console colours via ANSI escape codes
-    #define FOREGROUND_RED          0x0001
-    #define FOREGROUND_GREEN        0x0002
-    #define FOREGROUND_BLUE         0x0004
-    #define FOREGROUND_INTENSITY    0x0008
-    typedef unsigned short WORD;
-#endif
-
-class LOGGER_API LoggerHandler {
-public:
-    // Constructors & Destructor
-    LoggerHandler(const std::string& loggerName, std::mutex& consoleMutex);
-    LoggerHandler(const std::string& loggerName);
-    ~LoggerHandler();
-
-    // File logging
-    void enableFileLogging(const std::string& filePath);
-    void disableFileLogging();
-
-    // Logging methods
-    void logMessage(const std::string& message);
-    void logSuccess(const std::string& message);
-    void logWarning(const std::string& message);
-    void logError(const std::string& message);
-
-private:
-    void logToConsole(const std::string& prefix, const std::string& message, WORD color);
-    void logToFile(const std::string& prefix, const std::string& message);
-    void setConsoleColor(WORD color);
-    void resetConsoleColor();
-    std::string getCurrentTimestamp();
-    std::string formatLogLine(const std::string& prefix, const std::string& message);
-    void initConsole();
-
-    std::string loggerName;
-    std::mutex internalMutex;
-    std::mutex& consoleMutex;
-
-#ifdef _WIN32
-    HANDLE consoleHandle;
-#else
-    bool useColors;
-#endif
-
-    std::ofstream logFile;
-    std::mutex fileMutex;
+#pragma once
+
+#include <string>
+#include <mutex>
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <chrono>
+#include <sstream>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include <optional>
+
+#include "LoggerExport.hpp"
+#include "LogLevel.hpp"
+#include "LogRingBuffer.hpp"
+#include "LogSink.hpp"
+#include "LogConsoleSink.hpp"
+#include "LogMemorySink.hpp"
+#include "LogLineBuffer.hpp"
+#include "LogFormatter.hpp"
+#include "LogFileSink.hpp"
+#include "LogMmapSink.hpp"
+#include "LogCallSite.hpp"
+#include "LogPattern.hpp"
+#include "LogTextLayout.hpp"
+#include "LogBinaryFormat.hpp"
+#include "LogRateLimiter.hpp"
+#include "LogStructuredFormat.hpp"
+#include "LogArena.hpp"
+#include "LogMetrics.hpp"
+#include "LogConfig.hpp"
+#include "LogReclaimer.hpp"
+
+// Compile-time threshold: LOGGER_* macro calls below it compile to nothing,
+// arguments included. Define LOGGER_COMPILE_LEVEL to one of these before
+// including this header (or on the compiler command line).
+#define LOGGER_LEVEL_MESSAGE 0
+#define LOGGER_LEVEL_SUCCESS 1
+#define LOGGER_LEVEL_WARNING 2
+#define LOGGER_LEVEL_ERROR   3
+#define LOGGER_LEVEL_OFF     4
+
+#ifndef LOGGER_COMPILE_LEVEL
+    #define LOGGER_COMPILE_LEVEL LOGGER_LEVEL_MESSAGE
+#endif
+
+// Whether calls at level survive the compile-time threshold (a function, so
+// the comparison with LOGGER_LEVEL_MESSAGE does not trip -Wtype-limits)
+constexpr bool logCompiledIn(LogLevel level, int compileLevel) {
+    return static_cast<int>(level) >= compileLevel;
+}
+
+#define LOGGER_LOG(logger, level, message)                                   \
+    do {                                                                     \
+        if constexpr (logCompiledIn((level), LOGGER_COMPILE_LEVEL)) {        \
+            if ((logger).isEnabled(level)) {                                 \
+                (logger).log((level), (message));                           \
+            }                                                                \
+        }                                                                    \
+    } while (0)
+
+#define LOGGER_MESSAGE(logger, message) LOGGER_LOG(logger, LogLevel::Message, message)
+#define LOGGER_SUCCESS(logger, message) LOGGER_LOG(logger, LogLevel::Success, message)
+#define LOGGER_WARNING(logger, message) LOGGER_LOG(logger, LogLevel::Warning, message)
+#define LOGGER_ERROR(logger, message)   LOGGER_LOG(logger, LogLevel::Error, message)
+
+// Rate-limited call site: at most perSecond records per second after an
+// initial burst, counted per expansion of the macro (each call site has its
+// own bucket). Suppressed calls cost one atomic load and never evaluate their
+// arguments; the first record let through afterwards is preceded by a notice
+// giving how many were dropped. Takes a message or a "{}" format and values.
+#define LOGGER_LOG_LIMITED(logger, level, perSecond, burst, ...)                   \
+    do {                                                                           \
+        if constexpr (logCompiledIn((level), LOGGER_COMPILE_LEVEL)) {              \
+            static LogRateLimiter loggerCallSiteLimiter((perSecond), (burst));     \
+            if ((logger).isEnabled(level) &&                                       \
+                (logger).passesRateLimit(loggerCallSiteLimiter, (level))) {        \
+                (logger).log((level), __VA_ARGS__);                               \
+            }                                                                      \
+        }                                                                          \
+    } while (0)
+
+#define LOGGER_MESSAGE_LIMITED(logger, perSecond, burst, ...) \
+    LOGGER_LOG_LIMITED(logger, LogLevel::Message, perSecond, burst, __VA_ARGS__)
+#define LOGGER_SUCCESS_LIMITED(logger, perSecond, burst, ...) \
+    LOGGER_LOG_LIMITED(logger, LogLevel::Success, perSecond, burst, __VA_ARGS__)
+#define LOGGER_WARNING_LIMITED(logger, perSecond, burst, ...) \
+    LOGGER_LOG_LIMITED(logger, LogLevel::Warning, perSecond, burst, __VA_ARGS__)
+#define LOGGER_ERROR_LIMITED(logger, perSecond, burst, ...) \
+    LOGGER_LOG_LIMITED(logger, LogLevel::Error, perSecond, burst, __VA_ARGS__)
+
+// Call-site logging: each statement registers its file, line, function,
+// level and format once (LogCallSites) and its records carry only the id
+#define LOGGER_LOG_AT(logger, level, ...)                                      \
+    do {                                                                       \
+        if constexpr (logCompiledIn((level), LOGGER_COMPILE_LEVEL)) {          \
+            static LogCallSiteHandle loggerCallSite(                           \
+                __FILE__, __LINE__, __func__, (level));                        \
+            if ((logger).isEnabled(level)) {                                   \
+                (logger).logAt(loggerCallSite, (level), __VA_ARGS__);          \
+            }                                                                  \
+        }                                                                      \
+    } while (0)
+
+#define LOGGER_MESSAGE_AT(logger, ...) LOGGER_LOG_AT(logger, LogLevel::Message, __VA_ARGS__)
+#define LOGGER_SUCCESS_AT(logger, ...) LOGGER_LOG_AT(logger, LogLevel::Success, __VA_ARGS__)
+#define LOGGER_WARNING_AT(logger, ...) LOGGER_LOG_AT(logger, LogLevel::Warning, __VA_ARGS__)
+#define LOGGER_ERROR_AT(logger, ...)   LOGGER_LOG_AT(logger, LogLevel::Error, __VA_ARGS__)
+
+// Structured records with their call site: message, then logField()s
+#define LOGGER_FIELDS_AT(logger, level, ...)                                   \
+    do {                                                                       \
+        if constexpr (logCompiledIn((level), LOGGER_COMPILE_LEVEL)) {          \
+            static LogCallSiteHandle loggerCallSite(                           \
+                __FILE__, __LINE__, __func__, (level));                        \
+            if ((logger).isEnabled(level)) {                                   \
+                (logger).logFieldsAt(loggerCallSite, (level), __VA_ARGS__);    \
+            }                                                                  \
+        }                                                                      \
+    } while (0)
+
+// What an asynchronous logger does when its queue is full
+enum class LogOverflowPolicy {
+    Block,      // wait for the writer thread to make room
+    DropNewest, // discard the record being logged
+    DropOldest  // discard the oldest queued record
+};
+
+// How thread-buffered logging merges records from different threads
+enum class LogMergeOrder {
+    Timestamp, // oldest first across threads (within each merge round)
+    PerThread  // each thread's records as one run, in the order it logged them
+};
+
+class LogBatch;
+
+class LOGGER_API LoggerHandler {
+public:
+    // Constructors & Destructor
+    LoggerHandler(const std::string& loggerName, std::mutex& consoleMutex);
+    LoggerHandler(const std::string& loggerName);
+    // Writes to the given sinks only (see also LogRegistry)
+    LoggerHandler(const std::string& loggerName, const std::vector<std::shared_ptr<LogSink>>& sinks);
+    ~LoggerHandler();
+
+    // File logging
+    void enableFileLogging(const std::string& filePath);
+    void enableFileLogging(const std::string& filePath, const LogFlushPolicy& flushPolicy,
+                           const LogRotationPolicy& rotationPolicy = LogRotationPolicy(),
+                           const LogCompressionPolicy& compressionPolicy = LogCompressionPolicy());
+    // Binary records (see LogBinaryFormat) instead of text lines; convert
+    // them back with the log_decode tool
+    void enableBinaryFileLogging(const std::string& filePath,
+                                 const LogFlushPolicy& flushPolicy = LogFlushPolicy(),
+                                 const LogRotationPolicy& rotationPolicy = LogRotationPolicy());
+    // JSON lines (or logfmt) instead of text lines, for log pipelines that
+    // ingest structured records
+    void enableStructuredFileLogging(const std::string& filePath,
+                                     LogSinkFormat format = LogSinkFormat::Json,
+                                     const LogFlushPolicy& flushPolicy = LogFlushPolicy(),
+                                     const LogRotationPolicy& rotationPolicy = LogRotationPolicy());
+    void enableMappedFileLogging(const std::string& filePath,
+                                 std::size_t chunkSize = LogMmapSink::defaultChunkSize);
+    void disableFileLogging();
+
+    // Sinks: every record goes to each attached sink whose level it passes.
+    // The constructor attaches a console sink (unless given its sinks, in
+    // which case getConsoleSink() is the first console sink among them, or
+    // null); file logging attaches and detaches its own file sink.
+    void addSink(std::shared_ptr<LogSink> sink);
+    void removeSink(const std::shared_ptr<LogSink>& sink);
+    const std::shared_ptr<LogConsoleSink>& getConsoleSink() const;
+
+    // Write out everything logged so far (drains the asynchronous queue first)
+    void flush();
+
+    // Asynchronous logging (records are written by a background thread)
+    void enableAsyncLogging(std::size_t queueCapacity = 8192,
+                            LogOverflowPolicy overflowPolicy = LogOverflowPolicy::Block);
+    void disableAsyncLogging();
+
+    // Thread-buffered logging: each thread appends to its own lock-free
+    // buffer, so producers never contend with each other; the writer thread
+    // collects the buffers and merges them into the sinks. Switched off by
+    // disableAsyncLogging() (or replaced by enableAsyncLogging()).
+    void enableThreadBufferedLogging(std::size_t perThreadCapacity = 1024,
+                                     LogMergeOrder mergeOrder = LogMergeOrder::Timestamp,
+                                     LogOverflowPolicy overflowPolicy = LogOverflowPolicy::Block);
+
+    // Asynchronous queue counters (in thread-buffered mode the depth is the
+    // total over all threads and the capacity is per thread)
+    std::size_t getQueueDepth() const;
+    std::size_t getQueueCapacity() const;
+    std::uint64_t getDroppedRecords() const;
+
+    // Runtime level filtering (checked before any formatting)
+    void setMinLevel(LogLevel level);
+    LogLevel getMinLevel() const;
+    bool isEnabled(LogLevel level) const {
+        return static_cast<std::uint8_t>(level) >= publishedMinLevel.load(std::memory_order_acquire);
+    }
+
+    // Runtime configuration (see LogConfig). The level, sampling and repeat
+    // collapsing settings are one immutable snapshot: each record reads it
+    // in place under the reclaimer guard it holds for the whole record, and
+    // setConfig() (like the setters for each setting) publishes a new one by
+    // pointer swap, without blocking any logging thread. Replaced snapshots
+    // and layouts are freed by a later change once no thread can still be
+    // reading them (see LogReclaimer); getRetiredSnapshots() counts the ones
+    // not freed yet. applyConfig() applies a config file's settings for this
+    // logger, the snapshot in one swap; its pattern and file are only
+    // applied when they differ from the ones the last file set, so
+    // reapplying an unchanged file reopens nothing. An invalid file is
+    // reported and changes nothing. See LogConfigReloader for SIGHUP.
+    LogConfig getConfig() const;
+    void setConfig(const LogConfig& newConfig);
+    bool applyConfig(const LogConfigFile& file);
+    bool loadConfig(const std::string& path);
+    std::size_t getRetiredSnapshots() const;
+
+    // Rate limiting (see LOGGER_LOG_LIMITED): true if the limiter admits a
+    // record now; reports records it suppressed since the last admission
+    bool passesRateLimit(LogRateLimiter& limiter, LogLevel level);
+    std::uint64_t getRateLimitedRecords() const;
+
+    // Repeat collapsing: a record identical to the one before it (same level
+    // and text, or same format and values) is counted instead of written, and
+    // a single "Last message repeated N times" line follows once a different
+    // record arrives or the logger is flushed
+    void setCollapseRepeats(bool enabled);
+    bool getCollapseRepeats() const;
+    std::uint64_t getCollapsedRecords() const;
+
+    // Line layout of text sinks (see LogPattern). A pattern known at compile
+    // time is compiled into a layout of its own; a pattern string is parsed
+    // once here, and an invalid one is reported and leaves the layout as it
+    // was. Either way the logger's padded name is rendered once, not per line.
+    template <const char* Pattern>
+    void setLayout() {
+        installLayout(std::make_unique<LogPatternLayout<Pattern>>(loggerName));
+    }
+    bool setLayout(const std::string& pattern);
+
+    // Sampling: keep one record in every n (counted per thread), or each
+    // record with the given probability, at one level or at every level.
+    // Dropped records cost a counter or random number and nothing else; kept
+    // ones end with "[sample rate 1/n]" (or the probability) so their counts
+    // can be re-weighted. n = 1 or probability 1 turns sampling off.
+    void setSampleEvery(LogLevel level, std::uint32_t n);
+    void setSampleEvery(std::uint32_t n);
+    void setSampleProbability(LogLevel level, double probability);
+    void setSampleProbability(double probability);
+    std::uint64_t getSampledOutRecords() const;
+
+    // Self-metrics (see LogMetrics): records per level, drops and filters,
+    // the queue's high-water mark, bytes and flushes per sink, and latency
+    // histograms for enqueueing, formatting and sink writes once latency
+    // timing is on. With an interval set, the same summary is logged as a
+    // Message line that often (checked as records are written and by the
+    // idle asynchronous writer); 0 turns it off.
+    LogMetricsSnapshot getMetrics() const;
+    void setLatencyMetrics(bool enabled);
+    void setMetricsInterval(std::chrono::milliseconds interval);
+
+    // Logging methods. The message is only borrowed: asynchronous records
+    // copy it into the calling thread's arena (see LogArena), so queueing
+    // allocates nothing once the arena is warm.
+    void log(LogLevel level, std::string_view message);
+    void log(LogLevel level, const char* message);
+    // Hands over the caller's buffer: a message too large for the arena is
+    // queued as it is instead of being copied
+    void log(LogLevel level, std::string&& message);
+    void logMessage(std::string_view message);
+    void logSuccess(std::string_view message);
+    void logWarning(std::string_view message);
+    void logError(std::string_view message);
+
+    // Structured logging: a message plus typed fields built with logField().
+    // Json and Logfmt sinks get the fields as their own keys; text lines show
+    // them as " key=value" after the message.
+    template <typename... Fields>
+    void logFields(LogLevel level, std::string_view message, const LogField<Fields>&... fields) {
+        logStructured(LogCallSites::none, level, message, fields...);
+    }
+
+    // Log several messages as one batch (see LogBatch)
+    void logMany(LogLevel level, const std::vector<std::string>& messages);
+
+    // Deferred "{}" formatting: arguments are only formatted once the level
+    // check passes, directly into the output line. In asynchronous mode they
+    // are captured in binary form and formatted on the writer thread, which
+    // is why the format must be a string literal (or otherwise outlive it).
+    template <std::size_t N, typename... Args>
+    std::enable_if_t<(sizeof...(Args) > 0)> log(LogLevel level, const char (&format)[N], const Args&... args) {
+        logFormatted(LogCallSites::none, level, format, args...);
+    }
+
+    template <std::size_t N, typename... Args>
+    std::enable_if_t<(sizeof...(Args) > 0)> logMessage(const char (&format)[N], const Args&... args) {
+        log(LogLevel::Message, format, args...);
+    }
+
+    template <std::size_t N, typename... Args>
+    std::enable_if_t<(sizeof...(Args) > 0)> logSuccess(const char (&format)[N], const Args&... args) {
+        log(LogLevel::Success, format, args...);
+    }
+
+    template <std::size_t N, typename... Args>
+    std::enable_if_t<(sizeof...(Args) > 0)> logWarning(const char (&format)[N], const Args&... args) {
+        log(LogLevel::Warning, format, args...);
+    }
+
+    template <std::size_t N, typename... Args>
+    std::enable_if_t<(sizeof...(Args) > 0)> logError(const char (&format)[N], const Args&... args) {
+        log(LogLevel::Error, format, args...);
+    }
+
+    // Call-site logging (the LOGGER_*_AT macros): as above, and the record
+    // also carries the id of the statement that logged it (see LogCallSites)
+    // and of the logging thread. Text layouts show them through {file},
+    // {line}, {function} and {thread}; Json and Logfmt records get them as
+    // keys; binary records store the two ids.
+    void logAt(LogCallSiteHandle& site, LogLevel level, std::string_view message);
+
+    template <std::size_t N>
+    void logAt(LogCallSiteHandle& site, LogLevel level, const char (&message)[N]) {
+        if (isEnabled(level)) {
+            logText(site.id(message), level, message);
+        }
+    }
+
+    template <std::size_t N, typename... Args>
+    std::enable_if_t<(sizeof...(Args) > 0)> logAt(LogCallSiteHandle& site, LogLevel level,
+                                                  const char (&format)[N], const Args&... args) {
+        if (isEnabled(level)) {
+            logFormatted(site.id(format), level, format, args...);
+        }
+    }
+
+    template <typename... Fields>
+    void logFieldsAt(LogCallSiteHandle& site, LogLevel level, std::string_view message,
+                     const LogField<Fields>&... fields) {
+        if (isEnabled(level)) {
+            logStructured(site.id(nullptr), level, message, fields...);
+        }
+    }
+
+private:
+    friend class LogBatch;
+    friend class LogCrashHandler;
+
+    // A record waiting in the asynchronous queue (one ring slot per record)
+    struct LogRecord {
+        std::chrono::system_clock::time_point timestamp;
+        LogLevel level = LogLevel::Message;
+        std::uint32_t thread = 0;       // logThreadId() of the logging thread
+        std::uint32_t callSite = LogCallSites::none;
+        LogArenaBlock payload;          // the message, then the structured fields (LogStructuredFormat payload)
+        std::size_t messageLength = 0;  // where the fields start in payload
+        std::string ownedMessage;       // a large message handed over by the caller (payload is empty)
+        const char* format = nullptr;   // deferred "{}" format string
+        bool batch = false;             // message holds a whole LogBatch
+        float sampleRate = 1.0f;        // fraction of records kept by sampling
+
+        // Text, encoded arguments when format is set, or batch lines
+        std::string_view message() const {
+            if (!ownedMessage.empty()) {
+                return ownedMessage;
+            }
+            return std::string_view(payload.data(), messageLength);
+        }
+
+        std::string_view fields() const {
+            return std::string_view(payload.data() + messageLength, payload.size() - messageLength);
+        }
+    };
+
+    // A record whose message and fields are copied into this thread's arena
+    static LogRecord arenaRecord(std::chrono::system_clock::time_point timestamp, LogLevel level,
+                                 std::string_view message, std::string_view fields = std::string_view(),
+                                 float sampleRate = 1.0f) {
+        LogRecord record;
+        record.timestamp = timestamp;
+        record.level = level;
+        record.thread = logThreadId();
+        record.payload = LogArena::copy(message, fields);
+        record.messageLength = message.size();
+        record.sampleRate = sampleRate;
+        return record;
+    }
+
+    // One producer thread's queue in thread-buffered mode
+    struct ThreadBuffer {
+        explicit ThreadBuffer(std::size_t capacity)
+        : records(capacity) {
+        }
+
+        LogRingBuffer<LogRecord> records;
+        std::atomic<bool> abandoned{false}; // its thread has exited
+    };
+
+    LogRingBuffer<LogRecord>& producerQueue();
+    ThreadBuffer& localThreadBuffer();
+    bool writeQueued(LogSinkBatch& batch);
+    bool collectThreadBuffers(LogSinkBatch& batch);
+    void drainRing(LogRingBuffer<LogRecord>& ring, LogSinkBatch& batch);
+    void writePopped(LogSinkBatch& batch, const LogRecord& record);
+    std::size_t queuedRecords() const;
+
+    // Crash dumps (async-signal-safe: no locks, no allocation). The dump
+    // walks fixed slot arrays, not the vectors: a slot is set and cleared
+    // under sinkMutex / threadBufferMutex and read without either, so a
+    // crash while another thread resizes a vector cannot walk freed memory.
+    static constexpr std::size_t maxCrashSinks = 32;
+    static constexpr std::size_t maxCrashThreadBuffers = 256;
+    void writeCrashDump(const char* reason, LogTimestampCache& timestampCache);
+    void writeCrashRecord(const LogRecord& record, LogTimestampCache& timestampCache);
+    void writeCrashLine(const LogLineContext& line, LogLineBuffer& formattedLine, LogTimestampCache& timestampCache,
+                        std::size_t messageLength = LogSinkBatch::noMessageLength,
+                        std::string_view fields = std::string_view());
+
+    // Batches: lines are packed as {timestamp, level, length, text} in one payload
+    static void appendBatchLine(std::string& payload, std::chrono::system_clock::time_point timestamp,
+                                LogLevel level, const char* message, std::size_t length);
+    void commitBatch(std::string& payload, LogLevel highestLevel);
+    void addBatchLines(LogSinkBatch& batch, std::string_view payload, std::uint32_t thread);
+
+    // Configuration snapshots (publishConfig: the caller holds configMutex).
+    // The snapshot stays valid while the caller holds a LogReclaimer guard:
+    // every record takes one on entry, which also covers its layout.
+    const LogConfig& currentConfig() const {
+        return *config.load(std::memory_order_seq_cst);
+    }
+    template <typename Change>
+    void updateConfig(Change change) {
+        std::lock_guard<std::mutex> configLock(configMutex);
+        LogConfig next = *config.load(std::memory_order_relaxed);
+        change(next);
+        publishConfig(next);
+    }
+    void publishConfig(const LogConfig& newConfig);
+
+    // Level and sampling filters from one snapshot (the common "not
+    // sampled" case is a load from the snapshot)
+    bool keepRecord(const LogConfig& current, LogLevel level, float& sampleRate) {
+        if (!current.enables(level) || level == LogLevel::Off) {
+            return false;
+        }
+        std::size_t index = static_cast<std::size_t>(level);
+        sampleRate = current.sampleRates[index];
+        return sampleRate >= 1.0f || drawSample(level, sampleRate, current.sampleCounted[index]);
+    }
+    bool drawSample(LogLevel level, float sampleRate, bool counted);
+    static void appendSampleRate(LogLineBuffer& formattedLine, float sampleRate);
+
+    // Repeat collapsing and rate limit notices
+    bool isRepeat(std::uint64_t hash, LogLevel level);
+    void flushRepeats();
+    void writeNotice(LogLevel level, const char* prefix, std::uint64_t count, const char* suffix);
+
+    // The bodies of the logging methods, with the record's call site
+    void logText(std::uint32_t callSite, LogLevel level, std::string_view message);
+    template <std::size_t N, typename... Args>
+    void logFormatted(std::uint32_t callSite, LogLevel level, const char (&format)[N], const Args&... args) {
+        LogReclaimer::ReadGuard guard;
+        const LogConfig& current = currentConfig();
+        float sampleRate;
+        if (!keepRecord(current, level, sampleRate)) {
+            return;
+        }
+
+        bool collapsing = current.collapseRepeats;
+        bool queued = asyncEnabled.load(std::memory_order_acquire);
+        thread_local std::string encoded;
+        if (collapsing || queued) {
+            encoded.clear();
+            LogFormatter::encode(encoded, args...);
+        }
+
+        if (collapsing) {
+            std::uint64_t hash = logMessageHash(&format, sizeof(format));
+            if (isRepeat(logMessageHash(encoded.data(), encoded.size(), hash), level)) {
+                return;
+            }
+        }
+        metrics.countRecord(level);
+
+        if (queued) {
+            LogRecord record = arenaRecord(std::chrono::system_clock::now(), level, encoded,
+                                           std::string_view(), sampleRate);
+            record.format = format;
+            record.callSite = callSite;
+            if (enqueueRecord(std::move(record))) {
+                return;
+            }
+        }
+
+        LogLineContext line{std::chrono::system_clock::now(), level, logThreadId(), callSite};
+        std::uint64_t formatStarted = metrics.startTimer();
+        LogLineBuffer& formattedLine = beginLine(line);
+        LogFormatter::format(formattedLine, std::string_view(format, N - 1), args...);
+        appendSampleRate(formattedLine, sampleRate);
+        metrics.recordFormat(formatStarted);
+        writeLine(formattedLine, line);
+    }
+
+    template <typename... Fields>
+    void logStructured(std::uint32_t callSite, LogLevel level, std::string_view message,
+                       const LogField<Fields>&... fields) {
+        LogReclaimer::ReadGuard guard;
+        const LogConfig& current = currentConfig();
+        float sampleRate;
+        if (!keepRecord(current, level, sampleRate)) {
+            return;
+        }
+
+        thread_local std::string encodedFields;
+        encodedFields.clear();
+        LogStructuredFormat::encodeFields(encodedFields, fields...);
+
+        if (current.collapseRepeats) {
+            std::uint64_t hash = logMessageHash(message.data(), message.size());
+            if (isRepeat(logMessageHash(encodedFields.data(), encodedFields.size(), hash), level)) {
+                return;
+            }
+        }
+        submitStructured(level, message, encodedFields, sampleRate, callSite);
+    }
+
+    bool admits(LogLevel level, std::string_view message, float& sampleRate);
+    bool enqueueRecord(LogRecord&& record);
+    bool isListed(const LogRingBuffer<LogRecord>& ring) const;
+    void submitRecord(LogLevel level, std::string_view message, float sampleRate = 1.0f,
+                      std::uint32_t callSite = LogCallSites::none);
+    void submitStructured(LogLevel level, std::string_view message, const std::string& fields, float sampleRate,
+                          std::uint32_t callSite = LogCallSites::none);
+    void writeRecord(const LogLineContext& line, std::string_view message, float sampleRate = 1.0f);
+    void addRecord(LogSinkBatch& batch, const LogRecord& record);
+    LogLineBuffer& beginLine(const LogLineContext& line);
+    void writeLine(const LogLineBuffer& formattedLine, const LogLineContext& line);
+    void addLine(LogSinkBatch& batch, const LogLineBuffer& formattedLine, const LogLineContext& line,
+                 std::size_t messageLength = LogSinkBatch::noMessageLength,
+                 std::string_view fields = std::string_view());
+    void writeBatch(const LogSinkBatch& textBatch);
+    const LogSinkBatch& encodeBinaryBatch(const LogSinkBatch& textBatch);
+    void writeMetricsIfDue();
+    void countSinkWrite(LogSink& sink, const LogSinkBatch& batch);
+    void writerLoop();
+    void drainQueue();
+    void drainRemaining();
+    void flushSinksIfDue();
+
+    // Sink list helpers (the caller holds sinkMutex)
+    void attachSink(const std::shared_ptr<LogSink>& sink);
+    void detachSink(const std::shared_ptr<LogSink>& sink);
+    bool isAttached(const std::shared_ptr<LogSink>& sink) const;
+    void writeFileBanner(const std::string& banner);
+    void prepareFileSwitch(const std::string& filePath);
+    void finishFileSwitch(const std::string& filePath, const std::shared_ptr<LogSink>& sink, bool opened);
+    bool isFileOpen() const;
+    void closeFile();
+    void logToConsole(LogLevel level, const std::string& message);
+
+    std::string getCurrentTimestamp();
+    std::string formatTimestamp(std::chrono::system_clock::time_point timestamp);
+    // The caller holds a LogReclaimer guard
+    void formatPrefix(const LogLineContext& line, LogLineBuffer& formattedLine);
+    void installLayout(std::unique_ptr<LogLayout> newLayout);
+    void formatLogLine(std::chrono::system_clock::time_point timestamp,
+                       LogLevel level, const std::string& message,
+                       LogLineBuffer& formattedLine);
+
+    std::string loggerName;
+    std::mutex internalMutex;
+    std::mutex& consoleMutex;
+
+    // Replaced layouts and config snapshots, freed once no reader holds them
+    LogReclaimer reclaimer;
+
+    // Line layout (installedLayout owns the current one, guarded by sinkMutex)
+    std::atomic<const LogLayout*> layout{nullptr};
+    std::shared_ptr<const LogLayout> installedLayout;
+
+    // Configuration: the current snapshot (publishedConfig owns it unless it
+    // is the default; guarded by configMutex), its level for isEnabled(),
+    // plus the pattern and file path the last config file set
+    const LogConfig defaultConfig{};
+    std::atomic<const LogConfig*> config{&defaultConfig};
+    std::shared_ptr<const LogConfig> publishedConfig;
+    std::atomic<std::uint8_t> publishedMinLevel{static_cast<std::uint8_t>(defaultConfig.minLevel)};
+    std::optional<std::string> configuredPattern;
+    std::optional<std::string> configuredFile;
+    std::mutex configMutex;
+
+    // Self-metrics (also holds the drop, rate limit, sampling and repeat counters)
+    LogMetrics metrics;
+    std::atomic<std::uint64_t> metricsInterval{0}; // nanoseconds, 0: no periodic line
+    std::atomic<std::uint64_t> nextMetricsLine{0}; // LogMetrics::now() when the next one is due
+
+    // Rate limiting and repeat collapsing
+    std::atomic<std::uint64_t> lastRecordHash{0}; // 0: nothing to compare against
+    std::atomic<std::uint8_t> lastRecordLevel{0};
+    std::atomic<std::uint64_t> repeatCount{0};
+
+    // Sampling, per level (Off included so any level indexes safely)
+    static constexpr std::size_t levelCount = LogConfig::levelCount;
+
+    // Outputs (the list and the built-in file sinks are guarded by sinkMutex)
+    std::shared_ptr<LogConsoleSink> consoleSink;
+    std::shared_ptr<LogFileSink> fileSink;
+    std::shared_ptr<LogMmapSink> mmapSink;
+    std::vector<std::shared_ptr<LogSink>> sinks;
+    mutable std::mutex sinkMutex;
+    std::atomic<LogSink*> crashSinks[maxCrashSinks] = {};
+
+    // Call sites already defined to the binary sinks, and the binary file
+    // preamble with their definitions (so a rotated file starts with them)
+    std::vector<bool> definedCallSites;
+    std::string binaryPreamble;
+
+    // Asynchronous mode state
+    std::atomic<bool> asyncEnabled{false};
+    std::unique_ptr<LogRingBuffer<LogRecord>> asyncQueue;
+    LogOverflowPolicy overflowPolicy = LogOverflowPolicy::Block;
+    std::atomic<bool> stopWriter{false};
+    std::atomic<bool> writerBusy{false};
+    std::thread writerThread;
+    // Held by disableAsyncLogging() from the switch-off through its final
+    // drain, and by late producers draining after it: records left behind
+    // have one consumer at a time, never one racing the writer
+    std::mutex drainMutex;
+
+    // Thread-buffered mode state (settings change only while the writer is stopped)
+    bool threadBuffered = false;
+    LogMergeOrder mergeOrder = LogMergeOrder::Timestamp;
+    std::size_t threadBufferCapacity = 0;
+    std::uint64_t threadBufferOwner = 0; // tells this logger's buffers apart in threads' caches
+    mutable std::mutex threadBufferMutex;
+    std::vector<std::shared_ptr<ThreadBuffer>> threadBuffers; // guarded by threadBufferMutex
+    std::atomic<ThreadBuffer*> crashThreadBuffers[maxCrashThreadBuffers] = {};
+    std::uint64_t threadBufferGeneration = 0;                 // guarded; bumped on every change
+
+    // Owned by the writer thread
+    std::vector<std::shared_ptr<ThreadBuffer>> collectorBuffers;
+    std::uint64_t collectorGeneration = 0;
+    std::vector<LogRecord> mergeRecords;
 };
\ No newline at end of file
@@ -0,0 +1,217 @@
+#include "LogArena.hpp"
+#include <cstring>
+#include <mutex>
+#include <new>
+
+struct LogArenaOwner;
+
+// Slab header; the bytes follow it in the same allocation
+struct LogArenaSlab {
+    LogArenaOwner* owner;                   // null for a block of its own
+    LogArenaSlab* next = nullptr;           // free list link
+    std::atomic<std::size_t> references{0}; // live blocks, plus one while it is the thread's current slab
+    std::size_t used = 0;
+    std::size_t capacity = 0;
+
+    char* bytes() {
+        return reinterpret_cast<char*>(this + 1);
+    }
+};
+
+// What a thread's slabs go back to; outlives the thread until its last slab is freed
+struct LogArenaOwner {
+    std::mutex mutex;
+    LogArenaSlab* freeSlabs = nullptr; // recycled by releasing threads
+    std::size_t liveSlabs = 0;         // allocated and not yet freed
+    bool closed = false;               // the thread has exited
+};
+
+namespace {
+
+std::atomic<std::size_t> allocatedSlabs{0};
+
+// Set once this thread's arena is destroyed; later records get blocks of their own
+thread_local bool arenaExited = false;
+
+LogArenaSlab* newSlab(LogArenaOwner* owner, std::size_t capacity) {
+    void* memory = ::operator new(sizeof(LogArenaSlab) + capacity);
+    LogArenaSlab* slab = new (memory) LogArenaSlab{owner};
+    slab->capacity = capacity;
+    if (owner != nullptr) {
+        allocatedSlabs.fetch_add(1, std::memory_order_relaxed);
+    }
+    return slab;
+}
+
+void deleteSlab(LogArenaSlab* slab) {
+    if (slab->owner != nullptr) {
+        allocatedSlabs.fetch_sub(1, std::memory_order_relaxed);
+    }
+    slab->~LogArenaSlab();
+    ::operator delete(slab);
+}
+
+// A slab nobody references any more: back to its thread, or freed if the thread is gone
+void recycleSlab(LogArenaSlab* slab) {
+    LogArenaOwner* owner = slab->owner;
+    if (owner == nullptr) {
+        deleteSlab(slab);
+        return;
+    }
+
+    bool lastSlab;
+    {
+        std::lock_guard<std::mutex> ownerLock(owner->mutex);
+        if (!owner->closed) {
+            slab->next = owner->freeSlabs;
+            owner->freeSlabs = slab;
+            return;
+        }
+        lastSlab = --owner->liveSlabs == 0;
+    }
+    deleteSlab(slab);
+    if (lastSlab) {
+        delete owner;
+    }
+}
+
+void dropReference(LogArenaSlab* slab) {
+    if (slab->references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        recycleSlab(slab);
+    }
+}
+
+class ThreadArena {
+public:
+    ThreadArena()
+    : owner(new LogArenaOwner) {
+    }
+
+    ~ThreadArena() {
+        if (current != nullptr) {
+            dropReference(current);
+        }
+
+        LogArenaSlab* unused;
+        bool lastSlab;
+        {
+            std::lock_guard<std::mutex> ownerLock(owner->mutex);
+            owner->closed = true;
+            unused = owner->freeSlabs;
+            owner->freeSlabs = nullptr;
+            for (LogArenaSlab* slab = unused; slab != nullptr; slab = slab->next) {
+                --owner->liveSlabs;
+            }
+            for (LogArenaSlab* slab = spare; slab != nullptr; slab = slab->next) {
+                --owner->liveSlabs;
+            }
+            lastSlab = owner->liveSlabs == 0;
+        }
+
+        deleteList(unused);
+        deleteList(spare);
+        if (lastSlab) {
+            delete owner;
+        }
+        arenaExited = true;
+    }
+
+    ThreadArena(const ThreadArena&) = delete;
+    ThreadArena& operator=(const ThreadArena&) = delete;
+
+    // Room for size bytes in the current slab, moving to a fresh one if needed
+    LogArenaSlab* reserve(std::size_t size) {
+        if (current == nullptr || current->capacity - current->used < size) {
+            if (current != nullptr) {
+                dropReference(current);
+            }
+            current = takeSlab();
+        }
+        return current;
+    }
+
+private:
+    // Reuse a recycled slab (collecting the whole free list in one go) or allocate one
+    LogArenaSlab* takeSlab() {
+        if (spare == nullptr) {
+            std::lock_guard<std::mutex> ownerLock(owner->mutex);
+            spare = owner->freeSlabs;
+            owner->freeSlabs = nullptr;
+            if (spare == nullptr) {
+                ++owner->liveSlabs;
+            }
+        }
+
+        LogArenaSlab* slab;
+        if (spare != nullptr) {
+            slab = spare;
+            spare = slab->next;
+        } else {
+            slab = newSlab(owner, LogArena::slabSize);
+        }
+        slab->next = nullptr;
+        slab->used = 0;
+        slab->references.store(1, std::memory_order_relaxed);
+        return slab;
+    }
+
+    static void deleteList(LogArenaSlab* slab) {
+        while (slab != nullptr) {
+            LogArenaSlab* next = slab->next;
+            deleteSlab(slab);
+            slab = next;
+        }
+    }
+
+    LogArenaOwner* owner;
+    LogArenaSlab* current = nullptr;
+    LogArenaSlab* spare = nullptr; // taken from the free list, not yet used
+};
+
+ThreadArena& threadArena() {
+    thread_local ThreadArena arena;
+    return arena;
+}
+
+}
+
+LogArenaBlock LogArena::copy(std::string_view first, std::string_view second) {
+    LogArenaBlock block;
+    std::size_t size = first.size() + second.size();
+    if (size == 0) {
+        return block;
+    }
+
+    LogArenaSlab* slab;
+    if (size > largestSlabBlock || arenaExited) {
+        slab = newSlab(nullptr, size);
+    } else {
+        slab = threadArena().reserve(size);
+    }
+
+    block.slab = slab;
+    block.bytes = slab->bytes() + slab->used;
+    block.length = size;
+    slab->used += size;
+    slab->references.fetch_add(1, std::memory_order_relaxed);
+
+    if (!first.empty()) {
+        std::memcpy(block.bytes, first.data(), first.size());
+    }
+    if (!second.empty()) {
+        std::memcpy(block.bytes + first.size(), second.data(), second.size());
+    }
+    return block;
+}
+
+std::size_t LogArena::getAllocatedSlabs() {
+    return allocatedSlabs.load(std::memory_order_relaxed);
+}
+
+void LogArenaBlock::releaseSlab() {
+    LogArenaSlab* released = slab;
+    slab = nullptr;
+    bytes = nullptr;
+    length = 0;
+    dropReference(released);
+}
@@ -0,0 +1,429 @@
+#include "LogAsyncFileWriter.hpp"
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+#ifdef _WIN32
+    // windows.h comes in through the header
+#else
+    #include <cerrno>
+    #include <fcntl.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+#if defined(__linux__)
+    #include <linux/io_uring.h>
+    #include <sys/mman.h>
+    #include <sys/syscall.h>
+#endif
+
+#if defined(__linux__)
+namespace {
+
+int ringSetup(unsigned entries, io_uring_params* params) {
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+int ringEnter(int ringDescriptor, unsigned toSubmit, unsigned minComplete, unsigned flags) {
+    return static_cast<int>(syscall(__NR_io_uring_enter, ringDescriptor, toSubmit, minComplete, flags,
+                                    nullptr, 0));
+}
+
+}
+#endif
+
+LogAsyncFileWriter::~LogAsyncFileWriter() {
+    close();
+}
+
+// Open for writing at the current end of the file and set up the queue
+bool LogAsyncFileWriter::open(const std::string& filePath, std::size_t buffersInFlight) {
+    close();
+    if (buffersInFlight == 0) {
+        buffersInFlight = 1;
+    }
+
+#ifdef _WIN32
+    fileHandle = CreateFileA(filePath.c_str(), GENERIC_WRITE,
+                             FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+                             OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_OVERLAPPED, nullptr);
+    if (fileHandle == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(fileHandle, &size)) {
+        CloseHandle(fileHandle);
+        fileHandle = INVALID_HANDLE_VALUE;
+        return false;
+    }
+    fileOffset = static_cast<std::uint64_t>(size.QuadPart);
+
+    buffers.resize(buffersInFlight);
+    for (Buffer& buffer : buffers) {
+        buffer.overlapped.hEvent = CreateEventA(nullptr, TRUE, FALSE, nullptr);
+    }
+#elif defined(__linux__)
+    descriptor = ::open(filePath.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+    if (descriptor < 0) {
+        return false;
+    }
+
+    struct stat status;
+    io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    if (fstat(descriptor, &status) != 0 ||
+        (ringDescriptor = ringSetup(static_cast<unsigned>(buffersInFlight), &params)) < 0) {
+        ::close(descriptor);
+        descriptor = -1;
+        return false;
+    }
+    fileOffset = static_cast<std::uint64_t>(status.st_size);
+
+    // Map the submission ring, the completion ring (often the same mapping)
+    // and the submission entries
+    submissionRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    completionRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool singleMapping = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (singleMapping && completionRingSize > submissionRingSize) {
+        submissionRingSize = completionRingSize;
+    }
+
+    submissionRing = mmap(nullptr, submissionRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                          ringDescriptor, IORING_OFF_SQ_RING);
+    completionRing = singleMapping ? submissionRing
+                                   : mmap(nullptr, completionRingSize, PROT_READ | PROT_WRITE,
+                                          MAP_SHARED | MAP_POPULATE, ringDescriptor, IORING_OFF_CQ_RING);
+    submissionEntriesSize = params.sq_entries * sizeof(io_uring_sqe);
+    submissionEntries = mmap(nullptr, submissionEntriesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                             ringDescriptor, IORING_OFF_SQES);
+
+    if (submissionRing == MAP_FAILED || completionRing == MAP_FAILED || submissionEntries == MAP_FAILED) {
+        submissionRing = submissionRing == MAP_FAILED ? nullptr : submissionRing;
+        completionRing = completionRing == MAP_FAILED ? nullptr : completionRing;
+        submissionEntries = submissionEntries == MAP_FAILED ? nullptr : submissionEntries;
+        opened = true; // let close() unmap what was mapped
+        close();
+        return false;
+    }
+
+    char* submissionBase = static_cast<char*>(submissionRing);
+    submissionHead = reinterpret_cast<unsigned*>(submissionBase + params.sq_off.head);
+    submissionTail = reinterpret_cast<unsigned*>(submissionBase + params.sq_off.tail);
+    submissionMask = reinterpret_cast<unsigned*>(submissionBase + params.sq_off.ring_mask);
+    submissionArray = reinterpret_cast<unsigned*>(submissionBase + params.sq_off.array);
+
+    char* completionBase = static_cast<char*>(completionRing);
+    completionHead = reinterpret_cast<unsigned*>(completionBase + params.cq_off.head);
+    completionTail = reinterpret_cast<unsigned*>(completionBase + params.cq_off.tail);
+    completionMask = reinterpret_cast<unsigned*>(completionBase + params.cq_off.ring_mask);
+    completionEntries = completionBase + params.cq_off.cqes;
+
+    buffers.resize(buffersInFlight);
+#else
+    (void)filePath;
+    return false;
+#endif
+
+    nextBuffer = 0;
+    failedWrites = 0;
+    rewindOffset = noRewind;
+    opened = true;
+    return true;
+}
+
+bool LogAsyncFileWriter::isOpen() const {
+    return opened;
+}
+
+// Copy into the next buffer (waiting for its previous write if need be) and submit
+void LogAsyncFileWriter::write(const char* data, std::size_t length) {
+    if (!opened || length == 0) {
+        return;
+    }
+
+    std::size_t index = nextBuffer;
+    while (buffers[index].inFlight) {
+        reap(true);
+    }
+
+    Buffer& buffer = buffers[index];
+    if (buffer.data.size() < length) {
+        buffer.data.resize(length);
+    }
+    std::memcpy(buffer.data.data(), data, length);
+    buffer.length = length;
+    buffer.written = 0;
+    buffer.offset = fileOffset;
+    buffer.failed = false;
+    fileOffset += length;
+
+    if (!submit(index)) {
+        fail(index);
+    }
+    nextBuffer = (nextBuffer + 1) % buffers.size();
+
+    // Recycle whatever has finished meanwhile
+    reap(false);
+    rewind();
+}
+
+// Wait until every submitted write has completed
+void LogAsyncFileWriter::flush() {
+    while (opened && inFlightCount() > 0) {
+        reap(true);
+    }
+    rewind();
+}
+
+void LogAsyncFileWriter::crashFlush() {
+    flush();
+}
+
+void LogAsyncFileWriter::close() {
+    if (!opened) {
+        return;
+    }
+    flush();
+
+#ifdef _WIN32
+    for (Buffer& buffer : buffers) {
+        if (buffer.overlapped.hEvent != nullptr) {
+            CloseHandle(buffer.overlapped.hEvent);
+        }
+    }
+    CloseHandle(fileHandle);
+    fileHandle = INVALID_HANDLE_VALUE;
+#elif defined(__linux__)
+    if (submissionEntries != nullptr) {
+        munmap(submissionEntries, submissionEntriesSize);
+    }
+    if (completionRing != nullptr && completionRing != submissionRing) {
+        munmap(completionRing, completionRingSize);
+    }
+    if (submissionRing != nullptr) {
+        munmap(submissionRing, submissionRingSize);
+    }
+    submissionEntries = nullptr;
+    completionRing = nullptr;
+    submissionRing = nullptr;
+
+    if (ringDescriptor >= 0) {
+        ::close(ringDescriptor);
+        ringDescriptor = -1;
+    }
+    ::close(descriptor);
+    descriptor = -1;
+#endif
+
+    buffers.clear();
+    opened = false;
+}
+
+std::uint64_t LogAsyncFileWriter::getFailedWrites() const {
+    return failedWrites;
+}
+
+// Queue the unwritten part of a buffer at its offset
+bool LogAsyncFileWriter::submit(std::size_t index) {
+    Buffer& buffer = buffers[index];
+    char* data = buffer.data.data() + buffer.written;
+    std::size_t length = buffer.length - buffer.written;
+    std::uint64_t offset = buffer.offset + buffer.written;
+
+#ifdef _WIN32
+    ResetEvent(buffer.overlapped.hEvent);
+    buffer.overlapped.Offset = static_cast<DWORD>(offset & 0xFFFFFFFFu);
+    buffer.overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+    if (!WriteFile(fileHandle, data, static_cast<DWORD>(length), nullptr, &buffer.overlapped) &&
+        GetLastError() != ERROR_IO_PENDING) {
+        return false;
+    }
+    buffer.inFlight = true;
+    return true;
+#elif defined(__linux__)
+    buffer.vector.iov_base = data;
+    buffer.vector.iov_len = length;
+
+    // Single producer: only this thread moves the submission tail
+    unsigned tail = *submissionTail;
+    unsigned slot = tail & *submissionMask;
+    io_uring_sqe* entry = static_cast<io_uring_sqe*>(submissionEntries) + slot;
+    std::memset(entry, 0, sizeof(*entry));
+    entry->opcode = IORING_OP_WRITEV;
+    entry->fd = descriptor;
+    entry->addr = reinterpret_cast<std::uint64_t>(&buffer.vector);
+    entry->len = 1;
+    entry->off = offset;
+    entry->user_data = index;
+    submissionArray[slot] = slot;
+    __atomic_store_n(submissionTail, tail + 1, __ATOMIC_RELEASE);
+    buffer.inFlight = true;
+
+    for (int busyRetries = 0; busyRetries < 100;) {
+        if (ringEnter(ringDescriptor, 1, 0, 0) >= 0) {
+            return true;
+        }
+        if (errno == EINTR) {
+            continue;
+        }
+        if (errno != EAGAIN && errno != EBUSY) {
+            break;
+        }
+        // Out of kernel resources for now: make room by waiting for the
+        // other writes, or back off if this one is the only write
+        if (inFlightCount() > 1) {
+            reap(true);
+        } else {
+            ++busyRetries;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    // Without SQPOLL the kernel only takes entries inside io_uring_enter, so
+    // a failed call leaves this one unconsumed: withdraw it
+    __atomic_store_n(submissionTail, tail, __ATOMIC_RELEASE);
+    buffer.inFlight = false;
+    return false;
+#else
+    (void)index;
+    (void)data;
+    (void)length;
+    (void)offset;
+    return false;
+#endif
+}
+
+// Collect completions
+void LogAsyncFileWriter::reap(bool wait) {
+#ifdef _WIN32
+    if (wait) {
+        HANDLE events[MAXIMUM_WAIT_OBJECTS];
+        DWORD count = 0;
+        for (Buffer& buffer : buffers) {
+            if (buffer.inFlight && count < MAXIMUM_WAIT_OBJECTS) {
+                events[count++] = buffer.overlapped.hEvent;
+            }
+        }
+        if (count > 0) {
+            WaitForMultipleObjects(count, events, FALSE, INFINITE);
+        }
+    }
+
+    for (std::size_t index = 0; index < buffers.size(); ++index) {
+        Buffer& buffer = buffers[index];
+        if (!buffer.inFlight) {
+            continue;
+        }
+        DWORD transferred = 0;
+        if (GetOverlappedResult(fileHandle, &buffer.overlapped, &transferred, FALSE)) {
+            complete(index, static_cast<long long>(transferred));
+        } else if (GetLastError() != ERROR_IO_INCOMPLETE) {
+            complete(index, -1);
+        }
+    }
+#elif defined(__linux__)
+    if (wait) {
+        while (ringEnter(ringDescriptor, 0, 1, IORING_ENTER_GETEVENTS) < 0 && errno == EINTR) {
+        }
+    }
+
+    // complete() may resubmit, and a resubmission may reap in turn: the head
+    // is read afresh for every entry so a nested reap's progress is kept
+    while (true) {
+        unsigned head = *completionHead;
+        if (head == __atomic_load_n(completionTail, __ATOMIC_ACQUIRE)) {
+            break;
+        }
+        const io_uring_cqe* completion = static_cast<const io_uring_cqe*>(completionEntries) +
+                                         (head & *completionMask);
+        std::size_t index = static_cast<std::size_t>(completion->user_data);
+        long long result = completion->res;
+        __atomic_store_n(completionHead, head + 1, __ATOMIC_RELEASE);
+        complete(index, result);
+    }
+#else
+    (void)wait;
+#endif
+}
+
+// One write finished: recycle the buffer, or resubmit the rest of a short write
+void LogAsyncFileWriter::complete(std::size_t index, long long result) {
+    if (index >= buffers.size()) {
+        return;
+    }
+
+    Buffer& buffer = buffers[index];
+    buffer.inFlight = false;
+
+#if defined(__linux__)
+    if (result == -EINTR || result == -EAGAIN) {
+        if (!submit(index)) {
+            fail(index);
+        }
+        return;
+    }
+#endif
+
+    if (result <= 0) {
+        fail(index);
+        return;
+    }
+
+    buffer.written += static_cast<std::size_t>(result);
+    if (buffer.written < buffer.length && !submit(index)) {
+        fail(index);
+    }
+}
+
+void LogAsyncFileWriter::fail(std::size_t index) {
+    Buffer& buffer = buffers[index];
+    buffer.failed = true;
+    ++failedWrites;
+    std::uint64_t stoppedAt = buffer.offset + buffer.written;
+    if (stoppedAt < rewindOffset) {
+        rewindOffset = stoppedAt;
+    }
+}
+
+void LogAsyncFileWriter::rewind() {
+    if (rewindOffset == noRewind) {
+        return;
+    }
+    while (inFlightCount() > 0) {
+        reap(true);
+    }
+
+    // Writes placed after the failed one are cut off with it
+    for (Buffer& buffer : buffers) {
+        if (!buffer.failed && buffer.length > 0 && buffer.offset >= rewindOffset) {
+            ++failedWrites;
+        }
+        buffer.length = 0;
+        buffer.written = 0;
+        buffer.failed = false;
+    }
+
+#ifdef _WIN32
+    LARGE_INTEGER position;
+    position.QuadPart = static_cast<LONGLONG>(rewindOffset);
+    if (SetFilePointerEx(fileHandle, position, nullptr, FILE_BEGIN)) {
+        SetEndOfFile(fileHandle);
+    }
+#elif defined(__linux__)
+    while (ftruncate(descriptor, static_cast<off_t>(rewindOffset)) != 0 && errno == EINTR) {
+    }
+#endif
+
+    fileOffset = rewindOffset;
+    rewindOffset = noRewind;
+}
+
+std::size_t LogAsyncFileWriter::inFlightCount() const {
+    std::size_t count = 0;
+    for (const Buffer& buffer : buffers) {
+        count += buffer.inFlight ? 1 : 0;
+    }
+    return count;
+}
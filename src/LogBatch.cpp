@@ -0,0 +1,32 @@
+#include "LogBatch.hpp"
+
+LogBatch::LogBatch(LoggerHandler& logger)
+: logger(logger) {
+}
+
+// Destructor (commits whatever is still pending)
+LogBatch::~LogBatch() {
+    commit();
+}
+
+void LogBatch::log(LogLevel level, std::string_view message) {
+    if (logger.isEnabled(level) && level != LogLevel::Off) {
+        add(level, message.data(), message.size());
+    }
+}
+
+void LogBatch::add(LogLevel level, const char* message, std::size_t length) {
+    LoggerHandler::appendBatchLine(payload, std::chrono::system_clock::now(), level, message, length);
+    highestLevel = level > highestLevel ? level : highestLevel;
+    ++lineCount;
+}
+
+void LogBatch::commit() {
+    logger.commitBatch(payload, highestLevel);
+    lineCount = 0;
+    highestLevel = LogLevel::Message;
+}
+
+std::size_t LogBatch::size() const {
+    return lineCount;
+}
@@ -0,0 +1,242 @@
+#include "LogBinaryFormat.hpp"
+#include <cstring>
+
+static const char fileMagic[4] = { 'L', 'O', 'G', 'B' };
+
+// Longest message or name the reader accepts (guards against corrupt lengths)
+static constexpr std::uint64_t maxFieldLength = 64ull * 1024 * 1024;
+
+// Writing
+void LogBinaryFormat::appendFileHeader(std::string& out) {
+    out.append(fileMagic, sizeof(fileMagic));
+    out.push_back(static_cast<char>(version));
+}
+
+void LogBinaryFormat::appendLoggerName(std::string& out, std::uint32_t loggerId, std::string_view loggerName) {
+    LogLineBuffer encoded;
+    encoded.clear();
+    encoded.append(static_cast<char>(LoggerNameTag));
+    appendVarint(encoded, loggerId);
+    appendVarint(encoded, loggerName.size());
+    encoded.append(loggerName.data(), loggerName.size());
+    out.append(encoded.data(), encoded.size());
+}
+
+// Tag, timestamp and level: the start of both record kinds
+static void appendRecordHeader(LogLineBuffer& out, LogBinaryFormat::Tag tag, std::int64_t timestampNanoseconds,
+                               LogLevel level) {
+    char header[1 + 8 + 1];
+    header[0] = static_cast<char>(tag);
+    std::uint64_t timestamp = static_cast<std::uint64_t>(timestampNanoseconds);
+    for (int i = 0; i < 8; ++i) {
+        header[1 + i] = static_cast<char>((timestamp >> (8 * i)) & 0xFF);
+    }
+    header[9] = static_cast<char>(level);
+    out.append(header, sizeof(header));
+}
+
+static void appendString(LogLineBuffer& out, const char* text) {
+    std::size_t length = text != nullptr ? std::strlen(text) : 0;
+    LogBinaryFormat::appendVarint(out, length);
+    out.append(text, length);
+}
+
+void LogBinaryFormat::appendRecord(LogLineBuffer& out, std::int64_t timestampNanoseconds, LogLevel level,
+                                   std::uint32_t loggerId, const char* message, std::size_t messageLength) {
+    appendRecordHeader(out, RecordTag, timestampNanoseconds, level);
+    appendVarint(out, loggerId);
+    appendVarint(out, messageLength);
+    out.append(message, messageLength);
+}
+
+void LogBinaryFormat::appendCallSite(LogLineBuffer& out, std::uint32_t callSiteId, const LogCallSite& site) {
+    out.append(static_cast<char>(CallSiteTag));
+    appendVarint(out, callSiteId);
+    appendVarint(out, site.line);
+    out.append(static_cast<char>(site.level));
+    appendString(out, site.file);
+    appendString(out, site.function);
+    appendString(out, site.format);
+}
+
+void LogBinaryFormat::appendSiteRecord(LogLineBuffer& out, std::int64_t timestampNanoseconds, LogLevel level,
+                                       std::uint32_t loggerId, std::uint32_t thread, std::uint32_t callSiteId,
+                                       const char* message, std::size_t messageLength) {
+    appendRecordHeader(out, SiteRecordTag, timestampNanoseconds, level);
+    appendVarint(out, loggerId);
+    appendVarint(out, thread);
+    appendVarint(out, callSiteId);
+    appendVarint(out, messageLength);
+    out.append(message, messageLength);
+}
+
+void LogBinaryFormat::appendVarint(LogLineBuffer& out, std::uint64_t value) {
+    char bytes[10];
+    std::size_t count = 0;
+    do {
+        char byte = static_cast<char>(value & 0x7F);
+        value >>= 7;
+        if (value != 0) {
+            byte = static_cast<char>(byte | 0x80);
+        }
+        bytes[count++] = byte;
+    } while (value != 0);
+    out.append(bytes, count);
+}
+
+// Reading
+LogBinaryReader::LogBinaryReader(std::istream& input)
+: input(input) {
+}
+
+bool LogBinaryReader::next(LogBinaryRecord& record) {
+    while (!corrupt) {
+        int tag = input.get();
+        if (tag == std::char_traits<char>::eof()) {
+            return false;
+        }
+
+        switch (static_cast<std::uint8_t>(tag)) {
+        case LogBinaryFormat::FileHeaderTag: {
+            char rest[4];
+            if (!readBytes(rest, sizeof(rest)) || rest[0] != 'O' || rest[1] != 'G' || rest[2] != 'B' ||
+                static_cast<std::uint8_t>(rest[3]) > LogBinaryFormat::version) {
+                corrupt = true;
+            }
+            break;
+        }
+
+        case LogBinaryFormat::LoggerNameTag: {
+            std::uint64_t loggerId;
+            std::uint64_t length;
+            if (!readVarint(loggerId) || !readVarint(length) ||
+                loggerId > maxFieldLength || length > maxFieldLength) {
+                corrupt = true;
+                break;
+            }
+            if (loggerId >= loggerNames.size()) {
+                loggerNames.resize(static_cast<std::size_t>(loggerId) + 1);
+            }
+            std::string& name = loggerNames[static_cast<std::size_t>(loggerId)];
+            name.resize(static_cast<std::size_t>(length));
+            if (!readBytes(&name[0], name.size())) {
+                corrupt = true;
+            }
+            break;
+        }
+
+        case LogBinaryFormat::CallSiteTag: {
+            std::uint64_t callSiteId;
+            std::uint64_t line;
+            LogBinaryCallSite site;
+            if (!readVarint(callSiteId) || !readVarint(line) || callSiteId == 0 ||
+                callSiteId > LogCallSites::capacity || line > UINT32_MAX) {
+                corrupt = true;
+                break;
+            }
+            int level = input.get();
+            if (level == std::char_traits<char>::eof() || !readString(site.file) ||
+                !readString(site.function) || !readString(site.format)) {
+                corrupt = true;
+                break;
+            }
+            site.line = static_cast<std::uint32_t>(line);
+            site.level = static_cast<LogLevel>(level <= static_cast<int>(LogLevel::Off) ? level : 0);
+            if (callSiteId >= callSites.size()) {
+                callSites.resize(static_cast<std::size_t>(callSiteId) + 1);
+            }
+            callSites[static_cast<std::size_t>(callSiteId)] = std::move(site);
+            break;
+        }
+
+        case LogBinaryFormat::RecordTag:
+        case LogBinaryFormat::SiteRecordTag:
+            if (readRecord(record, tag == LogBinaryFormat::SiteRecordTag)) {
+                return true;
+            }
+            corrupt = true;
+            break;
+
+        default:
+            corrupt = true;
+            break;
+        }
+    }
+    return false;
+}
+
+// The rest of a record after its tag
+bool LogBinaryReader::readRecord(LogBinaryRecord& record, bool withSite) {
+    char header[9];
+    std::uint64_t loggerId;
+    std::uint64_t thread = 0;
+    std::uint64_t callSiteId = 0;
+    std::uint64_t length;
+    if (!readBytes(header, sizeof(header)) || !readVarint(loggerId) ||
+        (withSite && (!readVarint(thread) || !readVarint(callSiteId))) || !readVarint(length) ||
+        length > maxFieldLength) {
+        return false;
+    }
+
+    std::uint64_t timestamp = 0;
+    for (int i = 0; i < 8; ++i) {
+        timestamp |= static_cast<std::uint64_t>(static_cast<unsigned char>(header[i])) << (8 * i);
+    }
+    std::uint8_t level = static_cast<std::uint8_t>(header[8]);
+
+    record.timestampNanoseconds = static_cast<std::int64_t>(timestamp);
+    record.level = static_cast<LogLevel>(level <= static_cast<std::uint8_t>(LogLevel::Off) ? level : 0);
+    record.loggerId = static_cast<std::uint32_t>(loggerId);
+    record.thread = static_cast<std::uint32_t>(thread);
+    record.callSite = static_cast<std::uint32_t>(callSiteId);
+    record.message.resize(static_cast<std::size_t>(length));
+    return readBytes(&record.message[0], record.message.size());
+}
+
+bool LogBinaryReader::failed() const {
+    return corrupt;
+}
+
+const std::string& LogBinaryReader::loggerName(std::uint32_t loggerId) const {
+    static const std::string unknown;
+    return loggerId < loggerNames.size() ? loggerNames[loggerId] : unknown;
+}
+
+const LogBinaryCallSite* LogBinaryReader::callSite(std::uint32_t callSiteId) const {
+    if (callSiteId == LogCallSites::none || callSiteId >= callSites.size()) {
+        return nullptr;
+    }
+    return &callSites[callSiteId];
+}
+
+bool LogBinaryReader::readVarint(std::uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        int byte = input.get();
+        if (byte == std::char_traits<char>::eof()) {
+            return false;
+        }
+        value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool LogBinaryReader::readBytes(char* data, std::size_t length) {
+    if (length == 0) {
+        return true;
+    }
+    input.read(data, static_cast<std::streamsize>(length));
+    return static_cast<std::size_t>(input.gcount()) == length;
+}
+
+bool LogBinaryReader::readString(std::string& text) {
+    std::uint64_t length;
+    if (!readVarint(length) || length > maxFieldLength) {
+        return false;
+    }
+    text.resize(static_cast<std::size_t>(length));
+    return readBytes(&text[0], text.size());
+}
@@ -0,0 +1,74 @@
+#include "LogCallSite.hpp"
+#include <atomic>
+#include <mutex>
+
+namespace {
+
+constexpr std::size_t chunkSize = 1024;
+constexpr std::size_t chunkCount = LogCallSites::capacity / chunkSize;
+
+// Chunks are allocated as the table grows and never freed
+struct CallSiteTable {
+    std::mutex mutex;
+    std::atomic<LogCallSite*> chunks[chunkCount] = {};
+    std::atomic<std::uint32_t> registered{0};
+};
+
+CallSiteTable& table() {
+    // Leaked: call sites are looked up until the very end of the process
+    static CallSiteTable* sites = new CallSiteTable;
+    return *sites;
+}
+
+// Add an entry (the caller holds the table lock)
+std::uint32_t addSite(CallSiteTable& sites, const LogCallSite& site) {
+    std::uint32_t index = sites.registered.load(std::memory_order_relaxed);
+    if (index >= LogCallSites::capacity) {
+        return LogCallSites::unregistered;
+    }
+
+    LogCallSite* chunk = sites.chunks[index / chunkSize].load(std::memory_order_relaxed);
+    if (chunk == nullptr) {
+        chunk = new LogCallSite[chunkSize]();
+        sites.chunks[index / chunkSize].store(chunk, std::memory_order_release);
+    }
+    chunk[index % chunkSize] = site;
+
+    // Publish the entry before its id can be seen
+    sites.registered.store(index + 1, std::memory_order_release);
+    return index + 1;
+}
+
+}
+
+std::uint32_t LogCallSites::intern(const char* file, std::uint32_t line, const char* function,
+                                   LogLevel level, const char* format) {
+    CallSiteTable& sites = table();
+    std::lock_guard<std::mutex> tableLock(sites.mutex);
+    return addSite(sites, LogCallSite{file, line, function, level, format});
+}
+
+std::uint32_t LogCallSites::intern(LogCallSiteHandle& handle, const char* format) {
+    CallSiteTable& sites = table();
+    std::lock_guard<std::mutex> tableLock(sites.mutex);
+
+    std::uint32_t id = handle.siteId.load(std::memory_order_relaxed);
+    if (id == none) {
+        id = addSite(sites, LogCallSite{handle.file, handle.line, handle.function, handle.level, format});
+        handle.siteId.store(id, std::memory_order_release);
+    }
+    return id;
+}
+
+const LogCallSite* LogCallSites::find(std::uint32_t id) {
+    CallSiteTable& sites = table();
+    if (id == none || id > sites.registered.load(std::memory_order_acquire)) {
+        return nullptr;
+    }
+    std::uint32_t index = id - 1;
+    return &sites.chunks[index / chunkSize].load(std::memory_order_acquire)[index % chunkSize];
+}
+
+std::uint32_t LogCallSites::count() {
+    return table().registered.load(std::memory_order_acquire);
+}
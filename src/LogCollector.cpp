@@ -0,0 +1,148 @@
+#include "LogCollector.hpp"
+#include <algorithm>
+
+LogCollector::LogCollector(const LogCollectorOptions& options)
+: options(options),
+roundBatch(options.format),
+orderedBatch(options.format) {
+    channel.create(options.channelName, options.format, options.ringCount, options.ringBytes);
+}
+
+LogCollector::~LogCollector() {
+    stop();
+    if (channel.isOpen()) {
+        collect();
+        flush();
+    }
+    channel.close();
+}
+
+bool LogCollector::isOpen() const {
+    return channel.isOpen();
+}
+
+const LogCollectorOptions& LogCollector::getOptions() const {
+    return options;
+}
+
+bool LogCollector::addSink(std::shared_ptr<LogSink> sink) {
+    if (!sink || sink->getFormat() != options.format) {
+        return false;
+    }
+    sinks.push_back(std::move(sink));
+    return true;
+}
+
+// Background collection
+void LogCollector::start() {
+    if (collectorThread.joinable() || !channel.isOpen()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> stateLock(stateMutex);
+        stopping = false;
+    }
+    collectorThread = std::thread(&LogCollector::collectorLoop, this);
+}
+
+void LogCollector::stop() {
+    if (!collectorThread.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> stateLock(stateMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    collectorThread.join();
+}
+
+void LogCollector::collectorLoop() {
+    std::unique_lock<std::mutex> stateLock(stateMutex);
+    while (!stopping) {
+        stateLock.unlock();
+        std::size_t records = collect();
+        if (records == 0) {
+            for (const auto& sink : sinks) {
+                sink->flushIfDue();
+            }
+        }
+        stateLock.lock();
+
+        if (records == 0) {
+            wake.wait_for(stateLock, options.idleWait, [this]() { return stopping; });
+        }
+    }
+    stateLock.unlock();
+
+    // What producers wrote before the stop
+    collect();
+    flush();
+}
+
+// One round – every ring's records, in timestamp order
+std::size_t LogCollector::collect() {
+    if (!channel.isOpen()) {
+        return 0;
+    }
+
+    roundBatch.clear();
+    for (std::size_t ring = 0; ring < channel.getRingCount(); ++ring) {
+        channel.drain(ring, roundBatch);
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    if (now >= nextReclaim) {
+        nextReclaim = now + options.reclaimInterval;
+        producerCount.store(channel.reclaimRings(), std::memory_order_relaxed);
+    }
+    droppedRecords.store(channel.getDroppedRecords(), std::memory_order_relaxed);
+    if (roundBatch.empty()) {
+        return 0;
+    }
+
+    const std::vector<LogSinkEntry>& entries = roundBatch.entries();
+    auto earlier = [&entries](std::size_t a, std::size_t b) {
+        return entries[a].timestamp < entries[b].timestamp;
+    };
+    order.resize(entries.size());
+    for (std::size_t index = 0; index < order.size(); ++index) {
+        order[index] = index;
+    }
+
+    const LogSinkBatch* batch = &roundBatch;
+    if (!std::is_sorted(order.begin(), order.end(), earlier)) {
+        std::stable_sort(order.begin(), order.end(), earlier);
+        orderedBatch.clear();
+        for (std::size_t index : order) {
+            const LogSinkEntry& entry = entries[index];
+            orderedBatch.appendLine(entry.timestamp, entry.level, roundBatch.data() + entry.offset,
+                                    entry.length - 1, entry.messageOffset, entry.messageLength);
+        }
+        batch = &orderedBatch;
+    }
+
+    for (const auto& sink : sinks) {
+        sink->write(*batch);
+    }
+    collectedRecords.fetch_add(entries.size(), std::memory_order_relaxed);
+    return entries.size();
+}
+
+void LogCollector::flush() {
+    for (const auto& sink : sinks) {
+        sink->flush();
+    }
+}
+
+std::uint64_t LogCollector::getCollectedRecords() const {
+    return collectedRecords.load(std::memory_order_relaxed);
+}
+
+std::uint64_t LogCollector::getDroppedRecords() const {
+    return droppedRecords.load(std::memory_order_relaxed);
+}
+
+std::size_t LogCollector::getProducerCount() const {
+    return producerCount.load(std::memory_order_relaxed);
+}
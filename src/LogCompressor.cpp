@@ -0,0 +1,121 @@
+#include "LogCompressor.hpp"
+#include <fstream>
+
+#ifdef LOGGER_WITH_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef LOGGER_WITH_ZSTD
+#include <zstd.h>
+#endif
+
+bool LogCompressor::isAvailable(LogCompression compression) {
+    switch (compression) {
+    case LogCompression::None:
+        return true;
+    case LogCompression::Gzip:
+        #ifdef LOGGER_WITH_ZLIB
+        return true;
+        #else
+        return false;
+        #endif
+    case LogCompression::Zstd:
+        #ifdef LOGGER_WITH_ZSTD
+        return true;
+        #else
+        return false;
+        #endif
+    }
+    return false;
+}
+
+const char* LogCompressor::extension(LogCompression compression) {
+    switch (compression) {
+    case LogCompression::Gzip:
+        return ".gz";
+    case LogCompression::Zstd:
+        return ".zst";
+    default:
+        return "";
+    }
+}
+
+// Compress one block as a complete gzip member / zstd frame
+bool LogCompressor::compressBlock(LogCompression compression, int level,
+                                  const char* data, std::size_t size, std::vector<char>& out) {
+    switch (compression) {
+    case LogCompression::None:
+        out.assign(data, data + size);
+        return true;
+
+    case LogCompression::Gzip: {
+        #ifdef LOGGER_WITH_ZLIB
+        z_stream stream = {};
+        // 15 window bits + 16 selects the gzip wrapper
+        if (deflateInit2(&stream, level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+            return false;
+        }
+
+        out.resize(deflateBound(&stream, static_cast<uLong>(size)));
+        stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+        stream.avail_in = static_cast<uInt>(size);
+        stream.next_out = reinterpret_cast<Bytef*>(out.data());
+        stream.avail_out = static_cast<uInt>(out.size());
+
+        int result = deflate(&stream, Z_FINISH);
+        out.resize(stream.total_out);
+        deflateEnd(&stream);
+        return result == Z_STREAM_END;
+        #else
+        return false;
+        #endif
+    }
+
+    case LogCompression::Zstd: {
+        #ifdef LOGGER_WITH_ZSTD
+        out.resize(ZSTD_compressBound(size));
+        std::size_t written = ZSTD_compress(out.data(), out.size(), data, size, level);
+        if (ZSTD_isError(written)) {
+            return false;
+        }
+        out.resize(written);
+        return true;
+        #else
+        return false;
+        #endif
+    }
+    }
+    return false;
+}
+
+// Compress a whole file, one fileBlockSize block at a time
+bool LogCompressor::compressFile(LogCompression compression, int level,
+                                 const std::string& sourcePath, const std::string& destinationPath) {
+    if (!isAvailable(compression) || compression == LogCompression::None) {
+        return false;
+    }
+
+    std::ifstream source(sourcePath, std::ios::binary);
+    std::ofstream destination(destinationPath, std::ios::binary | std::ios::trunc);
+    if (!source.is_open() || !destination.is_open()) {
+        return false;
+    }
+
+    std::vector<char> block(fileBlockSize);
+    std::vector<char> compressed;
+    while (source) {
+        source.read(block.data(), static_cast<std::streamsize>(block.size()));
+        std::streamsize count = source.gcount();
+        if (count <= 0) {
+            break;
+        }
+
+        if (!compressBlock(compression, level, block.data(), static_cast<std::size_t>(count), compressed)) {
+            return false;
+        }
+        destination.write(compressed.data(), static_cast<std::streamsize>(compressed.size()));
+    }
+
+    destination.flush();
+    return static_cast<bool>(destination);
+}
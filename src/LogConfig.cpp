@@ -0,0 +1,347 @@
+#include "LogConfig.hpp"
+#include "LoggerHandler.hpp"
+#include "LogPattern.hpp"
+#include "LogRegistry.hpp"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <csignal>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+// SIGHUPs received so far; the handler does nothing else
+static std::atomic<std::uint64_t> hangups{0};
+static std::atomic<bool> signalInstalled{false};
+
+#ifndef _WIN32
+static void handleHangup(int) {
+    hangups.fetch_add(1, std::memory_order_release);
+}
+#endif
+
+// Parsing helpers
+static std::string_view trim(std::string_view text) {
+    std::size_t first = 0;
+    while (first < text.size() && std::isspace(static_cast<unsigned char>(text[first]))) {
+        ++first;
+    }
+    std::size_t last = text.size();
+    while (last > first && std::isspace(static_cast<unsigned char>(text[last - 1]))) {
+        --last;
+    }
+    return text.substr(first, last - first);
+}
+
+static bool equalsIgnoringCase(std::string_view text, std::string_view lowercase) {
+    return text.size() == lowercase.size() &&
+           std::equal(text.begin(), text.end(), lowercase.begin(), [](char a, char b) {
+               return std::tolower(static_cast<unsigned char>(a)) == b;
+           });
+}
+
+static bool parseLevel(std::string_view text, LogLevel& level) {
+    static const char* const names[] = {"message", "success", "warning", "error", "off"};
+    for (std::size_t index = 0; index < LogConfig::levelCount; ++index) {
+        if (equalsIgnoringCase(text, names[index])) {
+            level = static_cast<LogLevel>(index);
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool parseBool(std::string_view text, bool& value) {
+    if (equalsIgnoringCase(text, "true") || equalsIgnoringCase(text, "on") || text == "1") {
+        value = true;
+        return true;
+    }
+    if (equalsIgnoringCase(text, "false") || equalsIgnoringCase(text, "off") || text == "0") {
+        value = false;
+        return true;
+    }
+    return false;
+}
+
+static bool parseUnsigned(std::string_view text, std::uint64_t& value) {
+    auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+    return result.ec == std::errc() && result.ptr == text.data() + text.size() && !text.empty();
+}
+
+static bool parseProbability(std::string_view text, double& value) {
+    std::string copy(text);
+    char* end = nullptr;
+    value = std::strtod(copy.c_str(), &end);
+    return !copy.empty() && end == copy.c_str() + copy.size() && value >= 0.0 && value <= 1.0;
+}
+
+template <typename Value>
+static void overlay(std::optional<Value>& base, const std::optional<Value>& top) {
+    if (top) {
+        base = top;
+    }
+}
+
+// Config files – parsing
+bool LogConfigFile::parse(std::string_view text) {
+    valid = false;
+    global = LogConfigSettings();
+    sections.clear();
+
+    LogConfigSettings* settings = &global;
+    std::size_t lineNumber = 0;
+    std::size_t position = 0;
+    while (position <= text.size()) {
+        std::size_t end = std::min(text.find('\n', position), text.size());
+        std::string_view line = trim(text.substr(position, end - position));
+        position = end + 1;
+        ++lineNumber;
+
+        if (line.empty() || line.front() == '#' || line.front() == ';') {
+            continue;
+        }
+
+        std::string where = "line " + std::to_string(lineNumber) + ": ";
+        if (line.front() == '[') {
+            if (line.back() != ']') {
+                errorText = where + "unterminated section name";
+                return false;
+            }
+            std::string name(trim(line.substr(1, line.size() - 2)));
+            auto found = std::find_if(sections.begin(), sections.end(),
+                                      [&name](const auto& section) { return section.first == name; });
+            if (found == sections.end()) {
+                sections.emplace_back(name, LogConfigSettings());
+                found = sections.end() - 1;
+            }
+            settings = &found->second;
+            continue;
+        }
+
+        std::size_t equals = line.find('=');
+        if (equals == std::string_view::npos) {
+            errorText = where + "expected key = value";
+            return false;
+        }
+        std::string_view key = trim(line.substr(0, equals));
+        std::string_view value = trim(line.substr(equals + 1));
+        if (value.size() >= 2 && value.front() == '"' && value.back() == '"') {
+            value = value.substr(1, value.size() - 2);
+        }
+        if (!parseSetting(key, value, *settings)) {
+            errorText = where + errorText;
+            return false;
+        }
+    }
+
+    valid = true;
+    errorText.clear();
+    return true;
+}
+
+bool LogConfigFile::parseSetting(std::string_view key, std::string_view value, LogConfigSettings& settings) {
+    // sample_every and sample_probability take an optional ".level"
+    std::string_view name = key;
+    std::size_t firstLevel = 0;
+    std::size_t lastLevel = LogConfig::levelCount - 1;
+    std::size_t dot = key.find('.');
+    if (dot != std::string_view::npos) {
+        name = key.substr(0, dot);
+        LogLevel level = LogLevel::Message;
+        if ((name != "sample_every" && name != "sample_probability") || !parseLevel(key.substr(dot + 1), level)) {
+            errorText = "unknown key '" + std::string(key) + "'";
+            return false;
+        }
+        firstLevel = lastLevel = static_cast<std::size_t>(level);
+    }
+
+    bool parsed = false;
+    if (name == "level") {
+        LogLevel level = LogLevel::Message;
+        parsed = parseLevel(value, level);
+        settings.minLevel = level;
+    } else if (name == "sample_every") {
+        std::uint64_t every = 0;
+        parsed = parseUnsigned(value, every) && every > 0;
+        LogSampling sampling{every > 1 ? 1.0f / static_cast<float>(every) : 1.0f, true};
+        for (std::size_t index = firstLevel; parsed && index <= lastLevel; ++index) {
+            settings.sampling[index] = sampling;
+        }
+    } else if (name == "sample_probability") {
+        double probability = 1.0;
+        parsed = parseProbability(value, probability);
+        LogSampling sampling{static_cast<float>(probability), false};
+        for (std::size_t index = firstLevel; parsed && index <= lastLevel; ++index) {
+            settings.sampling[index] = sampling;
+        }
+    } else if (name == "collapse_repeats") {
+        bool enabled = false;
+        parsed = parseBool(value, enabled);
+        settings.collapseRepeats = enabled;
+    } else if (name == "metrics_interval_ms") {
+        std::uint64_t milliseconds = 0;
+        parsed = parseUnsigned(value, milliseconds);
+        settings.metricsInterval = std::chrono::milliseconds(milliseconds);
+    } else if (name == "pattern") {
+        parsed = LogPatternParser::count(value) != LogPatternParser::invalid;
+        settings.pattern = std::string(value);
+    } else if (name == "file") {
+        parsed = true;
+        settings.filePath = std::string(value);
+    } else {
+        errorText = "unknown key '" + std::string(key) + "'";
+        return false;
+    }
+
+    if (!parsed) {
+        errorText = "bad value for " + std::string(key) + ": '" + std::string(value) + "'";
+    }
+    return parsed;
+}
+
+bool LogConfigFile::load(const std::string& path) {
+    std::ifstream input(path, std::ios::binary);
+    if (!input.is_open()) {
+        valid = false;
+        errorText = "cannot read " + path;
+        return false;
+    }
+    std::ostringstream text;
+    text << input.rdbuf();
+    if (!parse(text.str())) {
+        errorText = path + ", " + errorText;
+        return false;
+    }
+    return true;
+}
+
+bool LogConfigFile::isValid() const {
+    return valid;
+}
+
+const std::string& LogConfigFile::error() const {
+    return errorText;
+}
+
+LogConfigSettings LogConfigFile::settingsFor(const std::string& loggerName) const {
+    LogConfigSettings settings = global;
+    for (const auto& section : sections) {
+        if (section.first != loggerName) {
+            continue;
+        }
+        const LogConfigSettings& own = section.second;
+        overlay(settings.minLevel, own.minLevel);
+        for (std::size_t index = 0; index < LogConfig::levelCount; ++index) {
+            overlay(settings.sampling[index], own.sampling[index]);
+        }
+        overlay(settings.collapseRepeats, own.collapseRepeats);
+        overlay(settings.metricsInterval, own.metricsInterval);
+        overlay(settings.pattern, own.pattern);
+        overlay(settings.filePath, own.filePath);
+    }
+    return settings;
+}
+
+// Reloader – the thread wakes every signalCheckInterval (or sooner, to poll
+// the file) and reloads after a SIGHUP or a change to the file
+LogConfigReloader::LogConfigReloader(const std::string& path, std::chrono::milliseconds pollInterval)
+: path(path),
+pollInterval(pollInterval),
+hangupsSeen(hangups.load(std::memory_order_acquire)) {
+    installSignalHandler();
+    fileChanged();
+    thread = std::thread(&LogConfigReloader::run, this);
+}
+
+LogConfigReloader::~LogConfigReloader() {
+    {
+        std::lock_guard<std::mutex> stateLock(stateMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    thread.join();
+}
+
+void LogConfigReloader::watch(LoggerHandler& logger) {
+    std::lock_guard<std::mutex> reloadLock(reloadMutex);
+    if (std::find(watched.begin(), watched.end(), &logger) == watched.end()) {
+        watched.push_back(&logger);
+    }
+}
+
+void LogConfigReloader::unwatch(LoggerHandler& logger) {
+    std::lock_guard<std::mutex> reloadLock(reloadMutex);
+    watched.erase(std::remove(watched.begin(), watched.end(), &logger), watched.end());
+}
+
+bool LogConfigReloader::reload() {
+    LogConfigFile file;
+    file.load(path);
+
+    std::lock_guard<std::mutex> reloadLock(reloadMutex);
+    bool applied = LogRegistry::instance().applyConfig(file);
+    for (LoggerHandler* logger : watched) {
+        applied = logger->applyConfig(file) && applied;
+    }
+    if (file.isValid()) {
+        reloads.fetch_add(1, std::memory_order_relaxed);
+    }
+    return applied;
+}
+
+std::uint64_t LogConfigReloader::getReloadCount() const {
+    return reloads.load(std::memory_order_relaxed);
+}
+
+void LogConfigReloader::installSignalHandler() {
+    if (signalInstalled.exchange(true)) {
+        return;
+    }
+    #ifndef _WIN32
+    struct sigaction action = {};
+    action.sa_handler = handleHangup;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGHUP, &action, nullptr);
+    #endif
+}
+
+void LogConfigReloader::run() {
+    std::chrono::milliseconds wait = signalCheckInterval;
+    if (pollInterval.count() > 0) {
+        wait = std::min(wait, pollInterval);
+    }
+    auto nextPoll = std::chrono::steady_clock::now() + pollInterval;
+
+    std::unique_lock<std::mutex> stateLock(stateMutex);
+    while (!wake.wait_for(stateLock, wait, [this]() { return stopping; })) {
+        bool due = false;
+        std::uint64_t received = hangups.load(std::memory_order_acquire);
+        if (received != hangupsSeen) {
+            hangupsSeen = received;
+            due = true;
+        }
+        auto now = std::chrono::steady_clock::now();
+        if (pollInterval.count() > 0 && now >= nextPoll) {
+            nextPoll = now + pollInterval;
+            due = fileChanged() || due;
+        }
+
+        if (due) {
+            stateLock.unlock();
+            reload();
+            stateLock.lock();
+        }
+    }
+}
+
+// True if the file's modification time moved since the last look
+bool LogConfigReloader::fileChanged() {
+    std::error_code error;
+    std::filesystem::file_time_type writeTime = std::filesystem::last_write_time(path, error);
+    if (error || writeTime == lastWriteTime) {
+        return false;
+    }
+    lastWriteTime = writeTime;
+    return true;
+}
@@ -0,0 +1,392 @@
+#include "LogConsoleSink.hpp"
+#include <algorithm>
+#include <condition_variable>
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+// Console colour per level
+static const WORD levelColors[] = {
+    FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE, // Message
+    FOREGROUND_GREEN | FOREGROUND_INTENSITY,             // Success
+    FOREGROUND_RED | FOREGROUND_GREEN,                   // Warning
+    FOREGROUND_RED | FOREGROUND_INTENSITY,               // Error
+    FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE  // Off
+};
+
+static constexpr std::size_t levelCount = sizeof(levelColors) / sizeof(levelColors[0]);
+
+static const char resetSequence[] = "\033[0m";
+static constexpr std::size_t maxSequenceLength = 8;
+
+// ANSI sequence for a console colour ("\033[97m" etc.)
+static std::string ansiSequence(WORD color) {
+    bool bright = (color & FOREGROUND_INTENSITY) != 0;
+    int code;
+    switch (color & (FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE)) {
+    case FOREGROUND_RED:                                      code = 31; break;
+    case FOREGROUND_GREEN:                                    code = 32; break;
+    case FOREGROUND_RED | FOREGROUND_GREEN:                   code = 33; break;
+    case FOREGROUND_BLUE:                                     code = 34; break;
+    case FOREGROUND_RED | FOREGROUND_BLUE:                    code = 35; break;
+    case FOREGROUND_GREEN | FOREGROUND_BLUE:                  code = 36; break;
+    default:                                                  code = 37; break;
+    }
+    return "\033[" + std::to_string(bright ? code + 60 : code) + "m";
+}
+
+// Escape sequence per level, built once per process
+static const std::string& levelSequence(LogLevel level) {
+    static const struct Sequences {
+        Sequences() {
+            for (std::size_t i = 0; i < levelCount; ++i) {
+                text[i] = ansiSequence(levelColors[i]);
+            }
+        }
+        std::string text[levelCount];
+    } sequences;
+    return sequences.text[static_cast<std::size_t>(level)];
+}
+
+// Collected console output, one per console mutex
+struct LogConsoleOutput {
+    explicit LogConsoleOutput(std::mutex& consoleMutex)
+    : consoleMutex(consoleMutex) {
+    }
+    ~LogConsoleOutput();
+
+    // One write for everything collected, then one flush (the caller holds consoleMutex)
+    bool writePending() {
+        if (pending.empty()) {
+            return false;
+        }
+        std::cout.write(pending.data(), static_cast<std::streamsize>(pending.size()));
+        std::cout.flush();
+        pending.clear();
+        flushScheduled = false;
+        return true;
+    }
+
+    std::mutex& consoleMutex;
+
+    // Guarded by consoleMutex
+    std::string pending;
+    std::chrono::steady_clock::time_point oldestPending;
+    bool flushScheduled = false;
+
+    // Guarded by the flusher's mutex
+    std::chrono::steady_clock::time_point flushDeadline;
+    bool flushQueued = false;
+    bool flushing = false;
+};
+
+namespace {
+
+// Writes out collected console output once it is maxDelay old, for sinks
+// that get no later write to do it. The thread runs while any output has a
+// deadline and exits when none has; it never holds its mutex while it takes
+// a console mutex, so sinks may schedule with theirs held. A forked child
+// starts a thread of its own when it next needs one.
+class ConsoleFlusher {
+public:
+    // Never destroyed: sinks of static loggers may still unregister at exit
+    static ConsoleFlusher& instance() {
+        static ConsoleFlusher* flusher = new ConsoleFlusher();
+        return *flusher;
+    }
+
+    void schedule(LogConsoleOutput* output, std::chrono::steady_clock::time_point deadline) {
+        std::lock_guard<std::mutex> flusherLock(mutex);
+        if (std::find(outputs.begin(), outputs.end(), output) == outputs.end()) {
+            outputs.push_back(output);
+        }
+        if (!output->flushQueued || deadline < output->flushDeadline) {
+            output->flushDeadline = deadline;
+            output->flushQueued = true;
+        }
+        if (!running) {
+            running = true;
+            std::thread(&ConsoleFlusher::run, this).detach();
+        }
+        wake.notify_all();
+    }
+
+    // Waits for a flush of output in progress (the caller must not hold its console mutex)
+    void remove(LogConsoleOutput* output) {
+        std::unique_lock<std::mutex> flusherLock(mutex);
+        idle.wait(flusherLock, [output] { return !output->flushing; });
+        outputs.erase(std::remove(outputs.begin(), outputs.end(), output), outputs.end());
+    }
+
+private:
+    ConsoleFlusher() {
+        #ifndef _WIN32
+        pthread_atfork([] { instance().mutex.lock(); },
+                       [] { instance().mutex.unlock(); },
+                       [] {
+                           // The parent's thread, mid-flush or not, is gone
+                           instance().running = false;
+                           for (LogConsoleOutput* output : instance().outputs) {
+                               output->flushing = false;
+                           }
+                           instance().mutex.unlock();
+                       });
+        #endif
+    }
+
+    void run() {
+        std::unique_lock<std::mutex> flusherLock(mutex);
+        while (true) {
+            LogConsoleOutput* due = nullptr;
+            for (LogConsoleOutput* output : outputs) {
+                if (output->flushQueued && (due == nullptr || output->flushDeadline < due->flushDeadline)) {
+                    due = output;
+                }
+            }
+            if (due == nullptr) {
+                running = false;
+                return;
+            }
+            if (std::chrono::steady_clock::now() < due->flushDeadline) {
+                wake.wait_until(flusherLock, due->flushDeadline);
+                continue;
+            }
+
+            due->flushQueued = false;
+            due->flushing = true;
+            flusherLock.unlock();
+            {
+                std::lock_guard<std::mutex> consoleLock(due->consoleMutex);
+                due->writePending();
+            }
+            flusherLock.lock();
+            due->flushing = false;
+            idle.notify_all();
+        }
+    }
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable idle;
+    std::vector<LogConsoleOutput*> outputs;
+    bool running = false;
+};
+
+// The output of every sink on consoleMutex
+std::shared_ptr<LogConsoleOutput> sharedOutput(std::mutex& consoleMutex) {
+    static std::mutex registryMutex;
+    static std::map<std::mutex*, std::weak_ptr<LogConsoleOutput>> outputs;
+
+    std::lock_guard<std::mutex> registryLock(registryMutex);
+    for (auto entry = outputs.begin(); entry != outputs.end();) {
+        entry = entry->second.expired() ? outputs.erase(entry) : std::next(entry);
+    }
+    std::weak_ptr<LogConsoleOutput>& slot = outputs[&consoleMutex];
+    std::shared_ptr<LogConsoleOutput> output = slot.lock();
+    if (!output) {
+        output = std::make_shared<LogConsoleOutput>(consoleMutex);
+        slot = output;
+    }
+    return output;
+}
+
+}
+
+LogConsoleOutput::~LogConsoleOutput() {
+    ConsoleFlusher::instance().remove(this);
+}
+
+// Constructor (own mutex)
+LogConsoleSink::LogConsoleSink()
+: consoleMutex(ownMutex),
+output(sharedOutput(ownMutex)) {
+    initConsole();
+}
+
+// Constructor (shared mutex)
+LogConsoleSink::LogConsoleSink(std::mutex& consoleMutex)
+: consoleMutex(consoleMutex),
+output(sharedOutput(consoleMutex)) {
+    initConsole();
+}
+
+// Destructor (writes out anything still collected)
+LogConsoleSink::~LogConsoleSink() {
+    flush();
+    output.reset();
+}
+
+// Platform-specific console initialization
+void LogConsoleSink::initConsole() {
+    bool interactive;
+
+    #ifdef _WIN32
+    consoleHandle = GetStdHandle(STD_OUTPUT_HANDLE);
+    if (consoleHandle == INVALID_HANDLE_VALUE) {
+        consoleHandle = nullptr;
+    }
+    DWORD mode = 0;
+    interactive = consoleHandle != nullptr && GetConsoleMode(consoleHandle, &mode) != 0;
+    if (interactive) {
+        // Windows 10+ consoles understand ANSI sequences once asked to
+        useColors = SetConsoleMode(consoleHandle, mode | ENABLE_VIRTUAL_TERMINAL_PROCESSING) != 0;
+        useAttributes = !useColors;
+    }
+    #else
+    interactive = isatty(STDOUT_FILENO) != 0;
+    useColors = interactive;
+    #endif
+
+    // A person is watching a terminal: show every batch as it is written
+    if (interactive) {
+        policy.maxBufferedBytes = 0;
+    }
+    std::lock_guard<std::mutex> consoleLock(consoleMutex);
+    output->pending.reserve(policy.maxBufferedBytes + LogLineBuffer::inlineCapacity);
+    levelSequence(LogLevel::Message);
+}
+
+// Flush policy
+void LogConsoleSink::setFlushPolicy(const LogFlushPolicy& flushPolicy) {
+    std::lock_guard<std::mutex> consoleLock(consoleMutex);
+    policy = flushPolicy;
+    writePending();
+    output->pending.reserve(policy.maxBufferedBytes + LogLineBuffer::inlineCapacity);
+}
+
+LogFlushPolicy LogConsoleSink::getFlushPolicy() {
+    std::lock_guard<std::mutex> consoleLock(consoleMutex);
+    return policy;
+}
+
+// Collect the batch's lines and write them out when the policy says so
+void LogConsoleSink::write(const LogSinkBatch& batch) {
+    std::lock_guard<std::mutex> consoleLock(consoleMutex);
+
+    #ifdef _WIN32
+    if (useAttributes) {
+        writeWithAttributes(batch);
+        return;
+    }
+    #endif
+
+    LogLevel highest = LogLevel::Message;
+    if (!useColors && acceptsAll(batch)) {
+        makeRoom(batch.size());
+        output->pending.append(batch.data(), batch.size());
+        highest = batch.highestLevel();
+    } else {
+        for (const LogSinkEntry& entry : batch.entries()) {
+            if (accepts(entry.level)) {
+                appendLine(batch, entry);
+                highest = entry.level > highest ? entry.level : highest;
+            }
+        }
+    }
+
+    if (output->pending.size() >= policy.maxBufferedBytes || highest >= policy.flushLevel ||
+        (policy.maxDelay.count() > 0 && std::chrono::steady_clock::now() - output->oldestPending >= policy.maxDelay)) {
+        writePending();
+    } else {
+        scheduleFlush();
+    }
+}
+
+// Have the flusher write out what is collected once it is maxDelay old
+void LogConsoleSink::scheduleFlush() {
+    if (output->pending.empty() || output->flushScheduled || policy.maxDelay.count() <= 0) {
+        return;
+    }
+    output->flushScheduled = true;
+    ConsoleFlusher::instance().schedule(output.get(), output->oldestPending + policy.maxDelay);
+}
+
+// Write out what is collected rather than grow past the reserved size
+void LogConsoleSink::makeRoom(std::size_t length) {
+    std::string& pending = output->pending;
+    if (!pending.empty() && pending.size() + length > pending.capacity()) {
+        writePending();
+    }
+    if (pending.empty()) {
+        output->oldestPending = std::chrono::steady_clock::now();
+    }
+}
+
+void LogConsoleSink::appendLine(const LogSinkBatch& batch, const LogSinkEntry& entry) {
+    makeRoom(entry.length + maxSequenceLength + sizeof(resetSequence));
+    std::string& pending = output->pending;
+    if (!useColors) {
+        pending.append(batch.data() + entry.offset, entry.length);
+        return;
+    }
+
+    pending.append(levelSequence(entry.level));
+    pending.append(batch.data() + entry.offset, entry.length - 1);
+    pending.append(resetSequence, sizeof(resetSequence) - 1);
+    pending.push_back('\n');
+}
+
+void LogConsoleSink::writePending() {
+    if (output->writePending()) {
+        countFlush();
+    }
+}
+
+void LogConsoleSink::flush() {
+    std::lock_guard<std::mutex> consoleLock(consoleMutex);
+    writePending();
+}
+
+void LogConsoleSink::flushIfDue() {
+    std::unique_lock<std::mutex> consoleLock(consoleMutex, std::try_to_lock);
+    if (consoleLock.owns_lock() && !output->pending.empty() && policy.maxDelay.count() > 0 &&
+        std::chrono::steady_clock::now() - output->oldestPending >= policy.maxDelay) {
+        writePending();
+    }
+}
+
+// Crash path
+void LogConsoleSink::crashFlush() {
+    crashWrite(output->pending.data(), output->pending.size());
+    output->pending.clear();
+}
+
+void LogConsoleSink::crashWrite(const char* record, std::size_t length) {
+    while (length > 0) {
+        #ifdef _WIN32
+        int written = _write(1, record, static_cast<unsigned int>(length));
+        #else
+        ssize_t written = ::write(STDOUT_FILENO, record, length);
+        #endif
+        if (written <= 0) {
+            return;
+        }
+        record += written;
+        length -= static_cast<std::size_t>(written);
+    }
+}
+
+#ifdef _WIN32
+// Legacy consoles: colours are console attributes, set between line writes
+void LogConsoleSink::writeWithAttributes(const LogSinkBatch& batch) {
+    for (const LogSinkEntry& entry : batch.entries()) {
+        if (!accepts(entry.level)) {
+            continue;
+        }
+
+        SetConsoleTextAttribute(consoleHandle, levelColors[static_cast<std::size_t>(entry.level)]);
+        std::cout.write(batch.data() + entry.offset, static_cast<std::streamsize>(entry.length));
+        std::cout.flush();
+    }
+    SetConsoleTextAttribute(consoleHandle, FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE);
+}
+#endif
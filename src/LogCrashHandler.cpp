@@ -0,0 +1,136 @@
+#include "LogCrashHandler.hpp"
+#include "LoggerHandler.hpp"
+#include "LogTimestamp.hpp"
+#include <atomic>
+#include <csignal>
+#include <cstdlib>
+#include <exception>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+// Live loggers; slots are claimed and released with a single atomic operation
+static std::atomic<LoggerHandler*> registeredLoggers[LogCrashHandler::maxLoggers];
+
+static std::atomic<bool> installed{false};
+static std::atomic<bool> dumping{false};
+static std::terminate_handler previousTerminate = nullptr;
+
+// Only touched by the dumping thread. install() fixes its UTC offset, so a
+// crash formats local time by arithmetic and never calls localtime_r
+// (which takes the time-zone lock)
+static LogTimestampCache crashTimestampCache;
+
+static const int fatalSignals[] = { SIGSEGV, SIGFPE, SIGILL, SIGABRT,
+#ifndef _WIN32
+                                    SIGBUS
+#endif
+};
+
+static const char* crashReason(int signalNumber) {
+    switch (signalNumber) {
+    case SIGSEGV: return "=== Crash: SIGSEGV, pending log records written ===";
+    case SIGFPE:  return "=== Crash: SIGFPE, pending log records written ===";
+    case SIGILL:  return "=== Crash: SIGILL, pending log records written ===";
+    case SIGABRT: return "=== Crash: SIGABRT, pending log records written ===";
+#ifndef _WIN32
+    case SIGBUS:  return "=== Crash: SIGBUS, pending log records written ===";
+#endif
+    default:      return "=== Crash: fatal signal, pending log records written ===";
+    }
+}
+
+static void handleFatalSignal(int signalNumber) {
+    LogCrashHandler::dump(crashReason(signalNumber));
+
+    // The handler was installed one-shot, so this takes the default action
+    #ifdef _WIN32
+    std::signal(signalNumber, SIG_DFL);
+    #endif
+    std::raise(signalNumber);
+}
+
+static void handleTerminate() {
+    LogCrashHandler::dump("=== Crash: std::terminate, pending log records written ===");
+    if (previousTerminate != nullptr) {
+        previousTerminate();
+    }
+    std::abort();
+}
+
+#ifdef _WIN32
+static LONG WINAPI handleUnhandledException(EXCEPTION_POINTERS*) {
+    LogCrashHandler::dump("=== Crash: unhandled exception, pending log records written ===");
+    return EXCEPTION_CONTINUE_SEARCH;
+}
+#endif
+
+void LogCrashHandler::install() {
+    if (installed.exchange(true)) {
+        return;
+    }
+
+    crashTimestampCache.setFixedUtcOffset(LogTimestampCache::utcOffsetAt(std::chrono::system_clock::now()));
+
+    #ifdef _WIN32
+    for (int signalNumber : fatalSignals) {
+        std::signal(signalNumber, handleFatalSignal);
+    }
+    SetUnhandledExceptionFilter(handleUnhandledException);
+    #else
+    // An alternate stack, so a stack overflow can still be reported
+    static char alternateStack[64 * 1024];
+    stack_t stack = {};
+    stack.ss_sp = alternateStack;
+    stack.ss_size = sizeof(alternateStack);
+    sigaltstack(&stack, nullptr);
+
+    struct sigaction action = {};
+    action.sa_handler = handleFatalSignal;
+    action.sa_flags = SA_ONSTACK | SA_RESETHAND;
+    sigemptyset(&action.sa_mask);
+    for (int signalNumber : fatalSignals) {
+        sigaction(signalNumber, &action, nullptr);
+    }
+    #endif
+
+    previousTerminate = std::set_terminate(handleTerminate);
+}
+
+bool LogCrashHandler::isInstalled() {
+    return installed.load(std::memory_order_acquire);
+}
+
+void LogCrashHandler::dump(const char* reason) {
+    // A crash while dumping (or a second crashing thread) must not dump again
+    if (dumping.exchange(true)) {
+        return;
+    }
+
+    for (auto& slot : registeredLoggers) {
+        if (LoggerHandler* logger = slot.load(std::memory_order_acquire)) {
+            logger->writeCrashDump(reason, crashTimestampCache);
+        }
+    }
+}
+
+void LogCrashHandler::registerLogger(LoggerHandler* logger) {
+    for (auto& slot : registeredLoggers) {
+        LoggerHandler* expected = nullptr;
+        if (slot.load(std::memory_order_relaxed) == nullptr &&
+            slot.compare_exchange_strong(expected, logger, std::memory_order_acq_rel)) {
+            return;
+        }
+    }
+}
+
+void LogCrashHandler::unregisterLogger(LoggerHandler* logger) {
+    for (auto& slot : registeredLoggers) {
+        LoggerHandler* expected = logger;
+        if (slot.load(std::memory_order_relaxed) == logger &&
+            slot.compare_exchange_strong(expected, nullptr, std::memory_order_acq_rel)) {
+            return;
+        }
+    }
+}
@@ -0,0 +1,592 @@
+#include "LogFileSink.hpp"
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <string_view>
+
+#include <fcntl.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#if defined(__linux__)
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#endif
+
+// Run the calling thread at the lowest scheduling priority
+static void lowerThreadPriority() {
+    #ifdef _WIN32
+    SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_LOWEST);
+    #elif defined(__linux__)
+    setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), 19);
+    #endif
+}
+
+// Start of the next hour or day after now, in local time
+static std::chrono::system_clock::time_point nextBoundary(std::chrono::system_clock::time_point now,
+                                                          LogRotationInterval interval) {
+    std::time_t inTimeT = std::chrono::system_clock::to_time_t(now);
+    std::tm timeBuffer;
+
+    #ifdef _WIN32
+    localtime_s(&timeBuffer, &inTimeT);
+    #else
+    localtime_r(&inTimeT, &timeBuffer);
+    #endif
+
+    timeBuffer.tm_min = 0;
+    timeBuffer.tm_sec = 0;
+    timeBuffer.tm_isdst = -1;
+    if (interval == LogRotationInterval::Daily) {
+        timeBuffer.tm_hour = 0;
+        timeBuffer.tm_mday += 1;
+    } else {
+        timeBuffer.tm_hour += 1;
+    }
+    return std::chrono::system_clock::from_time_t(std::mktime(&timeBuffer));
+}
+
+// "<path>.<YYYYMMDD-HHMMSS>", with a counter appended if that name (or its
+// compressed form) is taken
+static std::string rotatedFileName(const std::string& filePath, const char* compressedExtension) {
+    std::time_t inTimeT = std::time(nullptr);
+    std::tm timeBuffer;
+
+    #ifdef _WIN32
+    localtime_s(&timeBuffer, &inTimeT);
+    #else
+    localtime_r(&inTimeT, &timeBuffer);
+    #endif
+
+    char suffix[32];
+    std::strftime(suffix, sizeof(suffix), "%Y%m%d-%H%M%S", &timeBuffer);
+
+    std::string name = filePath + "." + suffix;
+    std::error_code error;
+    for (int counter = 1; std::filesystem::exists(name, error) ||
+                          std::filesystem::exists(name + compressedExtension, error); ++counter) {
+        name = filePath + "." + suffix + "." + std::to_string(counter);
+    }
+    return name;
+}
+
+// Whether name is one rotatedFileName made from prefix ("<file>."):
+// "YYYYMMDD-HHMMSS", then an optional ".N", then an optional ".gz" / ".zst"
+static bool isRotatedFileName(const std::string& name, const std::string& prefix) {
+    if (name.compare(0, prefix.size(), prefix) != 0) {
+        return false;
+    }
+
+    std::size_t position = prefix.size();
+    auto digits = [&name, &position](std::size_t count) {
+        std::size_t start = position;
+        while (position < name.size() && name[position] >= '0' && name[position] <= '9' &&
+               (count == 0 || position - start < count)) {
+            ++position;
+        }
+        return count == 0 ? position > start : position - start == count;
+    };
+    if (!digits(8) || position >= name.size() || name[position++] != '-' || !digits(6)) {
+        return false;
+    }
+
+    std::string_view rest(name.data() + position, name.size() - position);
+    if (!rest.empty() && rest.front() == '.' && rest.size() > 1 && rest[1] >= '0' && rest[1] <= '9') {
+        ++position;
+        digits(0);
+        rest = std::string_view(name.data() + position, name.size() - position);
+    }
+    return rest.empty() || rest == ".gz" || rest == ".zst";
+}
+
+LogFileSink::LogFileSink(LogSinkFormat format)
+: LogSink(format) {
+}
+
+// Destructor (guarantees buffered lines reach the file)
+LogFileSink::~LogFileSink() {
+    close();
+}
+
+bool LogFileSink::open(const std::string& filePath) {
+    close();
+
+    file = LogFileWriter::open(filePath, policy.ioBackend, policy.buffersInFlight);
+    if (!file) {
+        return false;
+    }
+
+    path = filePath;
+    opened = true;
+    buffer.resize(policy.maxBufferedBytes > 0 ? policy.maxBufferedBytes : 1);
+    bufferedBytes = 0;
+
+    if (rotationEnabled()) {
+        std::error_code error;
+        auto existingSize = std::filesystem::file_size(filePath, error);
+        currentFileBytes = error ? 0 : static_cast<std::uint64_t>(existingSize);
+        if (rotation.interval != LogRotationInterval::None) {
+            nextRotationTime = nextBoundary(std::chrono::system_clock::now(), rotation.interval);
+        }
+
+        // A stream-compressed file is already compressed
+        compressing = compression.rotatedFiles != LogCompression::None && compression.stream == LogCompression::None;
+        if (compressing) {
+            stopCompression = false;
+            compressionThread = std::thread(&LogFileSink::compressionLoop, this);
+        }
+
+        stopRotation = false;
+        rotationPending = false;
+        rotationDone = false;
+        rotationThread = std::thread(&LogFileSink::rotationLoop, this);
+    }
+
+    if (!filePreamble.empty()) {
+        append(filePreamble.data(), filePreamble.size());
+    }
+    return true;
+}
+
+void LogFileSink::close() {
+    if (!opened && !rotationThread.joinable()) {
+        return;
+    }
+
+    // A rotation in flight must finish so buffered lines land in the new file
+    if (rotationPending) {
+        adoptRotatedFile(true);
+    }
+    flush();
+
+    if (rotationThread.joinable()) {
+        {
+            std::lock_guard<std::mutex> rotationLock(rotationMutex);
+            stopRotation = true;
+        }
+        rotationWake.notify_all();
+        rotationThread.join();
+    }
+
+    // Files still queued are compressed before the sink lets go
+    if (compressionThread.joinable()) {
+        {
+            std::lock_guard<std::mutex> compressionLock(compressionMutex);
+            stopCompression = true;
+        }
+        compressionWake.notify_all();
+        compressionThread.join();
+    }
+    compressing = false;
+
+    if (file) {
+        file->close();
+        file.reset();
+    }
+    opened = false;
+}
+
+bool LogFileSink::isOpen() const {
+    return opened;
+}
+
+// Flush policy
+void LogFileSink::setFlushPolicy(const LogFlushPolicy& flushPolicy) {
+    flush();
+    policy = flushPolicy;
+    if (opened) {
+        buffer.resize(std::max(bufferedBytes, policy.maxBufferedBytes > 0 ? policy.maxBufferedBytes : 1));
+    }
+}
+
+const LogFlushPolicy& LogFileSink::getFlushPolicy() const {
+    return policy;
+}
+
+// Rotation policy
+void LogFileSink::setRotationPolicy(const LogRotationPolicy& rotationPolicy) {
+    rotation = rotationPolicy;
+}
+
+const LogRotationPolicy& LogFileSink::getRotationPolicy() const {
+    return rotation;
+}
+
+// Compression policy
+void LogFileSink::setCompressionPolicy(const LogCompressionPolicy& compressionPolicy) {
+    compression = compressionPolicy;
+}
+
+const LogCompressionPolicy& LogFileSink::getCompressionPolicy() const {
+    return compression;
+}
+
+// Preamble
+void LogFileSink::setFilePreamble(const std::string& preamble) {
+    filePreamble = preamble;
+}
+
+// Writing
+void LogFileSink::writeLine(const char* text, std::size_t length, LogLevel level) {
+    writeEntry(text, length, true, level);
+}
+
+void LogFileSink::writeRecord(const char* data, std::size_t length, LogLevel level) {
+    writeEntry(data, length, false, level);
+}
+
+void LogFileSink::writeEntry(const char* text, std::size_t length, bool newline, LogLevel level) {
+    if (!opened) {
+        return;
+    }
+
+    if (rotationEnabled() && !rotationPending && rotationDue()) {
+        startRotation();
+    }
+
+    append(text, length);
+    if (newline) {
+        append("\n", 1);
+    }
+    applyFlushPolicy(level);
+}
+
+void LogFileSink::write(const LogSinkBatch& batch) {
+    if (!opened || batch.empty()) {
+        return;
+    }
+
+    // The whole run in one copy, unless records must be filtered or a
+    // rotation may fall between two of them
+    if (!rotationEnabled() && acceptsAll(batch)) {
+        append(batch.data(), batch.size());
+        applyFlushPolicy(batch.highestLevel());
+        return;
+    }
+
+    LogLevel highest = LogLevel::Message;
+    bool wroteAny = false;
+    for (const LogSinkEntry& entry : batch.entries()) {
+        if (accepts(entry.level)) {
+            if (rotationPending) {
+                flush();
+            }
+            if (rotationEnabled() && !rotationPending && rotationDue()) {
+                startRotation();
+            }
+            append(batch.data() + entry.offset, entry.length);
+            highest = entry.level > highest ? entry.level : highest;
+            wroteAny = true;
+        }
+    }
+    if (wroteAny) {
+        applyFlushPolicy(highest);
+    }
+}
+
+void LogFileSink::applyFlushPolicy(LogLevel level) {
+    if (level >= policy.flushLevel) {
+        flush();
+    } else if (bufferedBytes >= policy.maxBufferedBytes) {
+        submitBuffered();
+    } else {
+        flushIfDue();
+    }
+}
+
+void LogFileSink::writeRaw(const char* text, std::size_t length) {
+    if (opened) {
+        append(text, length);
+    }
+}
+
+void LogFileSink::append(const char* text, std::size_t length) {
+    if (bufferedBytes + length > buffer.size()) {
+        submitBuffered();
+
+        if (bufferedBytes + length > buffer.size()) {
+            if (file && bufferedBytes == 0) {
+                // Larger than the whole buffer: write it straight through
+                writeOut(text, length);
+                return;
+            }
+            // Waiting for a rotated file: keep everything until it arrives
+            buffer.resize(std::max(buffer.size() * 2, bufferedBytes + length));
+        }
+    }
+
+    if (bufferedBytes == 0) {
+        oldestBuffered = std::chrono::steady_clock::now();
+    }
+    std::memcpy(buffer.data() + bufferedBytes, text, length);
+    bufferedBytes += length;
+}
+
+void LogFileSink::writeOut(const char* text, std::size_t length) {
+    if (compression.stream != LogCompression::None &&
+        LogCompressor::compressBlock(compression.stream, compression.level, text, length, compressedBlock)) {
+        text = compressedBlock.data();
+        length = compressedBlock.size();
+    }
+
+    file->write(text, length);
+    currentFileBytes += length;
+    countFlush();
+}
+
+// Flushing – hand the buffer to the file and wait for it to get there
+void LogFileSink::flush() {
+    submitBuffered();
+    if (file && !rotationPending) {
+        file->flush();
+    }
+}
+
+// Hand the buffer to the file without waiting for an asynchronous write
+void LogFileSink::submitBuffered() {
+    if (rotationPending && !adoptRotatedFile(false)) {
+        return;
+    }
+    if (file && bufferedBytes > 0) {
+        writeOut(buffer.data(), bufferedBytes);
+        bufferedBytes = 0;
+    }
+}
+
+void LogFileSink::flushIfDue() {
+    if (rotationPending) {
+        submitBuffered();
+        return;
+    }
+
+    if (bufferedBytes > 0 && policy.maxDelay.count() > 0 &&
+        std::chrono::steady_clock::now() - oldestBuffered >= policy.maxDelay) {
+        submitBuffered();
+    }
+}
+
+std::size_t LogFileSink::getBufferedBytes() const {
+    return bufferedBytes;
+}
+
+// Crash path
+void LogFileSink::crashFlush() {
+    if (!opened || compression.stream != LogCompression::None || crashDescriptor >= 0) {
+        return;
+    }
+
+    if (file) {
+        file->crashFlush();
+    }
+
+    #ifdef _WIN32
+    crashDescriptor = _open(path.c_str(), _O_WRONLY | _O_APPEND | _O_CREAT | _O_BINARY, 0644);
+    #else
+    crashDescriptor = ::open(path.c_str(), O_WRONLY | O_APPEND | O_CREAT, 0644);
+    #endif
+    crashWrite(buffer.data(), bufferedBytes);
+    bufferedBytes = 0;
+}
+
+void LogFileSink::crashWrite(const char* record, std::size_t length) {
+    if (crashDescriptor < 0) {
+        return;
+    }
+
+    while (length > 0) {
+        #ifdef _WIN32
+        int written = _write(crashDescriptor, record, static_cast<unsigned int>(length));
+        #else
+        ssize_t written = ::write(crashDescriptor, record, length);
+        #endif
+        if (written <= 0) {
+            return;
+        }
+        record += written;
+        length -= static_cast<std::size_t>(written);
+    }
+}
+
+// Rotation – triggers
+bool LogFileSink::rotationEnabled() const {
+    return rotation.maxFileBytes > 0 || rotation.interval != LogRotationInterval::None;
+}
+
+bool LogFileSink::rotationDue() const {
+    if (rotation.maxFileBytes > 0 && currentFileBytes + bufferedBytes >= rotation.maxFileBytes) {
+        return true;
+    }
+    return rotation.interval != LogRotationInterval::None &&
+           std::chrono::system_clock::now() >= nextRotationTime;
+}
+
+// Rotation – hand the full file to the rotation thread
+void LogFileSink::startRotation() {
+    flush();
+
+    {
+        std::lock_guard<std::mutex> rotationLock(rotationMutex);
+        retiringFile = std::move(file);
+        rotationPending = true;
+        rotationDone = false;
+    }
+    rotationWake.notify_all();
+
+    currentFileBytes = 0;
+    if (rotation.interval != LogRotationInterval::None) {
+        nextRotationTime = nextBoundary(std::chrono::system_clock::now(), rotation.interval);
+    }
+
+    // Buffered until the fresh file is adopted, so it lands first in it
+    if (!filePreamble.empty()) {
+        append(filePreamble.data(), filePreamble.size());
+    }
+}
+
+// Rotation – swap in the fresh file once the rotation thread has opened it
+bool LogFileSink::adoptRotatedFile(bool wait) {
+    std::unique_lock<std::mutex> rotationLock(rotationMutex, std::defer_lock);
+    if (wait) {
+        rotationLock.lock();
+        rotationWake.wait(rotationLock, [this] { return rotationDone; });
+    } else if (!rotationLock.try_lock() || !rotationDone) {
+        return false;
+    }
+
+    file = std::move(rotatedFile);
+    rotationPending = false;
+    rotationDone = false;
+    if (!file) {
+        // The new file could not be opened; nothing more can be written
+        opened = false;
+        bufferedBytes = 0;
+        return false;
+    }
+    return true;
+}
+
+// Rotation thread – close, rename, reopen and prune off the writing path,
+// at normal priority since the writer may be waiting for the fresh file
+void LogFileSink::rotationLoop() {
+    std::unique_lock<std::mutex> rotationLock(rotationMutex);
+
+    while (true) {
+        rotationWake.wait(rotationLock, [this] {
+            return stopRotation || retiringFile != nullptr;
+        });
+        if (retiringFile == nullptr) {
+            break;
+        }
+
+        std::unique_ptr<LogFileWriter> fullFile = std::move(retiringFile);
+        rotationLock.unlock();
+
+        fullFile->close();
+        fullFile.reset();
+
+        std::error_code error;
+        std::string rotatedPath = rotatedFileName(path, LogCompressor::extension(compression.rotatedFiles));
+        std::filesystem::rename(path, rotatedPath, error);
+        std::unique_ptr<LogFileWriter> freshFile = LogFileWriter::open(path, policy.ioBackend,
+                                                                       policy.buffersInFlight);
+
+        rotationLock.lock();
+        rotatedFile = std::move(freshFile);
+        rotationDone = true;
+        rotationWake.notify_all();
+        rotationLock.unlock();
+
+        // The writer has its new file; compression (and the pruning after
+        // it) happens on the compression thread
+        if (!compressing) {
+            pruneRotatedFiles();
+        } else if (!error) {
+            {
+                std::lock_guard<std::mutex> compressionLock(compressionMutex);
+                compressionQueue.push_back(rotatedPath);
+            }
+            compressionWake.notify_all();
+        }
+
+        rotationLock.lock();
+    }
+}
+
+// Compression thread – at the lowest priority, so it only uses idle CPU
+void LogFileSink::compressionLoop() {
+    lowerThreadPriority();
+
+    std::unique_lock<std::mutex> compressionLock(compressionMutex);
+    while (true) {
+        compressionWake.wait(compressionLock, [this] {
+            return stopCompression || !compressionQueue.empty();
+        });
+        if (compressionQueue.empty()) {
+            break;
+        }
+
+        std::string rotatedPath = std::move(compressionQueue.front());
+        compressionQueue.pop_front();
+        compressionLock.unlock();
+
+        compressRotatedFile(rotatedPath);
+        pruneRotatedFiles();
+
+        compressionLock.lock();
+    }
+}
+
+// Replace a rotated file with its compressed copy
+void LogFileSink::compressRotatedFile(const std::string& rotatedPath) {
+    // A stream-compressed file is already compressed
+    if (compression.rotatedFiles == LogCompression::None || compression.stream != LogCompression::None) {
+        return;
+    }
+
+    std::string compressedPath = rotatedPath + LogCompressor::extension(compression.rotatedFiles);
+    std::error_code error;
+    if (LogCompressor::compressFile(compression.rotatedFiles, compression.level, rotatedPath, compressedPath)) {
+        std::filesystem::remove(rotatedPath, error);
+    } else {
+        std::filesystem::remove(compressedPath, error);
+    }
+}
+
+// Delete the oldest rotated files so at most maxFiles remain. Any file next
+// to the log whose name has the rotated form counts, whoever created it:
+// rotations left by earlier runs, or by another process logging to the same
+// path, are pruned with this sink's own. Other files that share the name's
+// prefix, such as "app.log.bak", are left alone.
+void LogFileSink::pruneRotatedFiles() {
+    if (rotation.maxFiles == 0) {
+        return;
+    }
+
+    std::filesystem::path activePath(path);
+    std::filesystem::path directory = activePath.has_parent_path() ? activePath.parent_path()
+                                                                   : std::filesystem::path(".");
+    std::string prefix = activePath.filename().string() + ".";
+
+    // Rotated files are written (and compressed) one at a time, so modification
+    // time orders them oldest first; the name breaks ties
+    std::vector<std::pair<std::filesystem::file_time_type, std::filesystem::path>> rotatedFiles;
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator(directory, error)) {
+        std::string name = entry.path().filename().string();
+        if (isRotatedFileName(name, prefix)) {
+            rotatedFiles.emplace_back(entry.last_write_time(error), entry.path());
+        }
+    }
+
+    std::sort(rotatedFiles.begin(), rotatedFiles.end());
+    while (rotatedFiles.size() > rotation.maxFiles) {
+        std::filesystem::remove(rotatedFiles.front().second, error);
+        rotatedFiles.erase(rotatedFiles.begin());
+    }
+}
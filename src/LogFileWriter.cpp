@@ -0,0 +1,55 @@
+#include "LogFileWriter.hpp"
+#include "LogAsyncFileWriter.hpp"
+#include <fstream>
+
+namespace {
+
+// Unbuffered append stream: the sink's own buffer replaces the stream's
+class LogStreamFileWriter : public LogFileWriter {
+public:
+    bool open(const std::string& filePath) {
+        stream.rdbuf()->pubsetbuf(nullptr, 0);
+        stream.open(filePath, std::ios::app | std::ios::binary);
+        return stream.is_open();
+    }
+
+    void write(const char* data, std::size_t length) override {
+        stream.write(data, static_cast<std::streamsize>(length));
+    }
+
+    void flush() override {
+        stream.flush();
+    }
+
+    void close() override {
+        if (stream.is_open()) {
+            stream.close();
+        }
+    }
+
+private:
+    std::ofstream stream;
+};
+
+}
+
+std::unique_ptr<LogFileWriter> LogFileWriter::open(const std::string& filePath, LogFileIoBackend backend,
+                                                   std::size_t buffersInFlight) {
+    if (backend == LogFileIoBackend::Async) {
+        auto asyncWriter = std::make_unique<LogAsyncFileWriter>();
+        if (asyncWriter->open(filePath, buffersInFlight)) {
+            return asyncWriter;
+        }
+    }
+
+    auto streamWriter = std::make_unique<LogStreamFileWriter>();
+    if (!streamWriter->open(filePath)) {
+        return nullptr;
+    }
+    return streamWriter;
+}
+
+LogFileWriter::~LogFileWriter() = default;
+
+void LogFileWriter::crashFlush() {
+}
@@ -0,0 +1,208 @@
+#include "LogFormatter.hpp"
+#include <charconv>
+
+// Format a payload produced by encode() against its pattern
+void LogFormatter::formatEncoded(LogLineBuffer& out, std::string_view pattern,
+                                 const char* payload, std::size_t payloadSize) {
+    std::size_t position = 0;
+    std::size_t offset = 0;
+    Argument argument;
+
+    while (offset < payloadSize && nextPlaceholder(out, pattern, position)) {
+        if (!decodeArgument(payload, payloadSize, offset, argument)) {
+            break;
+        }
+        appendArgument(out, argument);
+    }
+
+    appendRemainder(out, pattern, position);
+}
+
+// Read one argument back; a truncated or unknown one ends the payload
+bool LogFormatter::decodeArgument(const char* payload, std::size_t payloadSize,
+                                  std::size_t& offset, Argument& argument) {
+    if (offset >= payloadSize) {
+        return false;
+    }
+
+    argument.type = static_cast<ArgumentType>(payload[offset]);
+    std::size_t valueOffset = offset + 1;
+    std::size_t valueSize;
+
+    switch (argument.type) {
+    case ArgumentType::Int:
+        valueSize = sizeof(argument.intValue);
+        break;
+    case ArgumentType::UInt:
+        valueSize = sizeof(argument.uintValue);
+        break;
+    case ArgumentType::Double:
+        valueSize = sizeof(argument.doubleValue);
+        break;
+    case ArgumentType::Bool:
+    case ArgumentType::Char:
+        valueSize = 1;
+        break;
+    case ArgumentType::String:
+        valueSize = sizeof(std::uint32_t);
+        break;
+    case ArgumentType::Pointer:
+        valueSize = sizeof(argument.pointerValue);
+        break;
+    default:
+        offset = payloadSize;
+        return false;
+    }
+
+    if (valueOffset + valueSize > payloadSize) {
+        offset = payloadSize;
+        return false;
+    }
+
+    const char* value = payload + valueOffset;
+    switch (argument.type) {
+    case ArgumentType::Int:
+        std::memcpy(&argument.intValue, value, valueSize);
+        break;
+    case ArgumentType::UInt:
+        std::memcpy(&argument.uintValue, value, valueSize);
+        break;
+    case ArgumentType::Double:
+        std::memcpy(&argument.doubleValue, value, valueSize);
+        break;
+    case ArgumentType::Bool:
+        argument.boolValue = *value != 0;
+        break;
+    case ArgumentType::Char:
+        argument.charValue = *value;
+        break;
+    case ArgumentType::String: {
+        std::uint32_t length;
+        std::memcpy(&length, value, sizeof(length));
+        if (valueOffset + valueSize + length > payloadSize) {
+            offset = payloadSize;
+            return false;
+        }
+        argument.text = std::string_view(value + valueSize, length);
+        valueSize += length;
+        break;
+    }
+    case ArgumentType::Pointer:
+        std::memcpy(&argument.pointerValue, value, valueSize);
+        break;
+    }
+
+    offset = valueOffset + valueSize;
+    return true;
+}
+
+void LogFormatter::appendArgument(LogLineBuffer& out, const Argument& argument) {
+    switch (argument.type) {
+    case ArgumentType::Int:
+        appendValue(out, argument.intValue);
+        break;
+    case ArgumentType::UInt:
+        appendValue(out, argument.uintValue);
+        break;
+    case ArgumentType::Double:
+        appendValue(out, argument.doubleValue);
+        break;
+    case ArgumentType::Bool:
+        appendValue(out, argument.boolValue);
+        break;
+    case ArgumentType::Char:
+        appendValue(out, argument.charValue);
+        break;
+    case ArgumentType::String:
+        appendValue(out, argument.text);
+        break;
+    case ArgumentType::Pointer:
+        appendValue(out, argument.pointerValue);
+        break;
+    }
+}
+
+// Value formatting
+void LogFormatter::appendValue(LogLineBuffer& out, long long value) {
+    char digits[24];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    out.append(digits, static_cast<std::size_t>(result.ptr - digits));
+}
+
+void LogFormatter::appendValue(LogLineBuffer& out, unsigned long long value) {
+    char digits[24];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    out.append(digits, static_cast<std::size_t>(result.ptr - digits));
+}
+
+void LogFormatter::appendValue(LogLineBuffer& out, double value) {
+    char digits[32];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    out.append(digits, static_cast<std::size_t>(result.ptr - digits));
+}
+
+void LogFormatter::appendValue(LogLineBuffer& out, bool value) {
+    if (value) {
+        out.append("true", 4);
+    } else {
+        out.append("false", 5);
+    }
+}
+
+void LogFormatter::appendValue(LogLineBuffer& out, char value) {
+    out.append(value);
+}
+
+void LogFormatter::appendValue(LogLineBuffer& out, std::string_view value) {
+    out.append(value.data(), value.size());
+}
+
+void LogFormatter::appendValue(LogLineBuffer& out, const void* value) {
+    char digits[2 + 2 * sizeof(std::uintptr_t)] = { '0', 'x' };
+    auto result = std::to_chars(digits + 2, digits + sizeof(digits),
+                                reinterpret_cast<std::uintptr_t>(value), 16);
+    out.append(digits, static_cast<std::size_t>(result.ptr - digits));
+}
+
+// Copy literal text up to the next "{}", unescaping "{{" and "}}"
+bool LogFormatter::nextPlaceholder(LogLineBuffer& out, std::string_view pattern, std::size_t& position) {
+    std::size_t literalStart = position;
+
+    while (position < pattern.size()) {
+        char current = pattern[position];
+        bool hasNext = position + 1 < pattern.size();
+
+        if ((current == '{' || current == '}') && hasNext && pattern[position + 1] == current) {
+            out.append(pattern.data() + literalStart, position + 1 - literalStart);
+            position += 2;
+            literalStart = position;
+        } else if (current == '{' && hasNext && pattern[position + 1] == '}') {
+            out.append(pattern.data() + literalStart, position - literalStart);
+            position += 2;
+            return true;
+        } else {
+            ++position;
+        }
+    }
+
+    out.append(pattern.data() + literalStart, position - literalStart);
+    return false;
+}
+
+// Copy whatever follows the last consumed placeholder
+void LogFormatter::appendRemainder(LogLineBuffer& out, std::string_view pattern, std::size_t position) {
+    while (nextPlaceholder(out, pattern, position)) {
+        // Placeholders without an argument are kept as written
+        out.append("{}", 2);
+    }
+}
+
+// Strings are stored as a 32-bit length followed by the bytes
+void LogFormatter::encodeString(std::string& payload, std::string_view value) {
+    std::uint32_t length = static_cast<std::uint32_t>(value.size());
+    char header[1 + sizeof(length)];
+    header[0] = static_cast<char>(ArgumentType::String);
+    std::memcpy(header + 1, &length, sizeof(length));
+    payload.append(header, sizeof(header));
+    payload.append(value.data(), value.size());
+}
@@ -0,0 +1,42 @@
+#include "LogMemorySink.hpp"
+
+LogMemorySink::LogMemorySink(LogSinkFormat format, std::size_t maxRecords)
+: LogSink(format),
+maxRecords(maxRecords) {
+}
+
+void LogMemorySink::write(const LogSinkBatch& batch) {
+    std::lock_guard<std::mutex> recordsLock(recordsMutex);
+
+    // Every line format ends its records with a newline; binary records are kept whole
+    bool lines = batch.format() != LogSinkFormat::Binary;
+    for (const LogSinkEntry& entry : batch.entries()) {
+        if (accepts(entry.level)) {
+            const char* record = batch.data() + entry.offset;
+            std::size_t length = entry.length;
+            if (lines && length > 0 && record[length - 1] == '\n') {
+                --length;
+            }
+            records.emplace_back(record, length);
+        }
+    }
+
+    while (maxRecords > 0 && records.size() > maxRecords) {
+        records.pop_front();
+    }
+}
+
+std::vector<std::string> LogMemorySink::getRecords() const {
+    std::lock_guard<std::mutex> recordsLock(recordsMutex);
+    return std::vector<std::string>(records.begin(), records.end());
+}
+
+std::size_t LogMemorySink::getRecordCount() const {
+    std::lock_guard<std::mutex> recordsLock(recordsMutex);
+    return records.size();
+}
+
+void LogMemorySink::clear() {
+    std::lock_guard<std::mutex> recordsLock(recordsMutex);
+    records.clear();
+}
@@ -0,0 +1,209 @@
+#include "LogMetrics.hpp"
+#include "LogStructuredFormat.hpp"
+#include <algorithm>
+#include <mutex>
+
+namespace {
+
+// Live loggers' metrics, and the totals of those already destroyed. Never
+// freed, so loggers destroyed during static destruction can still unregister.
+struct LogMetricsRegistry {
+    std::mutex mutex;
+    std::vector<const LogMetrics*> live;
+    LogMetricsSnapshot retired;
+};
+
+LogMetricsRegistry& metricsRegistry() {
+    static LogMetricsRegistry* registry = new LogMetricsRegistry;
+    return *registry;
+}
+
+void appendLatency(std::string& out, const char* name, const LogLatencySnapshot& latency) {
+    if (latency.count == 0) {
+        return;
+    }
+    out += ' ';
+    out += name;
+    out += "_p50=" + std::to_string(latency.percentile(0.5)) + "ns ";
+    out += name;
+    out += "_p99=" + std::to_string(latency.percentile(0.99)) + "ns ";
+    out += name;
+    out += "_p999=" + std::to_string(latency.percentile(0.999)) + "ns";
+}
+
+}
+
+// Latency snapshots
+std::uint64_t LogLatencySnapshot::percentile(double fraction) const {
+    if (count == 0) {
+        return 0;
+    }
+
+    double rank = std::clamp(fraction, 0.0, 1.0) * static_cast<double>(count);
+    std::uint64_t seen = 0;
+    for (std::size_t index = 0; index < bucketCount; ++index) {
+        seen += buckets[index];
+        if (seen > 0 && static_cast<double>(seen) >= rank) {
+            return std::uint64_t(1) << index;
+        }
+    }
+    return std::uint64_t(1) << (bucketCount - 1);
+}
+
+std::uint64_t LogLatencySnapshot::meanNanoseconds() const {
+    return count > 0 ? totalNanoseconds / count : 0;
+}
+
+void LogLatencySnapshot::merge(const LogLatencySnapshot& other) {
+    for (std::size_t index = 0; index < bucketCount; ++index) {
+        buckets[index] += other.buckets[index];
+    }
+    count += other.count;
+    totalNanoseconds += other.totalNanoseconds;
+}
+
+void LogLatencyHistogram::addTo(LogLatencySnapshot& snapshot) const {
+    for (std::size_t index = 0; index < LogLatencySnapshot::bucketCount; ++index) {
+        std::uint64_t samples = buckets[index].load(std::memory_order_relaxed);
+        snapshot.buckets[index] += samples;
+        snapshot.count += samples;
+    }
+    snapshot.totalNanoseconds += totalNanoseconds.load(std::memory_order_relaxed);
+}
+
+// Metrics snapshots
+std::uint64_t LogMetricsSnapshot::totalRecords() const {
+    std::uint64_t total = 0;
+    for (std::uint64_t levelRecords : records) {
+        total += levelRecords;
+    }
+    return total;
+}
+
+std::uint64_t LogMetricsSnapshot::totalBytes() const {
+    std::uint64_t total = 0;
+    for (const LogSinkMetrics& sink : sinks) {
+        total += sink.bytes;
+    }
+    return total;
+}
+
+std::uint64_t LogMetricsSnapshot::totalFlushes() const {
+    std::uint64_t total = 0;
+    for (const LogSinkMetrics& sink : sinks) {
+        total += sink.flushes;
+    }
+    return total;
+}
+
+void LogMetricsSnapshot::merge(const LogMetricsSnapshot& other) {
+    for (std::size_t index = 0; index < levelCount; ++index) {
+        records[index] += other.records[index];
+    }
+    droppedRecords += other.droppedRecords;
+    rateLimitedRecords += other.rateLimitedRecords;
+    sampledOutRecords += other.sampledOutRecords;
+    collapsedRecords += other.collapsedRecords;
+    queueHighWater = std::max(queueHighWater, other.queueHighWater);
+    queueCapacity = std::max(queueCapacity, other.queueCapacity);
+    enqueueLatency.merge(other.enqueueLatency);
+    formatLatency.merge(other.formatLatency);
+    writeLatency.merge(other.writeLatency);
+}
+
+std::string LogMetricsSnapshot::summary() const {
+    std::string out = "records=" + std::to_string(totalRecords());
+    for (std::size_t index = 0; index < levelCount; ++index) {
+        out += ' ';
+        out += LogStructuredFormat::levelKey(static_cast<LogLevel>(index));
+        out += '=' + std::to_string(records[index]);
+    }
+    out += " dropped=" + std::to_string(droppedRecords);
+    out += " rate_limited=" + std::to_string(rateLimitedRecords);
+    out += " sampled_out=" + std::to_string(sampledOutRecords);
+    out += " collapsed=" + std::to_string(collapsedRecords);
+    out += " queue_high_water=" + std::to_string(queueHighWater);
+    if (!sinks.empty()) {
+        out += " bytes=" + std::to_string(totalBytes());
+        out += " flushes=" + std::to_string(totalFlushes());
+    }
+    appendLatency(out, "enqueue", enqueueLatency);
+    appendLatency(out, "format", formatLatency);
+    appendLatency(out, "write", writeLatency);
+    return out;
+}
+
+// Metrics – registration for the global snapshot
+LogMetrics::LogMetrics() {
+    LogMetricsRegistry& registry = metricsRegistry();
+    std::lock_guard<std::mutex> registryLock(registry.mutex);
+    registry.live.push_back(this);
+}
+
+LogMetrics::~LogMetrics() {
+    LogMetricsSnapshot totals;
+    snapshot(totals);
+
+    LogMetricsRegistry& registry = metricsRegistry();
+    std::lock_guard<std::mutex> registryLock(registry.mutex);
+    registry.live.erase(std::remove(registry.live.begin(), registry.live.end(), this), registry.live.end());
+    registry.retired.merge(totals);
+}
+
+// Threads take shards in turn, so a handful of logging threads never share one
+std::size_t LogMetrics::threadShard() {
+    static std::atomic<std::size_t> nextShard{0};
+    thread_local std::size_t shard = nextShard.fetch_add(1, std::memory_order_relaxed) % shardCount;
+    return shard;
+}
+
+std::uint64_t LogMetrics::sum(std::atomic<std::uint64_t> Shard::* counter) const {
+    std::uint64_t total = 0;
+    for (const Shard& each : shards) {
+        total += (each.*counter).load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+std::uint64_t LogMetrics::getDroppedRecords() const {
+    return sum(&Shard::dropped);
+}
+
+std::uint64_t LogMetrics::getRateLimitedRecords() const {
+    return sum(&Shard::rateLimited);
+}
+
+std::uint64_t LogMetrics::getSampledOutRecords() const {
+    return sum(&Shard::sampledOut);
+}
+
+std::uint64_t LogMetrics::getCollapsedRecords() const {
+    return sum(&Shard::collapsed);
+}
+
+void LogMetrics::snapshot(LogMetricsSnapshot& out) const {
+    for (const Shard& each : shards) {
+        for (std::size_t index = 0; index < LogMetricsSnapshot::levelCount; ++index) {
+            out.records[index] += each.records[index].load(std::memory_order_relaxed);
+        }
+        each.enqueueLatency.addTo(out.enqueueLatency);
+        each.formatLatency.addTo(out.formatLatency);
+    }
+    out.droppedRecords += getDroppedRecords();
+    out.rateLimitedRecords += getRateLimitedRecords();
+    out.sampledOutRecords += getSampledOutRecords();
+    out.collapsedRecords += getCollapsedRecords();
+    out.queueHighWater = std::max(out.queueHighWater, queueHighWater.load(std::memory_order_relaxed));
+    writeLatency.addTo(out.writeLatency);
+}
+
+LogMetricsSnapshot LogMetrics::globalSnapshot() {
+    LogMetricsRegistry& registry = metricsRegistry();
+    std::lock_guard<std::mutex> registryLock(registry.mutex);
+
+    LogMetricsSnapshot totals = registry.retired;
+    for (const LogMetrics* metrics : registry.live) {
+        metrics->snapshot(totals);
+    }
+    return totals;
+}
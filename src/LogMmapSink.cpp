@@ -0,0 +1,219 @@
+#include "LogMmapSink.hpp"
+#include <cstring>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+LogMmapSink::LogMmapSink(LogSinkFormat format)
+: LogSink(format) {
+}
+
+// Destructor (truncates the file to its real size)
+LogMmapSink::~LogMmapSink() {
+    close();
+}
+
+// Open for appending; writing resumes after any existing content
+bool LogMmapSink::open(const std::string& filePath, std::size_t requestedChunkSize) {
+    close();
+
+    #ifdef _WIN32
+    SYSTEM_INFO systemInfo;
+    GetSystemInfo(&systemInfo);
+    granularity = systemInfo.dwAllocationGranularity;
+
+    fileHandle = CreateFileA(filePath.c_str(), GENERIC_READ | GENERIC_WRITE,
+                             FILE_SHARE_READ, nullptr, OPEN_ALWAYS,
+                             FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (fileHandle == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(fileHandle, &fileSize)) {
+        CloseHandle(fileHandle);
+        fileHandle = INVALID_HANDLE_VALUE;
+        return false;
+    }
+    writeOffset = static_cast<std::uint64_t>(fileSize.QuadPart);
+    #else
+    granularity = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+
+    fileDescriptor = ::open(filePath.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fileDescriptor < 0) {
+        return false;
+    }
+
+    struct stat fileStatus;
+    if (fstat(fileDescriptor, &fileStatus) != 0) {
+        ::close(fileDescriptor);
+        fileDescriptor = -1;
+        return false;
+    }
+    writeOffset = static_cast<std::uint64_t>(fileStatus.st_size);
+    #endif
+
+    // Chunks are whole multiples of the mapping granularity
+    chunkSize = (requestedChunkSize + granularity - 1) / granularity * granularity;
+    if (chunkSize == 0) {
+        chunkSize = granularity;
+    }
+
+    if (!mapChunk(writeOffset)) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+// Unmap and cut the preallocated tail off the file
+void LogMmapSink::close() {
+    unmapChunk();
+
+    #ifdef _WIN32
+    if (fileHandle != INVALID_HANDLE_VALUE) {
+        LARGE_INTEGER end;
+        end.QuadPart = static_cast<LONGLONG>(writeOffset);
+        SetFilePointerEx(fileHandle, end, nullptr, FILE_BEGIN);
+        SetEndOfFile(fileHandle);
+        CloseHandle(fileHandle);
+        fileHandle = INVALID_HANDLE_VALUE;
+    }
+    #else
+    if (fileDescriptor >= 0) {
+        if (ftruncate(fileDescriptor, static_cast<off_t>(writeOffset)) != 0) {
+            // Nothing sensible to do: the file keeps its zero-filled tail
+        }
+        ::close(fileDescriptor);
+        fileDescriptor = -1;
+    }
+    #endif
+
+    writeOffset = 0;
+}
+
+bool LogMmapSink::isOpen() const {
+    return mappedView != nullptr;
+}
+
+// Writing
+void LogMmapSink::writeLine(const char* text, std::size_t length, LogLevel) {
+    writeRaw(text, length);
+    writeRaw("\n", 1);
+}
+
+void LogMmapSink::writeRaw(const char* text, std::size_t length) {
+    while (length > 0 && mappedView != nullptr) {
+        std::size_t viewPosition = static_cast<std::size_t>(writeOffset - viewOffset);
+        std::size_t room = viewSize - viewPosition;
+
+        if (room == 0) {
+            // Chunk full: extend the file and map the next chunk
+            if (!mapChunk(writeOffset)) {
+                return;
+            }
+            continue;
+        }
+
+        std::size_t piece = length < room ? length : room;
+        std::memcpy(mappedView + viewPosition, text, piece);
+        writeOffset += piece;
+        text += piece;
+        length -= piece;
+    }
+}
+
+void LogMmapSink::write(const LogSinkBatch& batch) {
+    if (acceptsAll(batch)) {
+        writeRaw(batch.data(), batch.size());
+        return;
+    }
+
+    for (const LogSinkEntry& entry : batch.entries()) {
+        if (accepts(entry.level)) {
+            writeRaw(batch.data() + entry.offset, entry.length);
+        }
+    }
+}
+
+void LogMmapSink::crashWrite(const char* record, std::size_t length) {
+    writeRaw(record, length);
+}
+
+void LogMmapSink::flush() {
+    if (mappedView == nullptr) {
+        return;
+    }
+
+    #ifdef _WIN32
+    FlushViewOfFile(mappedView, 0);
+    #else
+    msync(mappedView, viewSize, MS_ASYNC);
+    #endif
+}
+
+std::uint64_t LogMmapSink::getMappedBytes() const {
+    return writeOffset;
+}
+
+// Map the chunk that contains offset, growing the file to cover it
+bool LogMmapSink::mapChunk(std::uint64_t offset) {
+    unmapChunk();
+
+    std::uint64_t start = offset / granularity * granularity;
+    std::uint64_t end = start + chunkSize;
+
+    #ifdef _WIN32
+    mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READWRITE,
+                                       static_cast<DWORD>(end >> 32),
+                                       static_cast<DWORD>(end & 0xFFFFFFFFu), nullptr);
+    if (mappingHandle == nullptr) {
+        return false;
+    }
+
+    void* view = MapViewOfFile(mappingHandle, FILE_MAP_WRITE,
+                               static_cast<DWORD>(start >> 32),
+                               static_cast<DWORD>(start & 0xFFFFFFFFu), chunkSize);
+    if (view == nullptr) {
+        CloseHandle(mappingHandle);
+        mappingHandle = nullptr;
+        return false;
+    }
+    #else
+    if (ftruncate(fileDescriptor, static_cast<off_t>(end)) != 0) {
+        return false;
+    }
+
+    void* view = mmap(nullptr, chunkSize, PROT_READ | PROT_WRITE, MAP_SHARED,
+                      fileDescriptor, static_cast<off_t>(start));
+    if (view == MAP_FAILED) {
+        return false;
+    }
+    #endif
+
+    mappedView = static_cast<char*>(view);
+    viewOffset = start;
+    viewSize = chunkSize;
+    return true;
+}
+
+void LogMmapSink::unmapChunk() {
+    if (mappedView == nullptr) {
+        return;
+    }
+
+    #ifdef _WIN32
+    UnmapViewOfFile(mappedView);
+    CloseHandle(mappingHandle);
+    mappingHandle = nullptr;
+    #else
+    munmap(mappedView, viewSize);
+    #endif
+
+    mappedView = nullptr;
+    viewSize = 0;
+}
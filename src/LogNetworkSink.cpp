@@ -0,0 +1,569 @@
+#include "LogNetworkSink.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <ctime>
+
+#ifdef _WIN32
+    #include <winsock2.h>
+    #include <ws2tcpip.h>
+    #include <process.h>
+#else
+    #include <cerrno>
+    #include <fcntl.h>
+    #include <netdb.h>
+    #include <poll.h>
+    #include <sys/socket.h>
+    #include <sys/time.h>
+    #include <sys/types.h>
+    #include <sys/uio.h>
+    #include <unistd.h>
+#endif
+
+namespace {
+
+#ifdef _WIN32
+    constexpr int sendFlags = 0;
+#elif defined(MSG_NOSIGNAL)
+    constexpr int sendFlags = MSG_NOSIGNAL; // a dropped connection must not raise SIGPIPE
+#else
+    constexpr int sendFlags = 0;
+#endif
+
+// Syslog severity for each level (RFC 5424 section 6.2.1)
+int syslogSeverity(LogLevel level) {
+    switch (level) {
+    case LogLevel::Message: return 6; // informational
+    case LogLevel::Success: return 5; // notice
+    case LogLevel::Warning: return 4; // warning
+    default:                return 3; // error
+    }
+}
+
+// Header fields may not contain spaces; an empty one is the nil value "-"
+std::string syslogField(std::string value, std::size_t maxLength) {
+    if (value.empty()) {
+        return "-";
+    }
+    value.resize(std::min(value.size(), maxLength));
+    for (char& character : value) {
+        if (character <= ' ' || character > '~') {
+            character = '_';
+        }
+    }
+    return value;
+}
+
+std::string localHostname() {
+    char name[256] = {};
+    if (gethostname(name, sizeof(name) - 1) != 0) {
+        return std::string();
+    }
+    return name;
+}
+
+int processId() {
+#ifdef _WIN32
+    return _getpid();
+#else
+    return static_cast<int>(getpid());
+#endif
+}
+
+void writeDigits(char* out, unsigned int value, int width) {
+    for (int i = width - 1; i >= 0; --i) {
+        out[i] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    }
+}
+
+// Connect without blocking for longer than the time left; the socket is
+// left in blocking mode either way
+#ifdef _WIN32
+bool connectWithin(SOCKET handle, const sockaddr* address, int length, std::chrono::milliseconds timeLeft) {
+    u_long nonBlocking = 1;
+    if (ioctlsocket(handle, FIONBIO, &nonBlocking) != 0) {
+        return false;
+    }
+    bool opened = connect(handle, address, length) == 0;
+    if (!opened && WSAGetLastError() == WSAEWOULDBLOCK) {
+        fd_set writable;
+        fd_set failed;
+        FD_ZERO(&writable);
+        FD_ZERO(&failed);
+        FD_SET(handle, &writable);
+        FD_SET(handle, &failed);
+        timeval limit{static_cast<long>(timeLeft.count() / 1000), static_cast<long>(timeLeft.count() % 1000 * 1000)};
+        int error = 0;
+        int errorLength = sizeof(error);
+        opened = select(0, nullptr, &writable, &failed, &limit) > 0 && FD_ISSET(handle, &writable) &&
+                 getsockopt(handle, SOL_SOCKET, SO_ERROR, reinterpret_cast<char*>(&error), &errorLength) == 0 &&
+                 error == 0;
+    }
+    nonBlocking = 0;
+    ioctlsocket(handle, FIONBIO, &nonBlocking);
+    return opened;
+}
+#else
+bool connectWithin(int handle, const sockaddr* address, socklen_t length, std::chrono::milliseconds timeLeft) {
+    int flags = fcntl(handle, F_GETFL, 0);
+    if (flags < 0 || fcntl(handle, F_SETFL, flags | O_NONBLOCK) != 0) {
+        return false;
+    }
+    bool opened = connect(handle, address, length) == 0;
+    if (!opened && errno == EINPROGRESS) {
+        pollfd waiting{handle, POLLOUT, 0};
+        int ready;
+        while ((ready = poll(&waiting, 1, static_cast<int>(timeLeft.count()))) < 0 && errno == EINTR) {
+        }
+        int error = 0;
+        socklen_t errorLength = sizeof(error);
+        opened = ready > 0 && getsockopt(handle, SOL_SOCKET, SO_ERROR, &error, &errorLength) == 0 && error == 0;
+    }
+    fcntl(handle, F_SETFL, flags);
+    return opened;
+}
+#endif
+
+// "YYYY-MM-DDTHH:MM:SS.ffffffZ"
+constexpr std::size_t syslogTimestampLength = 27;
+
+}
+
+// Constructor – the sender thread starts connecting at once
+LogNetworkSink::LogNetworkSink(const LogNetworkOptions& networkOptions, LogSinkFormat format)
+: LogSink(format),
+options(networkOptions) {
+    if (format == LogSinkFormat::Binary) {
+        options.protocol = LogNetworkProtocol::Stream;
+    }
+    datagrams = options.protocol == LogNetworkProtocol::SyslogUdp;
+
+#ifdef _WIN32
+    // Winsock is reference counted; the destructor releases this reference
+    WSADATA data;
+    WSAStartup(MAKEWORD(2, 2), &data);
+#endif
+
+    std::string hostname = options.hostname.empty() ? localHostname() : options.hostname;
+    syslogFields = " " + syslogField(hostname, 255) + " " + syslogField(options.appName, 48) + " " +
+                   std::to_string(processId()) + " - - ";
+
+    spill.reserve(std::min<std::size_t>(options.spillBytes, 64 * 1024));
+    senderThread = std::thread(&LogNetworkSink::senderLoop, this);
+}
+
+// Destructor – sends what it can (if connected), then closes
+LogNetworkSink::~LogNetworkSink() {
+    {
+        std::lock_guard<std::mutex> lock(spillMutex);
+        stopSender = true;
+    }
+    spillWake.notify_all();
+    senderThread.join();
+
+#ifdef _WIN32
+    WSACleanup();
+#endif
+}
+
+// Frame every accepted record of the batch into the spill buffer
+void LogNetworkSink::write(const LogSinkBatch& batch) {
+    bool everyEntry = acceptsAll(batch);
+    bool framed = false;
+
+    {
+        std::lock_guard<std::mutex> lock(spillMutex);
+        for (const LogSinkEntry& entry : batch.entries()) {
+            if (!everyEntry && !accepts(entry.level)) {
+                continue;
+            }
+
+            const char* record = batch.data() + entry.offset;
+            if (options.protocol == LogNetworkProtocol::Stream) {
+                appendStream(record, entry.length);
+            } else if (batch.format() == LogSinkFormat::Text) {
+                appendSyslog(entry, record + entry.messageOffset, entry.length - 1 - entry.messageOffset);
+            } else {
+                appendSyslog(entry, record, entry.length - 1);
+            }
+            framed = true;
+        }
+    }
+
+    if (framed) {
+        spillWake.notify_one();
+    }
+}
+
+void LogNetworkSink::flush() {
+    std::unique_lock<std::mutex> lock(spillMutex);
+    spillWake.notify_one();
+    spillSent.wait_for(lock, options.flushTimeout, [this]() {
+        return spill.empty() && !sending;
+    });
+}
+
+bool LogNetworkSink::isConnected() const {
+    return connected.load(std::memory_order_relaxed);
+}
+
+std::uint64_t LogNetworkSink::getSentRecords() const {
+    return sentRecords.load(std::memory_order_relaxed);
+}
+
+std::uint64_t LogNetworkSink::getDroppedRecords() const {
+    return droppedRecords.load(std::memory_order_relaxed);
+}
+
+std::size_t LogNetworkSink::getSpilledBytes() const {
+    std::lock_guard<std::mutex> lock(spillMutex);
+    return spill.size();
+}
+
+// Framing – "<PRI>1 TIMESTAMP HOSTNAME APP-NAME PROCID - - MSG"
+void LogNetworkSink::appendSyslog(const LogSinkEntry& entry, const char* message, std::size_t messageLength) {
+    char header[8 + syslogTimestampLength];
+    int priority = options.facility * 8 + syslogSeverity(entry.level);
+
+    std::size_t length = 0;
+    header[length++] = '<';
+    if (priority >= 100) {
+        header[length++] = static_cast<char>('0' + priority / 100);
+    }
+    if (priority >= 10) {
+        header[length++] = static_cast<char>('0' + priority / 10 % 10);
+    }
+    header[length++] = static_cast<char>('0' + priority % 10);
+    header[length++] = '>';
+    header[length++] = '1';
+    header[length++] = ' ';
+    formatSyslogTimestamp(entry.timestamp, header + length);
+    length += syslogTimestampLength;
+
+    if (!beginFrame(header, length, syslogFields.size() + messageLength)) {
+        return;
+    }
+    spill.append(syslogFields);
+    spill.append(message, messageLength);
+    spillFrameEnds.push_back(spill.size());
+}
+
+// Framing – length-prefixed record
+void LogNetworkSink::appendStream(const char* record, std::size_t length) {
+    if (!beginFrame(nullptr, 0, length)) {
+        return;
+    }
+    spill.append(record, length);
+    spillFrameEnds.push_back(spill.size());
+}
+
+// Start a frame: the length prefix the protocol needs, then the header. The
+// caller appends bodyLength bytes and records the frame end; false (with the
+// record counted as dropped) if the frame would overflow the spill buffer.
+bool LogNetworkSink::beginFrame(const char* header, std::size_t headerLength, std::size_t bodyLength) {
+    char prefix[24];
+    std::size_t prefixLength = 0;
+    std::size_t messageLength = headerLength + bodyLength;
+
+    if (options.protocol == LogNetworkProtocol::Stream) {
+        std::uint32_t length = static_cast<std::uint32_t>(messageLength);
+        for (int i = 0; i < 4; ++i) {
+            prefix[prefixLength++] = static_cast<char>((length >> (8 * i)) & 0xFF);
+        }
+    } else if (options.protocol == LogNetworkProtocol::SyslogTcp) {
+        // Octet counting: "LENGTH SP MESSAGE"
+        char* end = std::to_chars(prefix, prefix + sizeof(prefix) - 1, messageLength).ptr;
+        prefixLength = static_cast<std::size_t>(end - prefix);
+        prefix[prefixLength++] = ' ';
+    }
+
+    if (spill.size() + prefixLength + messageLength > options.spillBytes) {
+        droppedRecords.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    spill.append(prefix, prefixLength);
+    if (headerLength > 0) {
+        spill.append(header, headerLength);
+    }
+    return true;
+}
+
+// UTC with microseconds; the date and time text is recomputed once a second
+void LogNetworkSink::formatSyslogTimestamp(std::chrono::system_clock::time_point timestamp, char* out) {
+    std::int64_t microseconds = std::chrono::duration_cast<std::chrono::microseconds>(
+        timestamp.time_since_epoch()).count();
+    std::int64_t second = microseconds / 1000000;
+    std::int64_t fraction = microseconds % 1000000;
+    if (fraction < 0) {
+        second -= 1;
+        fraction += 1000000;
+    }
+
+    if (second != cachedSecond) {
+        std::time_t time = static_cast<std::time_t>(second);
+        std::tm utc{};
+#ifdef _WIN32
+        gmtime_s(&utc, &time);
+#else
+        gmtime_r(&time, &utc);
+#endif
+        writeDigits(cachedSecondText, static_cast<unsigned int>(utc.tm_year + 1900), 4);
+        cachedSecondText[4] = '-';
+        writeDigits(cachedSecondText + 5, static_cast<unsigned int>(utc.tm_mon + 1), 2);
+        cachedSecondText[7] = '-';
+        writeDigits(cachedSecondText + 8, static_cast<unsigned int>(utc.tm_mday), 2);
+        cachedSecondText[10] = 'T';
+        writeDigits(cachedSecondText + 11, static_cast<unsigned int>(utc.tm_hour), 2);
+        cachedSecondText[13] = ':';
+        writeDigits(cachedSecondText + 14, static_cast<unsigned int>(utc.tm_min), 2);
+        cachedSecondText[16] = ':';
+        writeDigits(cachedSecondText + 17, static_cast<unsigned int>(utc.tm_sec), 2);
+        cachedSecondText[19] = '.';
+        cachedSecond = second;
+    }
+
+    std::memcpy(out, cachedSecondText, 20);
+    writeDigits(out + 20, static_cast<unsigned int>(fraction), 6);
+    out[26] = 'Z';
+}
+
+// Sender thread – connect, then ship whatever has been spilled, in bulk
+void LogNetworkSink::senderLoop() {
+    std::unique_lock<std::mutex> lock(spillMutex);
+
+    while (true) {
+        if (stopSender && (spill.empty() || !connected)) {
+            break;
+        }
+
+        if (!connected) {
+            lock.unlock();
+            bool opened = connectSocket();
+            lock.lock();
+            if (!opened) {
+                spillWake.wait_for(lock, options.reconnectDelay, [this]() { return stopSender; });
+            }
+            continue;
+        }
+
+        spillWake.wait(lock, [this]() { return stopSender || !spill.empty(); });
+        if (spill.empty()) {
+            continue;
+        }
+
+        // Swap buffers so writers keep spilling while this batch is sent
+        outgoing.swap(spill);
+        outgoingFrameEnds.swap(spillFrameEnds);
+        spill.clear();
+        spillFrameEnds.clear();
+        sending = true;
+        lock.unlock();
+
+        std::size_t sentFrames = sendFrames(outgoing, outgoingFrameEnds);
+        sentRecords.fetch_add(sentFrames, std::memory_order_relaxed);
+        if (sentFrames > 0) {
+            countFlush();
+        }
+        bool failed = sentFrames < outgoingFrameEnds.size();
+        if (failed) {
+            closeSocket();
+        }
+
+        lock.lock();
+        if (failed) {
+            requeueUnsent(sentFrames);
+        }
+        outgoing.clear();
+        outgoingFrameEnds.clear();
+        sending = false;
+        spillSent.notify_all();
+    }
+
+    // Whatever is still spilled has nowhere to go
+    droppedRecords.fetch_add(spillFrameEnds.size(), std::memory_order_relaxed);
+    spill.clear();
+    spillFrameEnds.clear();
+    spillSent.notify_all();
+    lock.unlock();
+    closeSocket();
+}
+
+// Put the frames a failed send did not finish back in front of newer ones,
+// dropping the newest if they no longer fit (the caller holds spillMutex)
+void LogNetworkSink::requeueUnsent(std::size_t sentFrames) {
+    std::size_t unsentStart = sentFrames > 0 ? outgoingFrameEnds[sentFrames - 1] : 0;
+    std::string requeued(outgoing, unsentStart);
+    std::vector<std::size_t> requeuedEnds;
+
+    for (std::size_t i = sentFrames; i < outgoingFrameEnds.size(); ++i) {
+        requeuedEnds.push_back(outgoingFrameEnds[i] - unsentStart);
+    }
+    std::size_t spillStart = requeued.size();
+    requeued.append(spill);
+    for (std::size_t end : spillFrameEnds) {
+        requeuedEnds.push_back(spillStart + end);
+    }
+
+    while (!requeuedEnds.empty() && requeuedEnds.back() > options.spillBytes) {
+        requeuedEnds.pop_back();
+        droppedRecords.fetch_add(1, std::memory_order_relaxed);
+    }
+    requeued.resize(requeuedEnds.empty() ? 0 : requeuedEnds.back());
+
+    spill.swap(requeued);
+    spillFrameEnds.swap(requeuedEnds);
+}
+
+// Sender thread – resolve and connect (UDP "connects" to fix the destination)
+bool LogNetworkSink::connectSocket() {
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = datagrams ? SOCK_DGRAM : SOCK_STREAM;
+
+    addrinfo* addresses = nullptr;
+    std::string port = std::to_string(options.port);
+    if (getaddrinfo(options.host.c_str(), port.c_str(), &hints, &addresses) != 0) {
+        return false;
+    }
+
+    // Every address shares one connectTimeout
+    auto deadline = std::chrono::steady_clock::now() + options.connectTimeout;
+    for (addrinfo* address = addresses; address != nullptr; address = address->ai_next) {
+        auto timeLeft =
+            std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+        if (timeLeft.count() <= 0) {
+            break;
+        }
+#ifdef _WIN32
+        SOCKET handle = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+        if (handle == INVALID_SOCKET) {
+            continue;
+        }
+        if (!connectWithin(handle, address->ai_addr, static_cast<int>(address->ai_addrlen), timeLeft)) {
+            closesocket(handle);
+            continue;
+        }
+        // A collector that stops reading fails the send instead of stalling the sender
+        DWORD timeout = 5000;
+        setsockopt(handle, SOL_SOCKET, SO_SNDTIMEO, reinterpret_cast<const char*>(&timeout), sizeof(timeout));
+#else
+        int handle = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+        if (handle < 0) {
+            continue;
+        }
+        if (!connectWithin(handle, address->ai_addr, address->ai_addrlen, timeLeft)) {
+            ::close(handle);
+            continue;
+        }
+        timeval timeout{5, 0};
+        setsockopt(handle, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+    #ifdef SO_NOSIGPIPE
+        int noSignal = 1;
+        setsockopt(handle, SOL_SOCKET, SO_NOSIGPIPE, &noSignal, sizeof(noSignal));
+    #endif
+#endif
+        socketHandle = static_cast<SocketHandle>(handle);
+        break;
+    }
+    freeaddrinfo(addresses);
+
+    if (socketHandle == -1) {
+        return false;
+    }
+
+    if (!options.streamPreamble.empty() && !datagrams) {
+        std::vector<std::size_t> preambleEnd{options.streamPreamble.size()};
+        if (sendFrames(options.streamPreamble, preambleEnd) != 1) {
+            closeSocket();
+            return false;
+        }
+    }
+
+    connected.store(true, std::memory_order_relaxed);
+    return true;
+}
+
+void LogNetworkSink::closeSocket() {
+    connected.store(false, std::memory_order_relaxed);
+    if (socketHandle == -1) {
+        return;
+    }
+#ifdef _WIN32
+    closesocket(static_cast<SOCKET>(socketHandle));
+#else
+    ::close(static_cast<int>(socketHandle));
+#endif
+    socketHandle = -1;
+}
+
+// Send frames (one datagram each, or back to back on a stream); returns the
+// number sent completely before the first failure
+std::size_t LogNetworkSink::sendFrames(const std::string& data, const std::vector<std::size_t>& frameEnds) {
+#ifdef _WIN32
+    SOCKET handle = static_cast<SOCKET>(socketHandle);
+#else
+    int handle = static_cast<int>(socketHandle);
+#endif
+
+    if (datagrams) {
+        std::size_t frame = 0;
+#if defined(__linux__)
+        // Up to 64 datagrams per system call
+        constexpr std::size_t maxMessages = 64;
+        mmsghdr messages[maxMessages];
+        iovec vectors[maxMessages];
+
+        while (frame < frameEnds.size()) {
+            std::size_t count = std::min(maxMessages, frameEnds.size() - frame);
+            for (std::size_t i = 0; i < count; ++i) {
+                std::size_t start = frame + i > 0 ? frameEnds[frame + i - 1] : 0;
+                vectors[i].iov_base = const_cast<char*>(data.data() + start);
+                vectors[i].iov_len = frameEnds[frame + i] - start;
+                std::memset(&messages[i], 0, sizeof(messages[i]));
+                messages[i].msg_hdr.msg_iov = &vectors[i];
+                messages[i].msg_hdr.msg_iovlen = 1;
+            }
+
+            int sent = sendmmsg(handle, messages, static_cast<unsigned int>(count), sendFlags);
+            if (sent <= 0) {
+                if (sent < 0 && errno == EINTR) {
+                    continue;
+                }
+                break;
+            }
+            frame += static_cast<std::size_t>(sent);
+        }
+#else
+        for (; frame < frameEnds.size(); ++frame) {
+            std::size_t start = frame > 0 ? frameEnds[frame - 1] : 0;
+            int length = static_cast<int>(frameEnds[frame] - start);
+            if (send(handle, data.data() + start, length, sendFlags) != length) {
+                break;
+            }
+        }
+#endif
+        return frame;
+    }
+
+    // Stream: one send for everything, continued after partial writes
+    std::size_t offset = 0;
+    while (offset < data.size()) {
+#ifdef _WIN32
+        int sent = send(handle, data.data() + offset, static_cast<int>(data.size() - offset), sendFlags);
+#else
+        ssize_t sent = send(handle, data.data() + offset, data.size() - offset, sendFlags);
+        if (sent < 0 && errno == EINTR) {
+            continue;
+        }
+#endif
+        if (sent <= 0) {
+            break;
+        }
+        offset += static_cast<std::size_t>(sent);
+    }
+
+    return static_cast<std::size_t>(std::upper_bound(frameEnds.begin(), frameEnds.end(), offset) -
+                                    frameEnds.begin());
+}
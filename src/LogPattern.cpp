@@ -0,0 +1,154 @@
+#include "LogPattern.hpp"
+#include <cstring>
+
+#ifdef _WIN32
+    #include <windows.h>
+#elif defined(__linux__)
+    #include <sys/syscall.h>
+    #include <unistd.h>
+#elif defined(__APPLE__)
+    #include <pthread.h>
+#else
+    #include <functional>
+    #include <thread>
+#endif
+
+namespace {
+
+std::uint32_t lookUpThreadId() {
+#ifdef _WIN32
+    return static_cast<std::uint32_t>(GetCurrentThreadId());
+#elif defined(__linux__)
+    return static_cast<std::uint32_t>(::syscall(SYS_gettid));
+#elif defined(__APPLE__)
+    std::uint64_t id = 0;
+    pthread_threadid_np(nullptr, &id);
+    return static_cast<std::uint32_t>(id);
+#else
+    return static_cast<std::uint32_t>(std::hash<std::thread::id>()(std::this_thread::get_id()));
+#endif
+}
+
+}
+
+std::uint32_t logThreadId() {
+    thread_local std::uint32_t id = lookUpThreadId();
+    return id;
+}
+
+// Fields – the ones that change from line to line
+void LogLayout::appendTime(LogLineBuffer& out, const LogLineContext& line, LogTimestampCache& timestampCache) {
+    char timestampText[logTimestampLength];
+    timestampCache.format(line.timestamp, timestampText);
+    out.append(timestampText, logTimestampLength);
+}
+
+void LogLayout::appendUtcTime(LogLineBuffer& out, const LogLineContext& line, LogTimestampCache& timestampCache) {
+    char timestampText[logUtcTimestampLength];
+    timestampCache.formatUtc(line.timestamp, timestampText);
+    out.append(timestampText, logUtcTimestampLength);
+}
+
+static void appendNumber(LogLineBuffer& out, std::uint32_t value) {
+    char digits[10];
+    std::size_t first = sizeof(digits);
+    do {
+        digits[--first] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+    out.append(digits + first, sizeof(digits) - first);
+}
+
+void LogLayout::appendThread(LogLineBuffer& out, const LogLineContext& line) {
+    appendNumber(out, line.thread);
+}
+
+// Resolved from the call-site table; nothing for a record without a site
+void LogLayout::appendCallSite(LogPatternField field, LogLineBuffer& out, const LogLineContext& line) {
+    const LogCallSite* site = LogCallSites::find(line.callSite);
+    if (site == nullptr) {
+        return;
+    }
+    if (field == LogPatternField::File) {
+        out.append(site->file, std::strlen(site->file));
+    } else if (field == LogPatternField::Line) {
+        appendNumber(out, site->line);
+    } else {
+        out.append(site->function, std::strlen(site->function));
+    }
+}
+
+void LogLayout::appendField(LogPatternField field, LogLineBuffer& out, const LogLineContext& line,
+                            LogTimestampCache& timestampCache) {
+    switch (field) {
+    case LogPatternField::Time:
+        appendTime(out, line, timestampCache);
+        break;
+    case LogPatternField::UtcTime:
+        appendUtcTime(out, line, timestampCache);
+        break;
+    case LogPatternField::Level:
+        appendLevel(out, line);
+        break;
+    case LogPatternField::Thread:
+        appendThread(out, line);
+        break;
+    case LogPatternField::File:
+    case LogPatternField::Line:
+    case LogPatternField::Function:
+        appendCallSite(field, out, line);
+        break;
+    default:
+        break;
+    }
+}
+
+// Pre-render the literals and the padded name between the changing fields
+void LogLayout::renderRuns(std::string_view pattern, const LogPatternToken* tokens, std::size_t tokenCount,
+                           const std::string& loggerName, std::string* runs) {
+    std::size_t run = 0;
+    for (std::size_t i = 0; i < tokenCount; ++i) {
+        const LogPatternToken& token = tokens[i];
+        if (token.field == LogPatternField::Literal) {
+            runs[run].append(pattern.data() + token.offset, token.length);
+        } else if (token.field == LogPatternField::Name) {
+            runs[run] += loggerName;
+            if (loggerName.size() < LogTextLayout::loggerNameWidth) {
+                runs[run].append(LogTextLayout::loggerNameWidth - loggerName.size(), '.');
+            }
+        } else {
+            ++run;
+        }
+    }
+}
+
+// Runtime patterns
+LogRuntimeLayout::LogRuntimeLayout(const std::string& pattern, const std::string& loggerName) {
+    std::size_t tokenCount = LogPatternParser::count(pattern);
+    if (tokenCount == LogPatternParser::invalid) {
+        runs.resize(1);
+        return;
+    }
+
+    std::vector<LogPatternToken> tokens(tokenCount);
+    LogPatternParser::parse(pattern, tokens.data(), tokens.size());
+    for (const LogPatternToken& token : tokens) {
+        if (!LogPatternParser::isStatic(token.field)) {
+            fields.push_back(token.field);
+        }
+    }
+    runs.resize(fields.size() + 1);
+    renderRuns(pattern, tokens.data(), tokens.size(), loggerName, runs.data());
+    valid = true;
+}
+
+void LogRuntimeLayout::formatPrefix(LogLineBuffer& out, const LogLineContext& line,
+                                    LogTimestampCache& timestampCache) const {
+    out.clear();
+    for (std::size_t i = 0; i < fields.size(); ++i) {
+        out.append(runs[i]);
+        appendField(fields[i], out, line, timestampCache);
+    }
+    out.append(runs.back());
+    out.markMessageStart();
+}
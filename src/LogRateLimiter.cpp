@@ -0,0 +1,18 @@
+#include "LogRateLimiter.hpp"
+#include <algorithm>
+
+namespace {
+
+// Slowest rate: one record per ~31 years, which also stands for a rate of zero
+constexpr double maxInterval = 1e18;
+// Keeps every "next allowed time" well inside std::int64_t
+constexpr double maxTolerance = 4e18;
+
+}
+
+LogRateLimiter::LogRateLimiter(double recordsPerSecond, std::uint32_t burst) {
+    double nanoseconds = recordsPerSecond > 0 ? std::min(1e9 / recordsPerSecond, maxInterval) : maxInterval;
+    interval = static_cast<std::int64_t>(nanoseconds);
+    double span = nanoseconds * static_cast<double>(burst > 0 ? burst - 1 : 0);
+    tolerance = static_cast<std::int64_t>(std::min(span, maxTolerance));
+}
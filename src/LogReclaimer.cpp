@@ -0,0 +1,98 @@
+#include "LogReclaimer.hpp"
+#include <algorithm>
+#include <atomic>
+
+namespace {
+
+// One per reading thread; never freed, so a retire() can walk the list while
+// threads come and go (an exited thread's slot is reused by the next one)
+struct alignas(64) ReaderSlot {
+    std::atomic<std::uint64_t> epoch{0}; // pinned epoch, 0 when not reading
+    std::atomic<bool> inUse{true};
+    std::uint32_t depth = 0;             // nested guards (owner thread only)
+    ReaderSlot* next = nullptr;
+};
+
+std::atomic<ReaderSlot*> readerSlots{nullptr};
+std::atomic<std::uint64_t> currentEpoch{1};
+
+thread_local ReaderSlot* threadSlot = nullptr;
+
+// Gives the slot back when the thread exits
+struct SlotRelease {
+    ~SlotRelease() {
+        if (threadSlot != nullptr) {
+            threadSlot->epoch.store(0, std::memory_order_release);
+            threadSlot->inUse.store(false, std::memory_order_release);
+            threadSlot = nullptr;
+        }
+    }
+};
+
+ReaderSlot* claimSlot() {
+    static thread_local SlotRelease release;
+    (void)release;
+
+    for (ReaderSlot* slot = readerSlots.load(std::memory_order_acquire); slot != nullptr; slot = slot->next) {
+        bool free = false;
+        if (!slot->inUse.load(std::memory_order_relaxed) &&
+            slot->inUse.compare_exchange_strong(free, true, std::memory_order_acquire)) {
+            threadSlot = slot;
+            return slot;
+        }
+    }
+
+    ReaderSlot* slot = new ReaderSlot();
+    slot->next = readerSlots.load(std::memory_order_relaxed);
+    while (!readerSlots.compare_exchange_weak(slot->next, slot, std::memory_order_release,
+                                              std::memory_order_relaxed)) {
+    }
+    threadSlot = slot;
+    return slot;
+}
+
+}
+
+void LogReclaimer::enter() {
+    ReaderSlot* slot = threadSlot != nullptr ? threadSlot : claimSlot();
+    if (slot->depth++ == 0) {
+        slot->epoch.store(currentEpoch.load(std::memory_order_acquire), std::memory_order_seq_cst);
+    }
+}
+
+void LogReclaimer::leave() {
+    ReaderSlot* slot = threadSlot;
+    if (--slot->depth == 0) {
+        slot->epoch.store(0, std::memory_order_release);
+    }
+}
+
+void LogReclaimer::retire(std::shared_ptr<const void> object) {
+    std::lock_guard<std::mutex> retireLock(retireMutex);
+    std::uint64_t epoch = currentEpoch.fetch_add(1, std::memory_order_seq_cst);
+    if (object) {
+        retired.push_back(Retired{std::move(object), epoch});
+    }
+    freeUnpinned();
+}
+
+std::size_t LogReclaimer::getRetiredCount() const {
+    std::lock_guard<std::mutex> retireLock(retireMutex);
+    freeUnpinned();
+    return retired.size();
+}
+
+// A reader pinned at a later epoch than an object's loaded its pointers after
+// the swap (the caller holds retireMutex)
+void LogReclaimer::freeUnpinned() const {
+    std::uint64_t oldestPinned = UINT64_MAX;
+    for (ReaderSlot* slot = readerSlots.load(std::memory_order_acquire); slot != nullptr; slot = slot->next) {
+        std::uint64_t pinned = slot->epoch.load(std::memory_order_seq_cst);
+        if (pinned != 0 && pinned < oldestPinned) {
+            oldestPinned = pinned;
+        }
+    }
+    retired.erase(std::remove_if(retired.begin(), retired.end(),
+                                 [oldestPinned](const Retired& entry) { return entry.epoch < oldestPinned; }),
+                  retired.end());
+}
@@ -0,0 +1,156 @@
+#include "LogRegistry.hpp"
+#include "LogTimestamp.hpp"
+#include <filesystem>
+
+// "=== <text>: <timestamp> ===" banner line for shared files
+static std::string bannerLine(const char* text) {
+    LogTimestampCache timestampCache;
+    char timestamp[logTimestampLength];
+    timestampCache.format(std::chrono::system_clock::now(), timestamp);
+    return std::string("=== ") + text + ": " + std::string(timestamp, logTimestampLength) + " ===\n";
+}
+
+// One key per file, however the path was spelled
+static std::string filePathKey(const std::string& filePath) {
+    std::error_code error;
+    std::filesystem::path key = std::filesystem::weakly_canonical(std::filesystem::absolute(filePath, error), error);
+    return error ? filePath : key.string();
+}
+
+LogRegistry& LogRegistry::instance() {
+    static LogRegistry registry;
+    return registry;
+}
+
+// Loggers
+std::shared_ptr<LoggerHandler> LogRegistry::getLogger(const std::string& name) {
+    std::lock_guard<std::mutex> registryLock(registryMutex);
+
+    auto found = loggers.find(name);
+    if (found != loggers.end()) {
+        return found->second;
+    }
+
+    auto logger = std::make_shared<LoggerHandler>(name, defaultSinksLocked());
+    loggers.emplace(name, logger);
+    return logger;
+}
+
+std::shared_ptr<LoggerHandler> LogRegistry::createLogger(const std::string& name) {
+    std::lock_guard<std::mutex> registryLock(registryMutex);
+    return std::make_shared<LoggerHandler>(name, defaultSinksLocked());
+}
+
+void LogRegistry::dropLogger(const std::string& name) {
+    std::shared_ptr<LoggerHandler> dropped;
+    {
+        std::lock_guard<std::mutex> registryLock(registryMutex);
+        auto found = loggers.find(name);
+        if (found == loggers.end()) {
+            return;
+        }
+        dropped = std::move(found->second);
+        loggers.erase(found);
+    }
+    // Destroyed (and drained) outside the registry lock
+}
+
+void LogRegistry::dropAllLoggers() {
+    std::unordered_map<std::string, std::shared_ptr<LoggerHandler>> dropped;
+    {
+        std::lock_guard<std::mutex> registryLock(registryMutex);
+        dropped.swap(loggers);
+    }
+}
+
+bool LogRegistry::applyConfig(const LogConfigFile& file) {
+    std::vector<std::shared_ptr<LoggerHandler>> targets;
+    {
+        std::lock_guard<std::mutex> registryLock(registryMutex);
+        for (const auto& entry : loggers) {
+            targets.push_back(entry.second);
+        }
+    }
+
+    // Applied outside the registry lock (a new file may be opened)
+    bool applied = file.isValid();
+    for (const auto& logger : targets) {
+        applied = logger->applyConfig(file) && applied;
+    }
+    return applied;
+}
+
+// Shared file sinks
+std::shared_ptr<LogSink> LogRegistry::getFileSink(const std::string& filePath, const LogFlushPolicy& flushPolicy,
+                                                  const LogRotationPolicy& rotationPolicy,
+                                                  const LogCompressionPolicy& compressionPolicy) {
+    std::lock_guard<std::mutex> registryLock(registryMutex);
+
+    std::string key = filePathKey(filePath);
+    auto found = fileSinks.find(key);
+    if (found != fileSinks.end()) {
+        if (auto existing = found->second.lock()) {
+            return existing;
+        }
+    }
+
+    std::filesystem::path path(filePath);
+    std::error_code error;
+    if (path.has_parent_path()) {
+        std::filesystem::create_directories(path.parent_path(), error);
+    }
+
+    auto fileSink = std::make_shared<LogFileSink>();
+    fileSink->setFlushPolicy(flushPolicy);
+    fileSink->setRotationPolicy(rotationPolicy);
+    fileSink->setCompressionPolicy(compressionPolicy);
+    if (!fileSink->open(filePath)) {
+        return nullptr;
+    }
+
+    std::string started = bannerLine("Log Started") + "===================================\n";
+    fileSink->writeRaw(started.data(), started.size());
+    fileSink->flush();
+
+    // The last user to let go writes the end banner and closes the file
+    std::shared_ptr<LogSink> shared(new LogSharedSink(fileSink), [fileSink](LogSharedSink* sharedSink) {
+        delete sharedSink;
+        std::string ended = bannerLine("Log Ended") + "\n";
+        fileSink->writeRaw(ended.data(), ended.size());
+        fileSink->close();
+    });
+    fileSinks[key] = shared;
+    return shared;
+}
+
+// Console
+std::shared_ptr<LogConsoleSink> LogRegistry::getConsoleSink() {
+    std::lock_guard<std::mutex> registryLock(registryMutex);
+    if (!consoleSink) {
+        consoleSink = std::make_shared<LogConsoleSink>();
+    }
+    return consoleSink;
+}
+
+// Default sinks
+void LogRegistry::setDefaultSinks(const std::vector<std::shared_ptr<LogSink>>& sinks) {
+    std::lock_guard<std::mutex> registryLock(registryMutex);
+    defaultSinks = sinks;
+    defaultSinksSet = true;
+}
+
+std::vector<std::shared_ptr<LogSink>> LogRegistry::getDefaultSinks() {
+    std::lock_guard<std::mutex> registryLock(registryMutex);
+    return defaultSinksLocked();
+}
+
+const std::vector<std::shared_ptr<LogSink>>& LogRegistry::defaultSinksLocked() {
+    if (!defaultSinksSet) {
+        if (!consoleSink) {
+            consoleSink = std::make_shared<LogConsoleSink>();
+        }
+        defaultSinks = {consoleSink};
+        defaultSinksSet = true;
+    }
+    return defaultSinks;
+}
@@ -0,0 +1,447 @@
+#include "LogSharedMemoryChannel.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <new>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <csignal>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr char channelMagic[8] = {'L', 'O', 'G', 'S', 'H', 'M', '0', '1'};
+constexpr std::uint32_t wrapMarker = UINT32_MAX;
+
+enum RingState : std::uint32_t {
+    FreeRing    = 0,
+    ClaimedRing = 1,
+    ReleasedRing = 2 // the producer is done; freed once drained
+};
+
+struct alignas(64) ChannelHeader {
+    char magic[8];
+    std::uint32_t format;
+    std::uint32_t ringCount;
+    std::uint64_t ringBytes;
+    std::atomic<std::uint32_t> ready;  // set once the rest is filled in
+    std::atomic<std::uint32_t> closed; // set when the creating collector closes it
+};
+
+// The writer's and the reader's positions sit on cache lines of their own
+struct alignas(64) RingControl {
+    std::atomic<std::uint32_t> state;
+    std::atomic<std::uint32_t> owner;
+    alignas(64) std::atomic<std::uint64_t> writePosition;
+    std::atomic<std::uint64_t> droppedRecords;
+    alignas(64) std::atomic<std::uint64_t> readPosition;
+};
+
+struct RecordHeader {
+    std::int64_t timestamp;
+    std::uint32_t length;
+    std::uint32_t messageOffset;
+    std::uint32_t messageLength;
+    std::uint8_t level;
+    std::uint8_t reserved[3];
+};
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "shared rings need lock-free 64-bit atomics");
+static_assert(sizeof(RecordHeader) == 24, "record header layout");
+
+constexpr std::size_t minimumRingBytes = 4096;
+
+std::size_t recordSize(std::size_t length) {
+    return (sizeof(RecordHeader) + length + 7) & ~static_cast<std::size_t>(7);
+}
+
+std::size_t segmentBytes(std::size_t ringCount, std::size_t ringBytes) {
+    return sizeof(ChannelHeader) + ringCount * (sizeof(RingControl) + ringBytes);
+}
+
+std::uint32_t currentProcessId() {
+#ifdef _WIN32
+    return static_cast<std::uint32_t>(GetCurrentProcessId());
+#else
+    return static_cast<std::uint32_t>(getpid());
+#endif
+}
+
+bool processAlive(std::uint32_t processId) {
+#ifdef _WIN32
+    HANDLE process = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, static_cast<DWORD>(processId));
+    if (process == nullptr) {
+        return GetLastError() == ERROR_ACCESS_DENIED;
+    }
+    DWORD exitCode = 0;
+    bool alive = GetExitCodeProcess(process, &exitCode) && exitCode == STILL_ACTIVE;
+    CloseHandle(process);
+    return alive;
+#else
+    return ::kill(static_cast<pid_t>(processId), 0) == 0 || errno != ESRCH;
+#endif
+}
+
+// Segment names: "/name" for shm_open, "Local\name" for a Windows mapping
+std::string systemName(const std::string& name) {
+#ifdef _WIN32
+    return "Local\\" + name;
+#else
+    return name.empty() || name[0] != '/' ? "/" + name : name;
+#endif
+}
+
+}
+
+LogSharedMemoryChannel::~LogSharedMemoryChannel() {
+    close();
+}
+
+// Segment layout helpers
+static ChannelHeader* channelHeader(char* segment) {
+    return reinterpret_cast<ChannelHeader*>(segment);
+}
+
+static RingControl* ringControl(char* segment, std::size_t ring) {
+    return reinterpret_cast<RingControl*>(segment + sizeof(ChannelHeader)) + ring;
+}
+
+static char* ringData(char* segment, std::size_t ring) {
+    ChannelHeader* header = channelHeader(segment);
+    return segment + sizeof(ChannelHeader) + header->ringCount * sizeof(RingControl) +
+           ring * static_cast<std::size_t>(header->ringBytes);
+}
+
+// Creating and opening
+bool LogSharedMemoryChannel::create(const std::string& name, LogSinkFormat format,
+                                    std::size_t ringCount, std::size_t ringBytes) {
+    close();
+    if (ringCount == 0 || ringCount > UINT32_MAX) {
+        return false;
+    }
+    std::size_t roundedBytes = minimumRingBytes;
+    while (roundedBytes < ringBytes) {
+        roundedBytes *= 2;
+    }
+
+    // Producers still attached to an earlier segment see it closed and move on
+    {
+        LogSharedMemoryChannel stale;
+        if (stale.open(name)) {
+            channelHeader(stale.segment)->closed.store(1, std::memory_order_release);
+        }
+    }
+    #ifndef _WIN32
+    shm_unlink(systemName(name).c_str());
+    #endif
+
+    segmentName = name;
+    if (!map(segmentBytes(ringCount, roundedBytes), true)) {
+        return false;
+    }
+    creator = true;
+
+    ChannelHeader* header = new (segment) ChannelHeader();
+    std::memcpy(header->magic, channelMagic, sizeof(channelMagic));
+    header->format = static_cast<std::uint32_t>(format);
+    header->ringCount = static_cast<std::uint32_t>(ringCount);
+    header->ringBytes = roundedBytes;
+    header->ready.store(0, std::memory_order_relaxed);
+    header->closed.store(0, std::memory_order_relaxed);
+    for (std::size_t ring = 0; ring < ringCount; ++ring) {
+        RingControl* control = new (ringControl(segment, ring)) RingControl();
+        control->state.store(FreeRing, std::memory_order_relaxed);
+        control->owner.store(0, std::memory_order_relaxed);
+        control->writePosition.store(0, std::memory_order_relaxed);
+        control->droppedRecords.store(0, std::memory_order_relaxed);
+        control->readPosition.store(0, std::memory_order_relaxed);
+    }
+
+    // A producer that sees the segment ready sees all of it
+    header->ready.store(1, std::memory_order_release);
+    return true;
+}
+
+bool LogSharedMemoryChannel::open(const std::string& name) {
+    close();
+    segmentName = name;
+    if (!map(0, false)) {
+        return false;
+    }
+
+    ChannelHeader* header = channelHeader(segment);
+    bool valid = segmentSize >= sizeof(ChannelHeader) &&
+                 header->ready.load(std::memory_order_acquire) != 0 &&
+                 std::memcmp(header->magic, channelMagic, sizeof(channelMagic)) == 0;
+    valid = valid && header->ringCount > 0 &&
+            segmentSize >= segmentBytes(header->ringCount, static_cast<std::size_t>(header->ringBytes));
+    if (!valid) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+// Map the segment: a new one of the given size, or the whole existing one
+bool LogSharedMemoryChannel::map(std::size_t size, bool creating) {
+    std::string mappingName = systemName(segmentName);
+
+    #ifdef _WIN32
+    if (creating) {
+        std::uint64_t size64 = size;
+        mappingHandle = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+                                           static_cast<DWORD>(size64 >> 32), static_cast<DWORD>(size64),
+                                           mappingName.c_str());
+    } else {
+        mappingHandle = OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, mappingName.c_str());
+    }
+    if (mappingHandle == nullptr) {
+        return false;
+    }
+    segment = static_cast<char*>(MapViewOfFile(mappingHandle, FILE_MAP_ALL_ACCESS, 0, 0, 0));
+    if (segment == nullptr) {
+        CloseHandle(mappingHandle);
+        mappingHandle = nullptr;
+        return false;
+    }
+    MEMORY_BASIC_INFORMATION region;
+    VirtualQuery(segment, &region, sizeof(region));
+    segmentSize = region.RegionSize;
+    #else
+    int descriptor = creating ? shm_open(mappingName.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600)
+                              : shm_open(mappingName.c_str(), O_RDWR, 0);
+    if (descriptor < 0) {
+        return false;
+    }
+
+    if (creating) {
+        if (ftruncate(descriptor, static_cast<off_t>(size)) != 0) {
+            ::close(descriptor);
+            shm_unlink(mappingName.c_str());
+            return false;
+        }
+    } else {
+        struct stat segmentStatus;
+        if (fstat(descriptor, &segmentStatus) != 0) {
+            ::close(descriptor);
+            return false;
+        }
+        size = static_cast<std::size_t>(segmentStatus.st_size);
+    }
+
+    void* view = size > 0 ? mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0) : MAP_FAILED;
+    ::close(descriptor);
+    if (view == MAP_FAILED) {
+        if (creating) {
+            shm_unlink(mappingName.c_str());
+        }
+        return false;
+    }
+    segment = static_cast<char*>(view);
+    segmentSize = size;
+    #endif
+    return true;
+}
+
+void LogSharedMemoryChannel::close() {
+    if (segment != nullptr && creator) {
+        channelHeader(segment)->closed.store(1, std::memory_order_release);
+        #ifndef _WIN32
+        shm_unlink(systemName(segmentName).c_str());
+        #endif
+    }
+
+    #ifdef _WIN32
+    if (segment != nullptr) {
+        UnmapViewOfFile(segment);
+    }
+    if (mappingHandle != nullptr) {
+        CloseHandle(mappingHandle);
+        mappingHandle = nullptr;
+    }
+    #else
+    if (segment != nullptr) {
+        munmap(segment, segmentSize);
+    }
+    #endif
+
+    segment = nullptr;
+    segmentSize = 0;
+    creator = false;
+    reclaimedDrops = 0;
+}
+
+bool LogSharedMemoryChannel::isOpen() const {
+    return segment != nullptr;
+}
+
+bool LogSharedMemoryChannel::isClosed() const {
+    return segment == nullptr || channelHeader(segment)->closed.load(std::memory_order_acquire) != 0;
+}
+
+LogSinkFormat LogSharedMemoryChannel::getFormat() const {
+    return segment != nullptr ? static_cast<LogSinkFormat>(channelHeader(segment)->format)
+                              : LogSinkFormat::Text;
+}
+
+std::size_t LogSharedMemoryChannel::getRingCount() const {
+    return segment != nullptr ? channelHeader(segment)->ringCount : 0;
+}
+
+std::size_t LogSharedMemoryChannel::getRingBytes() const {
+    return segment != nullptr ? static_cast<std::size_t>(channelHeader(segment)->ringBytes) : 0;
+}
+
+// Producer side
+std::size_t LogSharedMemoryChannel::claimRing() {
+    for (std::size_t ring = 0; ring < getRingCount(); ++ring) {
+        RingControl* control = ringControl(segment, ring);
+        std::uint32_t expected = FreeRing;
+        if (control->state.load(std::memory_order_relaxed) == FreeRing &&
+            control->state.compare_exchange_strong(expected, ClaimedRing, std::memory_order_acq_rel)) {
+            control->owner.store(currentProcessId(), std::memory_order_release);
+            return ring;
+        }
+    }
+    return noRing;
+}
+
+void LogSharedMemoryChannel::releaseRing(std::size_t ring) {
+    if (ring < getRingCount()) {
+        ringControl(segment, ring)->state.store(ReleasedRing, std::memory_order_release);
+    }
+}
+
+bool LogSharedMemoryChannel::push(std::size_t ring, std::int64_t timestampNanoseconds, LogLevel level,
+                                  const char* line, std::size_t length, std::size_t messageOffset,
+                                  std::size_t messageLength) {
+    RingControl* control = ringControl(segment, ring);
+    std::size_t ringBytes = getRingBytes();
+    std::size_t needed = recordSize(length);
+    if (needed > ringBytes / 2) {
+        control->droppedRecords.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    // A record that would cross the end of the ring goes to its start
+    std::uint64_t write = control->writePosition.load(std::memory_order_relaxed);
+    std::uint64_t read = control->readPosition.load(std::memory_order_acquire);
+    std::size_t offset = static_cast<std::size_t>(write & (ringBytes - 1));
+    std::size_t tailRoom = ringBytes - offset;
+    std::size_t skipped = tailRoom < needed ? tailRoom : 0;
+    if (write + skipped + needed - read > ringBytes) {
+        control->droppedRecords.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    char* data = ringData(segment, ring);
+    if (skipped > 0) {
+        if (skipped >= sizeof(RecordHeader)) {
+            RecordHeader marker = {};
+            marker.length = wrapMarker;
+            std::memcpy(data + offset, &marker, sizeof(marker));
+        }
+        offset = 0;
+    }
+
+    RecordHeader header = {};
+    header.timestamp = timestampNanoseconds;
+    header.length = static_cast<std::uint32_t>(length);
+    header.messageOffset = static_cast<std::uint32_t>(messageOffset);
+    header.messageLength = static_cast<std::uint32_t>(messageLength);
+    header.level = static_cast<std::uint8_t>(level);
+    std::memcpy(data + offset, &header, sizeof(header));
+    std::memcpy(data + offset + sizeof(header), line, length);
+
+    control->writePosition.store(write + skipped + needed, std::memory_order_release);
+    return true;
+}
+
+// Collector side
+std::size_t LogSharedMemoryChannel::drain(std::size_t ring, LogSinkBatch& batch) {
+    RingControl* control = ringControl(segment, ring);
+    std::size_t ringBytes = getRingBytes();
+    const char* data = ringData(segment, ring);
+
+    std::uint64_t read = control->readPosition.load(std::memory_order_relaxed);
+    std::uint64_t write = control->writePosition.load(std::memory_order_acquire);
+    std::size_t records = 0;
+    while (read < write) {
+        std::size_t offset = static_cast<std::size_t>(read & (ringBytes - 1));
+        std::size_t tailRoom = ringBytes - offset;
+        RecordHeader header;
+        if (tailRoom < sizeof(RecordHeader)) {
+            read += tailRoom;
+            continue;
+        }
+        std::memcpy(&header, data + offset, sizeof(header));
+        if (header.length == wrapMarker) {
+            read += tailRoom;
+            continue;
+        }
+
+        // A record that makes no sense: drop what is left rather than read past the ring
+        std::size_t size = recordSize(header.length);
+        if (size > tailRoom || read + size > write) {
+            read = write;
+            break;
+        }
+
+        std::size_t messageOffset = header.messageOffset <= header.length ? header.messageOffset : 0;
+        std::size_t messageLength = std::min<std::size_t>(header.messageLength, header.length - messageOffset);
+        std::chrono::system_clock::time_point timestamp(
+            std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                std::chrono::nanoseconds(header.timestamp)));
+        batch.appendLine(timestamp, static_cast<LogLevel>(header.level), data + offset + sizeof(header),
+                         header.length, messageOffset, messageLength);
+        read += size;
+        ++records;
+    }
+
+    control->readPosition.store(read, std::memory_order_release);
+    return records;
+}
+
+std::size_t LogSharedMemoryChannel::reclaimRings() {
+    std::size_t inUse = 0;
+    for (std::size_t ring = 0; ring < getRingCount(); ++ring) {
+        RingControl* control = ringControl(segment, ring);
+        std::uint32_t state = control->state.load(std::memory_order_acquire);
+        if (state == FreeRing) {
+            continue;
+        }
+
+        bool empty = control->readPosition.load(std::memory_order_relaxed) ==
+                     control->writePosition.load(std::memory_order_acquire);
+        bool done = state == ReleasedRing;
+        if (!done) {
+            // A claimer that has not stored its pid yet is alive
+            std::uint32_t owner = control->owner.load(std::memory_order_acquire);
+            done = owner != 0 && !processAlive(owner);
+        }
+        if (!done || !empty) {
+            ++inUse;
+            continue;
+        }
+
+        reclaimedDrops += control->droppedRecords.exchange(0, std::memory_order_relaxed);
+        control->owner.store(0, std::memory_order_relaxed);
+        control->writePosition.store(0, std::memory_order_relaxed);
+        control->readPosition.store(0, std::memory_order_relaxed);
+        control->state.store(FreeRing, std::memory_order_release);
+    }
+    return inUse;
+}
+
+std::uint64_t LogSharedMemoryChannel::getDroppedRecords() const {
+    std::uint64_t dropped = reclaimedDrops;
+    for (std::size_t ring = 0; ring < getRingCount(); ++ring) {
+        dropped += ringControl(segment, ring)->droppedRecords.load(std::memory_order_relaxed);
+    }
+    return dropped;
+}
@@ -0,0 +1,127 @@
+#include "LogSharedMemorySink.hpp"
+#include <atomic>
+#include <mutex>
+
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
+// Bumped in the child after every fork: a ring claimed before it belongs
+// to the parent
+static std::atomic<std::uint64_t> processGeneration{0};
+
+#ifndef _WIN32
+static void onForkChild() {
+    processGeneration.fetch_add(1, std::memory_order_relaxed);
+}
+#endif
+
+static void watchForks() {
+    static std::once_flag installed;
+    std::call_once(installed, []() {
+        #ifndef _WIN32
+        pthread_atfork(nullptr, nullptr, onForkChild);
+        #endif
+    });
+}
+
+LogSharedMemorySink::LogSharedMemorySink(const std::string& channelName, LogSinkFormat format)
+: LogSink(format),
+channelName(channelName) {
+    watchForks();
+    attach();
+}
+
+LogSharedMemorySink::~LogSharedMemorySink() {
+    detach();
+}
+
+// Attaching – claim a ring, reopening the channel if the collector replaced
+// it; tried again at most every reattachDelay, except right after a fork
+bool LogSharedMemorySink::attach() {
+    if (isAttached()) {
+        return true;
+    }
+
+    bool forked = ring != LogSharedMemoryChannel::noRing &&
+                  ringGeneration != processGeneration.load(std::memory_order_relaxed);
+    auto now = std::chrono::steady_clock::now();
+    if (!forked && now < nextAttach) {
+        return false;
+    }
+    nextAttach = now + reattachDelay;
+
+    if (channel.isOpen() && channel.isClosed()) {
+        detach();
+    }
+    if (!channel.isOpen()) {
+        if (!channel.open(channelName)) {
+            return false;
+        }
+        if (channel.getFormat() != getFormat() || getFormat() == LogSinkFormat::Binary) {
+            channel.close();
+            return false;
+        }
+    }
+
+    // A ring inherited through fork stays the parent's
+    ring = channel.claimRing();
+    ringGeneration = processGeneration.load(std::memory_order_relaxed);
+    return ring != LogSharedMemoryChannel::noRing;
+}
+
+void LogSharedMemorySink::detach() {
+    if (ring != LogSharedMemoryChannel::noRing &&
+        ringGeneration == processGeneration.load(std::memory_order_relaxed)) {
+        channel.releaseRing(ring);
+    }
+    ring = LogSharedMemoryChannel::noRing;
+    channel.close();
+}
+
+bool LogSharedMemorySink::isAttached() const {
+    return ring != LogSharedMemoryChannel::noRing && !channel.isClosed() &&
+           ringGeneration == processGeneration.load(std::memory_order_relaxed);
+}
+
+std::uint64_t LogSharedMemorySink::getDroppedRecords() const {
+    return droppedRecords;
+}
+
+// Writing
+void LogSharedMemorySink::write(const LogSinkBatch& batch) {
+    bool attached = attach();
+    for (const LogSinkEntry& entry : batch.entries()) {
+        if (!accepts(entry.level)) {
+            continue;
+        }
+        if (!attached) {
+            ++droppedRecords;
+            continue;
+        }
+        push(entry.timestamp, entry.level, batch.data() + entry.offset, entry.length,
+             entry.messageOffset, entry.messageLength);
+    }
+}
+
+void LogSharedMemorySink::crashWrite(const char* record, std::size_t length) {
+    if (isAttached()) {
+        push(std::chrono::system_clock::now(), LogLevel::Error, record, length, 0, length);
+    }
+}
+
+// The ring takes lines without their newline (the collector adds it back)
+void LogSharedMemorySink::push(std::chrono::system_clock::time_point timestamp, LogLevel level,
+                               const char* record, std::size_t length, std::size_t messageOffset,
+                               std::size_t messageLength) {
+    if (length > 0 && record[length - 1] == '\n') {
+        --length;
+    }
+    messageOffset = messageOffset <= length ? messageOffset : 0;
+    messageLength = messageLength <= length - messageOffset ? messageLength : length - messageOffset;
+
+    auto nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(timestamp.time_since_epoch());
+    if (!channel.push(ring, nanoseconds.count(), level, record, length, messageOffset, messageLength)) {
+        ++droppedRecords;
+    }
+}
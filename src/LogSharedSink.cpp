@@ -0,0 +1,50 @@
+#include "LogSharedSink.hpp"
+
+LogSharedSink::LogSharedSink(std::shared_ptr<LogSink> sink)
+: LogSink(sink->getFormat()),
+sink(std::move(sink)),
+accepted(getFormat()) {
+}
+
+void LogSharedSink::write(const LogSinkBatch& batch) {
+    std::lock_guard<std::mutex> sinkLock(sinkMutex);
+    if (acceptsAll(batch)) {
+        sink->write(batch);
+        return;
+    }
+
+    accepted.clear();
+    for (const LogSinkEntry& entry : batch.entries()) {
+        if (accepts(entry.level)) {
+            accepted.appendEntry(batch, entry);
+        }
+    }
+    if (!accepted.empty()) {
+        sink->write(accepted);
+    }
+}
+
+void LogSharedSink::flush() {
+    std::lock_guard<std::mutex> sinkLock(sinkMutex);
+    sink->flush();
+}
+
+void LogSharedSink::flushIfDue() {
+    // An idle writer must not wait behind another logger's write
+    std::unique_lock<std::mutex> sinkLock(sinkMutex, std::try_to_lock);
+    if (sinkLock.owns_lock()) {
+        sink->flushIfDue();
+    }
+}
+
+void LogSharedSink::crashFlush() {
+    sink->crashFlush();
+}
+
+void LogSharedSink::crashWrite(const char* record, std::size_t length) {
+    sink->crashWrite(record, length);
+}
+
+const std::shared_ptr<LogSink>& LogSharedSink::getSink() const {
+    return sink;
+}
@@ -0,0 +1,19 @@
+#include "LogSink.hpp"
+
+LogSink::LogSink(LogSinkFormat format)
+: format(format) {
+}
+
+LogSink::~LogSink() = default;
+
+void LogSink::flush() {
+}
+
+void LogSink::flushIfDue() {
+}
+
+void LogSink::crashFlush() {
+}
+
+void LogSink::crashWrite(const char*, std::size_t) {
+}
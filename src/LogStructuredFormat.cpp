@@ -0,0 +1,277 @@
+#include "LogStructuredFormat.hpp"
+#include <charconv>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define LOGGER_HAVE_SSE2 1
+    #ifdef _MSC_VER
+        #include <intrin.h>
+    #endif
+#endif
+
+namespace {
+
+bool needsJsonEscape(unsigned char character) {
+    return character < 0x20 || character == '"' || character == '\\';
+}
+
+#ifdef LOGGER_HAVE_SSE2
+int lowestSetBit(unsigned int mask) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+#endif
+
+// Length of the run at the start of text that needs no escaping
+std::size_t cleanRunLength(const char* text, std::size_t length) {
+    std::size_t position = 0;
+
+#ifdef LOGGER_HAVE_SSE2
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i lastControl = _mm_set1_epi8(0x1F);
+
+    for (; position + 16 <= length; position += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + position));
+        // Unsigned "byte <= 0x1F" is "min(byte, 0x1F) == byte"
+        __m128i control = _mm_cmpeq_epi8(_mm_min_epu8(chunk, lastControl), chunk);
+        __m128i special = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, quote),
+                                                    _mm_cmpeq_epi8(chunk, backslash)),
+                                       control);
+        unsigned int mask = static_cast<unsigned int>(_mm_movemask_epi8(special));
+        if (mask != 0) {
+            return position + static_cast<std::size_t>(lowestSetBit(mask));
+        }
+    }
+#endif
+
+    while (position < length && !needsJsonEscape(static_cast<unsigned char>(text[position]))) {
+        ++position;
+    }
+    return position;
+}
+
+void appendEscape(LogLineBuffer& out, unsigned char character) {
+    switch (character) {
+    case '"':  out.append("\\\"", 2); break;
+    case '\\': out.append("\\\\", 2); break;
+    case '\n': out.append("\\n", 2); break;
+    case '\r': out.append("\\r", 2); break;
+    case '\t': out.append("\\t", 2); break;
+    case '\b': out.append("\\b", 2); break;
+    case '\f': out.append("\\f", 2); break;
+    default: {
+        static const char hexDigits[] = "0123456789abcdef";
+        char escape[6] = { '\\', 'u', '0', '0', hexDigits[character >> 4], hexDigits[character & 0x0F] };
+        out.append(escape, sizeof(escape));
+        break;
+    }
+    }
+}
+
+// RFC 3339 in UTC: unambiguous for collectors, whatever the zone or DST
+void appendIsoTimestamp(LogLineBuffer& out, std::chrono::system_clock::time_point timestamp,
+                        LogTimestampCache& timestampCache) {
+    char timestampText[logUtcTimestampLength];
+    timestampCache.formatUtc(timestamp, timestampText);
+    out.append(timestampText, logUtcTimestampLength);
+}
+
+// A logfmt key cannot be quoted: bytes that would end it or break the line
+// (space, '=', '"', control characters) become '_', and an empty key is "_"
+void appendLogfmtKey(LogLineBuffer& out, std::string_view key) {
+    if (key.empty()) {
+        out.append('_');
+        return;
+    }
+    for (char character : key) {
+        unsigned char byte = static_cast<unsigned char>(character);
+        bool breaksKey = byte <= ' ' || byte == 0x7F || character == '=' || character == '"';
+        out.append(breaksKey ? '_' : character);
+    }
+}
+
+void appendPointer(LogLineBuffer& out, const void* value) {
+    char digits[2 + 2 * sizeof(std::uintptr_t)] = { '0', 'x' };
+    auto result = std::to_chars(digits + 2, digits + sizeof(digits),
+                                reinterpret_cast<std::uintptr_t>(value), 16);
+    out.append(digits, static_cast<std::size_t>(result.ptr - digits));
+}
+
+void appendNumber(LogLineBuffer& out, std::uint32_t value) {
+    char digits[10];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    out.append(digits, static_cast<std::size_t>(result.ptr - digits));
+}
+
+void appendJsonValue(LogLineBuffer& out, const LogFormatter::Argument& value) {
+    using Type = LogFormatter::ArgumentType;
+
+    switch (value.type) {
+    case Type::Double:
+        // JSON has no NaN or infinity
+        if (!std::isfinite(value.doubleValue)) {
+            out.append("null", 4);
+        } else {
+            LogFormatter::appendArgument(out, value);
+        }
+        break;
+    case Type::Char:
+        LogStructuredFormat::appendJsonString(out, std::string_view(&value.charValue, 1));
+        break;
+    case Type::String:
+        LogStructuredFormat::appendJsonString(out, value.text);
+        break;
+    case Type::Pointer:
+        out.append('"');
+        appendPointer(out, value.pointerValue);
+        out.append('"');
+        break;
+    default:
+        LogFormatter::appendArgument(out, value);
+        break;
+    }
+}
+
+void appendLogfmtArgument(LogLineBuffer& out, const LogFormatter::Argument& value) {
+    using Type = LogFormatter::ArgumentType;
+
+    if (value.type == Type::String) {
+        LogStructuredFormat::appendLogfmtValue(out, value.text);
+    } else if (value.type == Type::Char) {
+        LogStructuredFormat::appendLogfmtValue(out, std::string_view(&value.charValue, 1));
+    } else {
+        LogFormatter::appendArgument(out, value);
+    }
+}
+
+}
+
+// Fields – " key=value" pairs (a key without a value is dropped)
+void LogStructuredFormat::appendLogfmtFields(LogLineBuffer& out, const char* fields, std::size_t fieldsLength) {
+    std::size_t offset = 0;
+    LogFormatter::Argument key;
+    LogFormatter::Argument value;
+
+    while (LogFormatter::decodeArgument(fields, fieldsLength, offset, key) &&
+           LogFormatter::decodeArgument(fields, fieldsLength, offset, value)) {
+        out.append(' ');
+        appendLogfmtKey(out, key.text);
+        out.append('=');
+        appendLogfmtArgument(out, value);
+    }
+}
+
+// Records – JSON lines
+void LogStructuredFormat::appendJsonRecord(LogLineBuffer& out, std::chrono::system_clock::time_point timestamp,
+                                           LogLevel level, std::string_view loggerName, std::string_view message,
+                                           const char* fields, std::size_t fieldsLength,
+                                           LogTimestampCache& timestampCache,
+                                           std::uint32_t thread, std::uint32_t callSite) {
+    std::string_view levelName = levelKey(level);
+
+    out.append("{\"time\":\"", 9);
+    appendIsoTimestamp(out, timestamp, timestampCache);
+    out.append("\",\"level\":\"", 11);
+    out.append(levelName.data(), levelName.size());
+    out.append("\",\"logger\":", 11);
+    appendJsonString(out, loggerName);
+    out.append(",\"msg\":", 7);
+    appendJsonString(out, message);
+    if (const LogCallSite* site = LogCallSites::find(callSite)) {
+        out.append(",\"thread\":", 10);
+        appendNumber(out, thread);
+        out.append(",\"file\":", 8);
+        appendJsonString(out, site->file);
+        out.append(",\"line\":", 8);
+        appendNumber(out, site->line);
+        out.append(",\"function\":", 12);
+        appendJsonString(out, site->function);
+    }
+
+    std::size_t offset = 0;
+    LogFormatter::Argument key;
+    LogFormatter::Argument value;
+    while (LogFormatter::decodeArgument(fields, fieldsLength, offset, key) &&
+           LogFormatter::decodeArgument(fields, fieldsLength, offset, value)) {
+        out.append(',');
+        appendJsonString(out, key.text);
+        out.append(':');
+        appendJsonValue(out, value);
+    }
+    out.append('}');
+}
+
+// Records – logfmt
+void LogStructuredFormat::appendLogfmtRecord(LogLineBuffer& out, std::chrono::system_clock::time_point timestamp,
+                                             LogLevel level, std::string_view loggerName, std::string_view message,
+                                             const char* fields, std::size_t fieldsLength,
+                                             LogTimestampCache& timestampCache,
+                                             std::uint32_t thread, std::uint32_t callSite) {
+    std::string_view levelName = levelKey(level);
+
+    out.append("time=", 5);
+    appendIsoTimestamp(out, timestamp, timestampCache);
+    out.append(" level=", 7);
+    out.append(levelName.data(), levelName.size());
+    out.append(" logger=", 8);
+    appendLogfmtValue(out, loggerName);
+    out.append(" msg=", 5);
+    appendLogfmtValue(out, message);
+    if (const LogCallSite* site = LogCallSites::find(callSite)) {
+        out.append(" thread=", 8);
+        appendNumber(out, thread);
+        out.append(" file=", 6);
+        appendLogfmtValue(out, site->file);
+        out.append(" line=", 6);
+        appendNumber(out, site->line);
+        out.append(" function=", 10);
+        appendLogfmtValue(out, site->function);
+    }
+    appendLogfmtFields(out, fields, fieldsLength);
+}
+
+// Strings – escape only what JSON requires, copying clean runs whole
+void LogStructuredFormat::appendJsonString(LogLineBuffer& out, std::string_view text) {
+    const char* data = text.data();
+    std::size_t remaining = text.size();
+
+    out.append('"');
+    while (remaining > 0) {
+        std::size_t clean = cleanRunLength(data, remaining);
+        out.append(data, clean);
+        if (clean == remaining) {
+            break;
+        }
+        appendEscape(out, static_cast<unsigned char>(data[clean]));
+        data += clean + 1;
+        remaining -= clean + 1;
+    }
+    out.append('"');
+}
+
+void LogStructuredFormat::appendLogfmtValue(LogLineBuffer& out, std::string_view text) {
+    bool bare = !text.empty() && cleanRunLength(text.data(), text.size()) == text.size() &&
+                text.find_first_of(" =") == std::string_view::npos;
+    if (bare) {
+        out.append(text.data(), text.size());
+    } else {
+        appendJsonString(out, text);
+    }
+}
+
+std::string_view LogStructuredFormat::levelKey(LogLevel level) {
+    switch (level) {
+    case LogLevel::Message: return "message";
+    case LogLevel::Success: return "success";
+    case LogLevel::Warning: return "warning";
+    case LogLevel::Error:   return "error";
+    default:                return "off";
+    }
+}
@@ -0,0 +1,53 @@
+#include "LogTextLayout.hpp"
+
+// Per-level name and padded "[LEVEL..] " field
+struct LevelText {
+    const char* name;
+    const char* paddedField;
+};
+
+static const LevelText levelTexts[] = {
+    { "MESSAGE", "[MESSAGE] " },
+    { "SUCCESS", "[SUCCESS] " },
+    { "WARNING", "[WARNING] " },
+    { "ERROR",   "[ERROR..] " },
+    { "OFF",     "[OFF....] " }
+};
+
+static const LevelText& textOf(LogLevel level) {
+    std::size_t index = static_cast<std::size_t>(level);
+    return levelTexts[index < sizeof(levelTexts) / sizeof(levelTexts[0]) ? index : 0];
+}
+
+const char* logLevelName(LogLevel level) {
+    return textOf(level).name;
+}
+
+// Pad a bracketed field with '.' like std::setw/std::setfill did
+std::string LogTextLayout::padName(const std::string& loggerName) {
+    std::string field = "[" + loggerName;
+    if (loggerName.size() < loggerNameWidth) {
+        field.append(loggerNameWidth - loggerName.size(), '.');
+    }
+    field += "] ";
+    return field;
+}
+
+const char* LogTextLayout::paddedLevel(LogLevel level) {
+    return textOf(level).paddedField;
+}
+
+void LogTextLayout::formatPrefix(LogLineBuffer& out, std::chrono::system_clock::time_point timestamp,
+                                 const std::string& paddedName, LogLevel level,
+                                 LogTimestampCache& timestampCache) {
+    char timestampText[logTimestampLength];
+    timestampCache.format(timestamp, timestampText);
+
+    out.clear();
+    out.append('[');
+    out.append(timestampText, logTimestampLength);
+    out.append("] ", 2);
+    out.append(paddedName);
+    out.append(paddedLevel(level), paddedLevelLength);
+    out.markMessageStart();
+}
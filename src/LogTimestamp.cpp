@@ -0,0 +1,187 @@
+#include "LogTimestamp.hpp"
+#include <cstring>
+#include <ctime>
+
+namespace {
+
+void writeDigits(char* out, unsigned int value, int width) {
+    for (int i = width - 1; i >= 0; --i) {
+        out[i] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    }
+}
+
+// Milliseconds since the epoch split into whole seconds and the rest
+void splitMilliseconds(std::chrono::system_clock::time_point timestamp,
+                       std::int64_t& second, std::int64_t& millisecondPart) {
+    std::int64_t milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(
+        timestamp.time_since_epoch()
+    ).count();
+
+    second = milliseconds / 1000;
+    millisecondPart = milliseconds % 1000;
+    if (millisecondPart < 0) {
+        second -= 1;
+        millisecondPart += 1000;
+    }
+}
+
+// Civil date of a day count since 1970-01-01 (proleptic Gregorian calendar)
+void civilFromDays(std::int64_t days, std::int64_t& year, unsigned int& month, unsigned int& day) {
+    days += 719468;
+    std::int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+    std::int64_t dayOfEra = days - era * 146097;
+    std::int64_t yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    std::int64_t dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    std::int64_t monthIndex = (5 * dayOfYear + 2) / 153;
+    day = static_cast<unsigned int>(dayOfYear - (153 * monthIndex + 2) / 5 + 1);
+    month = static_cast<unsigned int>(monthIndex < 10 ? monthIndex + 3 : monthIndex - 9);
+    year = yearOfEra + era * 400 + (month <= 2 ? 1 : 0);
+}
+
+// Day count since 1970-01-01 of a civil date (the inverse of civilFromDays)
+std::int64_t daysFromCivil(std::int64_t year, unsigned int month, unsigned int day) {
+    year -= month <= 2 ? 1 : 0;
+    std::int64_t era = (year >= 0 ? year : year - 399) / 400;
+    std::int64_t yearOfEra = year - era * 400;
+    std::int64_t dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    std::int64_t dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + dayOfEra - 719468;
+}
+
+// "YYYY-MM-DD HH:MM:SS" into out
+void writeDateTime(char* out, std::int64_t year, unsigned int month, unsigned int day, unsigned int secondOfDay) {
+    writeDigits(out, static_cast<unsigned int>(year), 4);
+    out[4] = '-';
+    writeDigits(out + 5, month, 2);
+    out[7] = '-';
+    writeDigits(out + 8, day, 2);
+    out[10] = ' ';
+    writeDigits(out + 11, secondOfDay / 3600, 2);
+    out[13] = ':';
+    writeDigits(out + 14, secondOfDay / 60 % 60, 2);
+    out[16] = ':';
+    writeDigits(out + 17, secondOfDay % 60, 2);
+}
+
+}
+
+// Format a timestamp, patching the cached text where possible
+void LogTimestampCache::format(std::chrono::system_clock::time_point timestamp, char* out) {
+    std::int64_t second;
+    std::int64_t millisecondPart;
+    splitMilliseconds(timestamp, second, millisecondPart);
+
+    if (second != cachedSecond) {
+        if (second >= minuteStart && second < minuteStart + 60) {
+            writeDigits(cachedText + 17, static_cast<unsigned int>(second - minuteStart), 2);
+        } else {
+            refresh(second);
+        }
+        cachedSecond = second;
+    }
+
+    std::memcpy(out, cachedText, sizeof(cachedText));
+    out[19] = '.';
+    writeDigits(out + 20, static_cast<unsigned int>(millisecondPart), 3);
+}
+
+// Format a UTC timestamp; the date and time of day are plain arithmetic
+void LogTimestampCache::formatUtc(std::chrono::system_clock::time_point timestamp, char* out) {
+    std::int64_t second;
+    std::int64_t millisecondPart;
+    splitMilliseconds(timestamp, second, millisecondPart);
+
+    if (second != cachedUtcSecond) {
+        std::int64_t days = (second >= 0 ? second : second - 86399) / 86400;
+        std::int64_t secondOfDay = second - days * 86400;
+        std::int64_t year;
+        unsigned int month;
+        unsigned int day;
+        civilFromDays(days, year, month, day);
+
+        writeDigits(cachedUtcText, static_cast<unsigned int>(year), 4);
+        cachedUtcText[4] = '-';
+        writeDigits(cachedUtcText + 5, month, 2);
+        cachedUtcText[7] = '-';
+        writeDigits(cachedUtcText + 8, day, 2);
+        cachedUtcText[10] = 'T';
+        writeDigits(cachedUtcText + 11, static_cast<unsigned int>(secondOfDay / 3600), 2);
+        cachedUtcText[13] = ':';
+        writeDigits(cachedUtcText + 14, static_cast<unsigned int>(secondOfDay / 60 % 60), 2);
+        cachedUtcText[16] = ':';
+        writeDigits(cachedUtcText + 17, static_cast<unsigned int>(secondOfDay % 60), 2);
+        cachedUtcSecond = second;
+    }
+
+    std::memcpy(out, cachedUtcText, sizeof(cachedUtcText));
+    out[19] = '.';
+    writeDigits(out + 20, static_cast<unsigned int>(millisecondPart), 3);
+    out[23] = 'Z';
+}
+
+// Re-run the time-zone conversion and rebuild the whole cached text
+void LogTimestampCache::refresh(std::int64_t second) {
+    if (hasFixedOffset) {
+        refreshFixedOffset(second);
+        return;
+    }
+
+    std::time_t inTimeT = static_cast<std::time_t>(second);
+    std::tm timeBuffer;
+
+    #ifdef _WIN32
+    localtime_s(&timeBuffer, &inTimeT);
+    #else
+    localtime_r(&inTimeT, &timeBuffer);
+    #endif
+
+    writeDateTime(cachedText, timeBuffer.tm_year + 1900, static_cast<unsigned int>(timeBuffer.tm_mon + 1),
+                  static_cast<unsigned int>(timeBuffer.tm_mday),
+                  static_cast<unsigned int>(timeBuffer.tm_hour * 3600 + timeBuffer.tm_min * 60 + timeBuffer.tm_sec));
+
+    // A leap second (tm_sec == 60) must not stretch the minute window
+    minuteStart = timeBuffer.tm_sec < 60 ? second - timeBuffer.tm_sec : INT64_MIN;
+}
+
+// The same text from the offset given to setFixedUtcOffset: arithmetic only
+void LogTimestampCache::refreshFixedOffset(std::int64_t second) {
+    std::int64_t local = second + fixedOffset;
+    std::int64_t days = (local >= 0 ? local : local - 86399) / 86400;
+    std::int64_t secondOfDay = local - days * 86400;
+    std::int64_t year;
+    unsigned int month;
+    unsigned int day;
+    civilFromDays(days, year, month, day);
+
+    writeDateTime(cachedText, year, month, day, static_cast<unsigned int>(secondOfDay));
+    minuteStart = second - secondOfDay % 60;
+}
+
+void LogTimestampCache::setFixedUtcOffset(std::int64_t offsetSeconds) {
+    hasFixedOffset = true;
+    fixedOffset = offsetSeconds;
+    cachedSecond = INT64_MIN;
+    minuteStart = INT64_MIN;
+}
+
+// Local time minus UTC at the given moment, in seconds
+std::int64_t LogTimestampCache::utcOffsetAt(std::chrono::system_clock::time_point timestamp) {
+    std::int64_t second;
+    std::int64_t millisecondPart;
+    splitMilliseconds(timestamp, second, millisecondPart);
+
+    std::time_t inTimeT = static_cast<std::time_t>(second);
+    std::tm timeBuffer;
+
+    #ifdef _WIN32
+    localtime_s(&timeBuffer, &inTimeT);
+    #else
+    localtime_r(&inTimeT, &timeBuffer);
+    #endif
+
+    std::int64_t localSeconds = daysFromCivil(timeBuffer.tm_year + 1900, static_cast<unsigned int>(timeBuffer.tm_mon + 1),
+                                              static_cast<unsigned int>(timeBuffer.tm_mday)) * 86400 +
+                                timeBuffer.tm_hour * 3600 + timeBuffer.tm_min * 60 + timeBuffer.tm_sec;
+    return localSeconds - second;
+}
@@ -1,237 +1,1565 @@
-#include "LoggerHandler.hpp"
-#include <ctime>
-#include <filesystem>
-
-#ifndef _WIN32
-#include <unistd.h>
-#endif
-
-// Platform-specific console initialization
-void LoggerHandler::initConsole() {
-    #ifdef _WIN32
-    consoleHandle = GetStdHandle(STD_OUTPUT_HANDLE);
-    if (consoleHandle == INVALID_HANDLE_VALUE) {
-        consoleHandle = nullptr;
-    }
-    #else
-    useColors = isatty(STDOUT_FILENO) != 0;
-    #endif
-}
-
-// Constructor (shared mutex)
-LoggerHandler::LoggerHandler(const std::string& loggerName, std::mutex& consoleMutex)
-: loggerName(loggerName),
-internalMutex(),
-consoleMutex(consoleMutex) {
-    initConsole();
-}
-
-// Constructor (own mutex)
-LoggerHandler::LoggerHandler(const std::string& loggerName)
-: loggerName(loggerName),
-internalMutex(),
-consoleMutex(internalMutex) {
-    initConsole();
-}
-
-// Destructor
-LoggerHandler::~LoggerHandler() {
-    disableFileLogging();
-}
-
-// File logging – enable
-void LoggerHandler::enableFileLogging(const std::string& filePath) {
-    std::lock_guard<std::mutex> fileLock(fileMutex);
-
-    if (logFile.is_open()) {
-        logFile << "=== Switching to new log file ===\n";
-        logFile.close();
-    }
-
-    std::filesystem::path path(filePath);
-    if (path.has_parent_path()) {
-        std::filesystem::create_directories(path.parent_path());
-    }
-
-    logFile.open(filePath, std::ios::app);
-    if (logFile.is_open()) {
-        logFile << "=== Log Started: " << getCurrentTimestamp() << " ===\n";
-        logFile << "Logger: " << loggerName << "\n";
-        logFile << "===================================\n";
-        logFile.flush();
-
-        logToConsole("MESSAGE", "File logging enabled: " + filePath,
-                     FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE);
-    } else {
-        logToConsole("ERROR", "Failed to open log file: " + filePath,
-                     FOREGROUND_RED | FOREGROUND_INTENSITY);
-    }
-}
-
-// File logging – disable
-void LoggerHandler::disableFileLogging() {
-    std::lock_guard<std::mutex> fileLock(fileMutex);
-
-    if (logFile.is_open()) {
-        logFile << "=== Log Ended: " << getCurrentTimestamp() << " ===\n\n";
-        logFile.close();
-
-        logToConsole("MESSAGE", "File logging disabled",
-                     FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE);
-    }
-}
-
-// Timestamp helper
-std::string LoggerHandler::getCurrentTimestamp() {
-    auto now = std::chrono::system_clock::now();
-    auto inTimeT = std::chrono::system_clock::to_time_t(now);
-
-    auto milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(
-        now.time_since_epoch()
-    ) % 1000;
-
-    std::tm timeBuffer;
-
-    #ifdef _WIN32
-    localtime_s(&timeBuffer, &inTimeT);
-    #else
-    localtime_r(&inTimeT, &timeBuffer);
-    #endif
-
-    std::ostringstream oss;
-    oss << std::put_time(&timeBuffer, "%Y-%m-%d %H:%M:%S");
-    oss << '.' << std::setfill('0') << std::setw(3) << milliseconds.count();
-    return oss.str();
-}
-
-// Set console colour
-void LoggerHandler::setConsoleColor(WORD color) {
-    #ifdef _WIN32
-    if (consoleHandle != nullptr) {
-        SetConsoleTextAttribute(consoleHandle, color);
-    }
-    #else
-    if (useColors) {
-        std::string ansiCode = "\033[";
-
-        if (color & FOREGROUND_RED) {
-            if (color & FOREGROUND_INTENSITY) ansiCode += "91;";
-            else ansiCode += "31;";
-        }
-        if (color & FOREGROUND_GREEN) {
-            if (color & FOREGROUND_INTENSITY) ansiCode += "92;";
-            else ansiCode += "32;";
-        }
-        if (color & FOREGROUND_BLUE) {
-            if (color & FOREGROUND_INTENSITY) ansiCode += "94;";
-            else ansiCode += "34;";
-        }
-
-        if ((color & (FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE)) ==
-            (FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE)) {
-            if (color & FOREGROUND_INTENSITY) ansiCode += "97;";
-            else ansiCode += "37;";
-        }
-
-        if ((color & (FOREGROUND_RED | FOREGROUND_GREEN)) ==
-            (FOREGROUND_RED | FOREGROUND_GREEN) &&
-            !(color & FOREGROUND_BLUE)) {
-            if (color & FOREGROUND_INTENSITY) ansiCode += "93;";
-            else ansiCode += "33;";
-        }
-
-        if (ansiCode.back() == ';') {
-            ansiCode.pop_back();
-        }
-        ansiCode += "m";
-        std::cout << ansiCode;
-    }
-    #endif
-}
-
-// Reset console colour
-void LoggerHandler::resetConsoleColor() {
-    #ifdef _WIN32
-    setConsoleColor(FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE);
-    #else
-    if (useColors) {
-        std::cout << "\033[0m";
-    }
-    #endif
-}
-
-// Format a single log line
-std::string LoggerHandler::formatLogLine(const std::string& prefix, const std::string& message) {
-    std::string timestamp = getCurrentTimestamp();
-
-    std::ostringstream formattedMessage;
-    formattedMessage << "[" << timestamp << "] "
-        << "[" << std::left << std::setw(15) << std::setfill('.') << loggerName << "] "
-        << "[" << std::left << std::setw(7) << std::setfill('.') << prefix << "] "
-        << message;
-
-    return formattedMessage.str();
-}
-
-// Log to console
-void LoggerHandler::logToConsole(const std::string& prefix, const std::string& message, WORD color) {
-    std::lock_guard<std::mutex> consoleLock(consoleMutex);
-
-    std::string formattedMessage = formatLogLine(prefix, message);
-
-    setConsoleColor(color);
-    std::cout << formattedMessage << std::endl;
-    resetConsoleColor();
-}
-
-// Log to file
-void LoggerHandler::logToFile(const std::string& prefix, const std::string& message) {
-    std::lock_guard<std::mutex> fileLock(fileMutex);
-
-    if (logFile.is_open()) {
-        try {
-            std::string formattedMessage = formatLogLine(prefix, message);
-            logFile << formattedMessage << std::endl;
-
-            if (prefix == "ERROR") {
-                logFile.flush();
-            }
-        } catch (const std::exception& e) {
-            std::lock_guard<std::mutex> consoleLock(consoleMutex);
-            std::cerr << "ERROR: Failed to write to log file: " << e.what() << std::endl;
-        }
-    }
-}
-
-// Public logging methods
-void LoggerHandler::logMessage(const std::string& message) {
-    logToConsole("MESSAGE", message,
-                 FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE);
-    logToFile("MESSAGE", message);
-}
-
-void LoggerHandler::logSuccess(const std::string& message) {
-    logToConsole("SUCCESS", message,
-                 FOREGROUND_GREEN | FOREGROUND_INTENSITY);
-    logToFile("SUCCESS", message);
-}
-
-void LoggerHandler::logWarning(const std::string& message) {
-    logToConsole("WARNING", message,
-                 FOREGROUND_RED | FOREGROUND_GREEN);
-    logToFile("WARNING", message);
-}
-
-void LoggerHandler::logError(const std::string& message) {
-    logToConsole("ERROR", message,
-                 FOREGROUND_RED | FOREGROUND_INTENSITY);
-    logToFile("ERROR", message);
-
-    std::lock_guard<std::mutex> consoleLock(consoleMutex);
-    std::cout.flush();
-
-    std::lock_guard<std::mutex> fileLock(fileMutex);
-    if (logFile.is_open()) {
-        logFile.flush();
-    }
+#include "LoggerHandler.hpp"
+#include "LogTimestamp.hpp"
+#include "LogCrashHandler.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+
+// Records the asynchronous writer hands to the sinks in one batch
+static constexpr std::size_t writerBatchSize = 256;
+
+// Source of LoggerHandler::threadBufferOwner values (0 is never used)
+static std::atomic<std::uint64_t> nextThreadBufferOwner{1};
+
+// One timestamp cache per thread: the writer thread in async mode, each caller otherwise
+static LogTimestampCache& threadTimestampCache() {
+    thread_local LogTimestampCache timestampCache;
+    return timestampCache;
+}
+
+// Per-thread batches, reused so the steady state never allocates
+static LogSinkBatch& threadTextBatch() {
+    thread_local LogSinkBatch textBatch(LogSinkFormat::Text);
+    return textBatch;
+}
+
+static LogSinkBatch& threadBinaryBatch() {
+    thread_local LogSinkBatch binaryBatch(LogSinkFormat::Binary);
+    return binaryBatch;
+}
+
+// Re-encode a text batch as binary records (the message is what follows each
+// prefix). A call site is defined just before the first record that uses it;
+// the caller holds sinkMutex.
+const LogSinkBatch& LoggerHandler::encodeBinaryBatch(const LogSinkBatch& textBatch) {
+    thread_local LogLineBuffer encodedRecord;
+    LogSinkBatch& binaryBatch = threadBinaryBatch();
+    binaryBatch.clear();
+
+    for (const LogSinkEntry& entry : textBatch.entries()) {
+        auto nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(entry.timestamp.time_since_epoch());
+        const char* message = textBatch.data() + entry.offset + entry.messageOffset;
+        std::size_t messageLength = entry.length - 1 - entry.messageOffset;
+        const LogCallSite* site = LogCallSites::find(entry.callSite);
+        encodedRecord.clear();
+
+        if (site == nullptr) {
+            LogBinaryFormat::appendRecord(encodedRecord, nanoseconds.count(), entry.level, 0, message, messageLength);
+        } else {
+            if (entry.callSite >= definedCallSites.size() || !definedCallSites[entry.callSite]) {
+                if (entry.callSite >= definedCallSites.size()) {
+                    definedCallSites.resize(entry.callSite + 1);
+                }
+                definedCallSites[entry.callSite] = true;
+                LogBinaryFormat::appendCallSite(encodedRecord, entry.callSite, *site);
+                if (fileSink && fileSink->getFormat() == LogSinkFormat::Binary) {
+                    binaryPreamble.append(encodedRecord.data(), encodedRecord.size());
+                    fileSink->setFilePreamble(binaryPreamble);
+                }
+            }
+            LogBinaryFormat::appendSiteRecord(encodedRecord, nanoseconds.count(), entry.level, 0, entry.thread,
+                                              entry.callSite, message, messageLength);
+        }
+        binaryBatch.append(entry.timestamp, entry.level, encodedRecord.data(), encodedRecord.size());
+    }
+    return binaryBatch;
+}
+
+// Re-encode a text batch as JSON or logfmt lines from each entry's message and fields
+static const LogSinkBatch& encodeStructuredBatch(const LogSinkBatch& textBatch, LogSinkFormat format,
+                                                 const std::string& loggerName) {
+    thread_local LogLineBuffer encodedLine;
+    thread_local LogSinkBatch jsonBatch(LogSinkFormat::Json);
+    thread_local LogSinkBatch logfmtBatch(LogSinkFormat::Logfmt);
+    LogSinkBatch& structuredBatch = format == LogSinkFormat::Json ? jsonBatch : logfmtBatch;
+    structuredBatch.clear();
+
+    for (const LogSinkEntry& entry : textBatch.entries()) {
+        std::string_view message(textBatch.data() + entry.offset + entry.messageOffset, entry.messageLength);
+        const char* fields = textBatch.fieldData() + entry.fieldsOffset;
+        encodedLine.clear();
+        if (format == LogSinkFormat::Json) {
+            LogStructuredFormat::appendJsonRecord(encodedLine, entry.timestamp, entry.level, loggerName, message,
+                                                  fields, entry.fieldsLength, threadTimestampCache(),
+                                                  entry.thread, entry.callSite);
+        } else {
+            LogStructuredFormat::appendLogfmtRecord(encodedLine, entry.timestamp, entry.level, loggerName, message,
+                                                    fields, entry.fieldsLength, threadTimestampCache(),
+                                                    entry.thread, entry.callSite);
+        }
+        structuredBatch.appendLine(entry.timestamp, entry.level, encodedLine.data(), encodedLine.size(), 0);
+    }
+    return structuredBatch;
+}
+
+// Constructor (shared mutex)
+LoggerHandler::LoggerHandler(const std::string& loggerName, std::mutex& consoleMutex)
+: loggerName(loggerName),
+internalMutex(),
+consoleMutex(consoleMutex),
+consoleSink(std::make_shared<LogConsoleSink>(consoleMutex)),
+sinks{consoleSink} {
+    installLayout(std::make_unique<LogPatternLayout<logDefaultPattern>>(loggerName));
+    LogCrashHandler::registerLogger(this);
+}
+
+// Constructor (own mutex)
+LoggerHandler::LoggerHandler(const std::string& loggerName)
+: loggerName(loggerName),
+internalMutex(),
+consoleMutex(internalMutex),
+consoleSink(std::make_shared<LogConsoleSink>(internalMutex)),
+sinks{consoleSink} {
+    installLayout(std::make_unique<LogPatternLayout<logDefaultPattern>>(loggerName));
+    LogCrashHandler::registerLogger(this);
+}
+
+// Constructor (given sinks; nothing is opened or probed, so it is cheap)
+LoggerHandler::LoggerHandler(const std::string& loggerName, const std::vector<std::shared_ptr<LogSink>>& sinks)
+: loggerName(loggerName),
+internalMutex(),
+consoleMutex(internalMutex),
+sinks(sinks) {
+    for (const auto& sink : sinks) {
+        if (auto console = std::dynamic_pointer_cast<LogConsoleSink>(sink)) {
+            consoleSink = console;
+            break;
+        }
+    }
+    installLayout(std::make_unique<LogPatternLayout<logDefaultPattern>>(loggerName));
+    LogCrashHandler::registerLogger(this);
+}
+
+// Destructor
+LoggerHandler::~LoggerHandler() {
+    LogCrashHandler::unregisterLogger(this);
+    flushRepeats();
+    disableAsyncLogging();
+    disableFileLogging();
+}
+
+// File logging – enable
+void LoggerHandler::enableFileLogging(const std::string& filePath) {
+    enableFileLogging(filePath, LogFlushPolicy());
+}
+
+void LoggerHandler::enableFileLogging(const std::string& filePath, const LogFlushPolicy& flushPolicy,
+                                      const LogRotationPolicy& rotationPolicy,
+                                      const LogCompressionPolicy& compressionPolicy) {
+    // Records queued before the switch belong to the previous file
+    drainQueue();
+
+    std::lock_guard<std::mutex> sinkLock(sinkMutex);
+    prepareFileSwitch(filePath);
+
+    if (!fileSink || fileSink->getFormat() != LogSinkFormat::Text) {
+        fileSink = std::make_shared<LogFileSink>(LogSinkFormat::Text);
+    }
+    fileSink->setFlushPolicy(flushPolicy);
+    fileSink->setRotationPolicy(rotationPolicy);
+    fileSink->setCompressionPolicy(compressionPolicy);
+    finishFileSwitch(filePath, fileSink, fileSink->open(filePath));
+}
+
+// File logging – enable (binary records)
+void LoggerHandler::enableBinaryFileLogging(const std::string& filePath, const LogFlushPolicy& flushPolicy,
+                                            const LogRotationPolicy& rotationPolicy) {
+    drainQueue();
+
+    std::lock_guard<std::mutex> sinkLock(sinkMutex);
+    prepareFileSwitch(filePath);
+
+    // Every file (and every rotated successor) starts with the header and this logger's name
+    std::string preamble;
+    LogBinaryFormat::appendFileHeader(preamble);
+    LogBinaryFormat::appendLoggerName(preamble, 0, loggerName);
+    binaryPreamble = preamble;
+    definedCallSites.clear();
+
+    if (!fileSink || fileSink->getFormat() != LogSinkFormat::Binary) {
+        fileSink = std::make_shared<LogFileSink>(LogSinkFormat::Binary);
+    }
+    fileSink->setFlushPolicy(flushPolicy);
+    fileSink->setRotationPolicy(rotationPolicy);
+    fileSink->setFilePreamble(preamble);
+    finishFileSwitch(filePath, fileSink, fileSink->open(filePath));
+}
+
+// File logging – enable (JSON lines or logfmt)
+void LoggerHandler::enableStructuredFileLogging(const std::string& filePath, LogSinkFormat format,
+                                                const LogFlushPolicy& flushPolicy,
+                                                const LogRotationPolicy& rotationPolicy) {
+    if (format != LogSinkFormat::Json && format != LogSinkFormat::Logfmt) {
+        logToConsole(LogLevel::Error, "Structured file logging needs the Json or Logfmt format: " + filePath);
+        return;
+    }
+    drainQueue();
+
+    std::lock_guard<std::mutex> sinkLock(sinkMutex);
+    prepareFileSwitch(filePath);
+
+    if (!fileSink || fileSink->getFormat() != format) {
+        fileSink = std::make_shared<LogFileSink>(format);
+    }
+    fileSink->setFlushPolicy(flushPolicy);
+    fileSink->setRotationPolicy(rotationPolicy);
+    fileSink->setFilePreamble(std::string());
+    finishFileSwitch(filePath, fileSink, fileSink->open(filePath));
+}
+
+// File logging – enable (memory-mapped)
+void LoggerHandler::enableMappedFileLogging(const std::string& filePath, std::size_t chunkSize) {
+    drainQueue();
+
+    std::lock_guard<std::mutex> sinkLock(sinkMutex);
+    prepareFileSwitch(filePath);
+
+    if (!mmapSink) {
+        mmapSink = std::make_shared<LogMmapSink>();
+    }
+    finishFileSwitch(filePath, mmapSink, mmapSink->open(filePath, chunkSize));
+}
+
+// File logging – disable
+void LoggerHandler::disableFileLogging() {
+    // Make sure every queued record reaches the file before it is closed
+    drainQueue();
+
+    std::lock_guard<std::mutex> sinkLock(sinkMutex);
+
+    if (isFileOpen()) {
+        writeFileBanner("=== Log Ended: " + getCurrentTimestamp() + " ===\n\n");
+        closeFile();
+
+        logToConsole(LogLevel::Message, "File logging disabled");
+    }
+}
+
+// Close the current file (if any) and create the new file's directories
+void LoggerHandler::prepareFileSwitch(const std::string& filePath) {
+    if (isFileOpen()) {
+        writeFileBanner("=== Switching to new log file ===\n");
+        closeFile();
+    }
+
+    std::filesystem::path path(filePath);
+    if (path.has_parent_path()) {
+        std::filesystem::create_directories(path.parent_path());
+    }
+}
+
+// Write the start banner and report the outcome of opening a file
+void LoggerHandler::finishFileSwitch(const std::string& filePath, const std::shared_ptr<LogSink>& sink,
+                                     bool opened) {
+    if (opened) {
+        writeFileBanner("=== Log Started: " + getCurrentTimestamp() + " ===\n" +
+                        "Logger: " + loggerName + "\n" +
+                        "===================================\n");
+        sink->flush();
+        attachSink(sink);
+
+        logToConsole(LogLevel::Message, "File logging enabled: " + filePath);
+    } else {
+        logToConsole(LogLevel::Error, "Failed to open log file: " + filePath);
+    }
+}
+
+bool LoggerHandler::isFileOpen() const {
+    return (fileSink && fileSink->isOpen()) || (mmapSink && mmapSink->isOpen());
+}
+
+void LoggerHandler::closeFile() {
+    if (fileSink) {
+        fileSink->close();
+        detachSink(fileSink);
+    }
+    if (mmapSink) {
+        mmapSink->close();
+        detachSink(mmapSink);
+    }
+}
+
+// Write a banner line straight into the file, bypassing the flush policy
+void LoggerHandler::writeFileBanner(const std::string& banner) {
+    if (mmapSink && mmapSink->isOpen()) {
+        mmapSink->writeRaw(banner.data(), banner.size());
+    } else if (fileSink && fileSink->getFormat() == LogSinkFormat::Text) {
+        // Binary files carry only records
+        fileSink->writeRaw(banner.data(), banner.size());
+    }
+}
+
+// Sink list
+void LoggerHandler::addSink(std::shared_ptr<LogSink> sink) {
+    if (!sink) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> sinkLock(sinkMutex);
+    attachSink(sink);
+}
+
+void LoggerHandler::removeSink(const std::shared_ptr<LogSink>& sink) {
+    // Queued records still go to the sink being removed
+    drainQueue();
+
+    std::lock_guard<std::mutex> sinkLock(sinkMutex);
+    if (isAttached(sink)) {
+        detachSink(sink);
+        sink->flush();
+    }
+}
+
+const std::shared_ptr<LogConsoleSink>& LoggerHandler::getConsoleSink() const {
+    return consoleSink;
+}
+
+// Crash dump slots: stable positions, so a dump racing an update sees
+// each entry at most once
+template <typename Item, std::size_t Count>
+static void setCrashSlot(std::atomic<Item*> (&slots)[Count], Item* item) {
+    for (auto& slot : slots) {
+        if (slot.load(std::memory_order_relaxed) == nullptr) {
+            slot.store(item, std::memory_order_release);
+            return;
+        }
+    }
+}
+
+template <typename Item, std::size_t Count>
+static void clearCrashSlot(std::atomic<Item*> (&slots)[Count], Item* item) {
+    for (auto& slot : slots) {
+        if (slot.load(std::memory_order_relaxed) == item) {
+            slot.store(nullptr, std::memory_order_release);
+            return;
+        }
+    }
+}
+
+void LoggerHandler::attachSink(const std::shared_ptr<LogSink>& sink) {
+    if (!isAttached(sink)) {
+        sinks.push_back(sink);
+        setCrashSlot(crashSinks, sink.get());
+        // A new sink has seen none of the call-site definitions
+        definedCallSites.clear();
+    }
+}
+
+void LoggerHandler::detachSink(const std::shared_ptr<LogSink>& sink) {
+    if (isAttached(sink)) {
+        clearCrashSlot(crashSinks, sink.get());
+    }
+    sinks.erase(std::remove(sinks.begin(), sinks.end(), sink), sinks.end());
+}
+
+bool LoggerHandler::isAttached(const std::shared_ptr<LogSink>& sink) const {
+    return std::find(sinks.begin(), sinks.end(), sink) != sinks.end();
+}
+
+// Flush everything written so far to the console and file
+void LoggerHandler::flush() {
+    flushRepeats();
+    drainQueue();
+
+    std::lock_guard<std::mutex> sinkLock(sinkMutex);
+    for (const auto& sink : sinks) {
+        sink->flush();
+    }
+}
+
+// Asynchronous logging – enable
+void LoggerHandler::enableAsyncLogging(std::size_t capacity, LogOverflowPolicy policy) {
+    // Restart the writer so the new settings apply to an empty queue
+    disableAsyncLogging();
+
+    if (!asyncQueue || asyncQueue->capacity() < capacity) {
+        asyncQueue = std::make_unique<LogRingBuffer<LogRecord>>(capacity);
+    }
+    overflowPolicy = policy;
+    stopWriter = false;
+    writerThread = std::thread(&LoggerHandler::writerLoop, this);
+    asyncEnabled.store(true, std::memory_order_release);
+}
+
+// Asynchronous logging – disable (drains the queue before returning)
+void LoggerHandler::disableAsyncLogging() {
+    if (!writerThread.joinable()) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> drainLock(drainMutex);
+    asyncEnabled.store(false, std::memory_order_seq_cst);
+    stopWriter = true;
+    writerThread.join();
+
+    // Producers that raced with the switch-off may still have published records
+    drainRemaining();
+
+    if (threadBuffered) {
+        std::lock_guard<std::mutex> bufferLock(threadBufferMutex);
+        for (auto& slot : crashThreadBuffers) {
+            slot.store(nullptr, std::memory_order_release);
+        }
+        threadBuffers.clear();
+        ++threadBufferGeneration;
+        threadBuffered = false;
+    }
+}
+
+// Thread-buffered logging – enable
+void LoggerHandler::enableThreadBufferedLogging(std::size_t perThreadCapacity, LogMergeOrder order,
+                                                LogOverflowPolicy policy) {
+    disableAsyncLogging();
+
+    threadBufferCapacity = perThreadCapacity;
+    threadBufferOwner = nextThreadBufferOwner.fetch_add(1, std::memory_order_relaxed);
+    mergeOrder = order;
+    overflowPolicy = policy;
+    threadBuffered = true;
+    stopWriter = false;
+    writerThread = std::thread(&LoggerHandler::writerLoop, this);
+    asyncEnabled.store(true, std::memory_order_release);
+}
+
+// The calling thread's buffer for this logger, registered on first use
+LoggerHandler::ThreadBuffer& LoggerHandler::localThreadBuffer() {
+    // One entry per logger this thread has logged to; an entry marks its
+    // buffer abandoned when the thread exits
+    struct CacheEntry {
+        CacheEntry(std::uint64_t owner, std::shared_ptr<ThreadBuffer> buffer)
+        : owner(owner), buffer(std::move(buffer)) {
+        }
+        CacheEntry(CacheEntry&&) = default;
+        CacheEntry& operator=(CacheEntry&&) = default;
+        ~CacheEntry() {
+            if (buffer) {
+                buffer->abandoned.store(true, std::memory_order_release);
+            }
+        }
+
+        std::uint64_t owner;
+        std::shared_ptr<ThreadBuffer> buffer;
+    };
+    thread_local std::vector<CacheEntry> cache;
+
+    for (CacheEntry& entry : cache) {
+        if (entry.owner == threadBufferOwner) {
+            return *entry.buffer;
+        }
+    }
+
+    // Forget buffers their logger has already let go of
+    cache.erase(std::remove_if(cache.begin(), cache.end(),
+                               [](const CacheEntry& entry) { return entry.buffer.use_count() == 1; }),
+                cache.end());
+
+    auto buffer = std::make_shared<ThreadBuffer>(threadBufferCapacity);
+    {
+        std::lock_guard<std::mutex> bufferLock(threadBufferMutex);
+        threadBuffers.push_back(buffer);
+        setCrashSlot(crashThreadBuffers, buffer.get());
+        ++threadBufferGeneration;
+    }
+    cache.emplace_back(threadBufferOwner, buffer);
+    return *buffer;
+}
+
+// The ring a producer publishes to: the shared queue or its own buffer
+LogRingBuffer<LoggerHandler::LogRecord>& LoggerHandler::producerQueue() {
+    return threadBuffered ? localThreadBuffer().records : *asyncQueue;
+}
+
+// Asynchronous queue counters
+std::size_t LoggerHandler::getQueueDepth() const {
+    return queuedRecords();
+}
+
+std::size_t LoggerHandler::getQueueCapacity() const {
+    if (threadBuffered) {
+        return threadBufferCapacity;
+    }
+    return asyncQueue ? asyncQueue->capacity() : 0;
+}
+
+std::size_t LoggerHandler::queuedRecords() const {
+    if (threadBuffered) {
+        std::lock_guard<std::mutex> bufferLock(threadBufferMutex);
+        std::size_t depth = 0;
+        for (const auto& buffer : threadBuffers) {
+            depth += buffer->records.size();
+        }
+        return depth;
+    }
+    return asyncQueue ? asyncQueue->size() : 0;
+}
+
+std::uint64_t LoggerHandler::getDroppedRecords() const {
+    return metrics.getDroppedRecords();
+}
+
+// Queue a record for the writer thread, returns false if the caller must write it
+bool LoggerHandler::enqueueRecord(LogRecord&& record) {
+    std::uint64_t enqueueStarted = metrics.startTimer();
+    LogRingBuffer<LogRecord>& queue = producerQueue();
+
+    while (!queue.tryPush(std::move(record))) {
+        switch (overflowPolicy) {
+        case LogOverflowPolicy::Block:
+            if (stopWriter.load(std::memory_order_relaxed)) {
+                return false;
+            }
+            std::this_thread::yield();
+            break;
+        case LogOverflowPolicy::DropNewest:
+            metrics.countDropped();
+            return true;
+        case LogOverflowPolicy::DropOldest: {
+            LogRecord oldest;
+            if (queue.tryPop(oldest)) {
+                metrics.countDropped();
+            }
+            break;
+        }
+        }
+    }
+    metrics.recordEnqueue(enqueueStarted);
+
+    // If async mode was switched off while we were publishing, the writer may
+    // already be gone, so write out whatever is left ourselves, once the
+    // switch-off has joined the writer and made its own final drain
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!asyncEnabled.load(std::memory_order_relaxed)) {
+        std::lock_guard<std::mutex> drainLock(drainMutex);
+        if (!asyncEnabled.load(std::memory_order_acquire)) {
+            drainRemaining();
+        } else if (&queue == asyncQueue.get() || isListed(queue)) {
+            return true; // switched back on: the new writer owns the queue
+        }
+
+        // Our own buffer may already be unlisted if thread buffering was switched off
+        LogSinkBatch& batch = threadTextBatch();
+        batch.clear();
+        drainRing(queue, batch);
+        if (!batch.empty()) {
+            writeBatch(batch);
+        }
+    }
+    return true;
+}
+
+// Whether a ring is one of the thread buffers the writer drains
+bool LoggerHandler::isListed(const LogRingBuffer<LogRecord>& ring) const {
+    std::lock_guard<std::mutex> bufferLock(threadBufferMutex);
+    return std::any_of(threadBuffers.begin(), threadBuffers.end(),
+                       [&ring](const std::shared_ptr<ThreadBuffer>& buffer) { return &buffer->records == &ring; });
+}
+
+// Writer thread – drains the ring until asked to stop and the ring is empty
+void LoggerHandler::writerLoop() {
+    LogSinkBatch& batch = threadTextBatch();
+    unsigned int idleRounds = 0;
+
+    while (true) {
+        writerBusy = true;
+        batch.clear();
+        bool wroteAny = threadBuffered ? collectThreadBuffers(batch) : writeQueued(batch);
+        if (!batch.empty()) {
+            writeBatch(batch);
+        }
+        writerBusy = false;
+
+        if (wroteAny) {
+            idleRounds = 0;
+            continue;
+        }
+        flushSinksIfDue();
+        if (stopWriter && queuedRecords() == 0) {
+            break;
+        }
+
+        // Back off gradually so an idle writer does not burn a core
+        if (idleRounds < 64) {
+            ++idleRounds;
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    // Let threads' caches see that their buffers are no longer in use
+    collectorBuffers.clear();
+    mergeRecords.clear();
+}
+
+// Writer thread – everything in the shared queue
+bool LoggerHandler::writeQueued(LogSinkBatch& batch) {
+    metrics.noteQueueDepth(asyncQueue->size());
+    LogRecord record;
+    bool wroteAny = false;
+    while (asyncQueue->tryPop(record)) {
+        writePopped(batch, record);
+        wroteAny = true;
+    }
+    return wroteAny;
+}
+
+// Writer thread – one merge round over the per-thread buffers
+bool LoggerHandler::collectThreadBuffers(LogSinkBatch& batch) {
+    {
+        std::lock_guard<std::mutex> bufferLock(threadBufferMutex);
+
+        // A buffer whose thread has exited goes once it is empty
+        auto isFinished = [](const std::shared_ptr<ThreadBuffer>& buffer) {
+            return buffer->abandoned.load(std::memory_order_acquire) && buffer->records.size() == 0;
+        };
+        for (const auto& buffer : threadBuffers) {
+            if (isFinished(buffer)) {
+                clearCrashSlot(crashThreadBuffers, buffer.get());
+            }
+        }
+        auto finished = std::remove_if(threadBuffers.begin(), threadBuffers.end(), isFinished);
+        if (finished != threadBuffers.end()) {
+            threadBuffers.erase(finished, threadBuffers.end());
+            ++threadBufferGeneration;
+        }
+
+        if (collectorGeneration != threadBufferGeneration) {
+            collectorBuffers = threadBuffers;
+            collectorGeneration = threadBufferGeneration;
+        }
+    }
+
+    // At most one buffer's worth per thread per round, so a busy thread
+    // cannot hold back the others
+    std::size_t depth = 0;
+    for (const auto& buffer : collectorBuffers) {
+        depth += buffer->records.size();
+    }
+    metrics.noteQueueDepth(depth);
+
+    LogRecord record;
+    bool wroteAny = false;
+    if (mergeOrder == LogMergeOrder::PerThread) {
+        for (const auto& buffer : collectorBuffers) {
+            for (std::size_t i = 0; i < threadBufferCapacity && buffer->records.tryPop(record); ++i) {
+                writePopped(batch, record);
+                wroteAny = true;
+            }
+        }
+        return wroteAny;
+    }
+
+    mergeRecords.clear();
+    for (const auto& buffer : collectorBuffers) {
+        for (std::size_t i = 0; i < threadBufferCapacity && buffer->records.tryPop(record); ++i) {
+            mergeRecords.push_back(std::move(record));
+        }
+    }
+    std::stable_sort(mergeRecords.begin(), mergeRecords.end(), [](const LogRecord& a, const LogRecord& b) {
+        return a.timestamp < b.timestamp;
+    });
+    for (const LogRecord& merged : mergeRecords) {
+        writePopped(batch, merged);
+    }
+    return !mergeRecords.empty();
+}
+
+// Add a dequeued record to the batch, delivering it once it is full
+void LoggerHandler::writePopped(LogSinkBatch& batch, const LogRecord& record) {
+    addRecord(batch, record);
+    if (batch.count() >= writerBatchSize) {
+        writeBatch(batch);
+        batch.clear();
+    }
+}
+
+void LoggerHandler::drainRing(LogRingBuffer<LogRecord>& ring, LogSinkBatch& batch) {
+    LogRecord record;
+    while (ring.tryPop(record)) {
+        writePopped(batch, record);
+    }
+}
+
+// Apply the time-based flush limits while there is nothing to write
+void LoggerHandler::flushSinksIfDue() {
+    {
+        std::lock_guard<std::mutex> sinkLock(sinkMutex);
+        for (const auto& sink : sinks) {
+            sink->flushIfDue();
+        }
+    }
+    writeMetricsIfDue();
+}
+
+// Block until the writer thread has written everything queued so far
+void LoggerHandler::drainQueue() {
+    if (!asyncEnabled.load(std::memory_order_acquire)) {
+        return;
+    }
+
+    while (queuedRecords() > 0 || writerBusy) {
+        std::this_thread::yield();
+    }
+}
+
+// Write any records left in the queues on the calling thread
+void LoggerHandler::drainRemaining() {
+    LogSinkBatch& batch = threadTextBatch();
+    batch.clear();
+
+    if (asyncQueue) {
+        drainRing(*asyncQueue, batch);
+    }
+
+    std::vector<std::shared_ptr<ThreadBuffer>> remaining;
+    {
+        std::lock_guard<std::mutex> bufferLock(threadBufferMutex);
+        remaining = threadBuffers;
+    }
+    for (const auto& buffer : remaining) {
+        drainRing(buffer->records, batch);
+    }
+
+    if (!batch.empty()) {
+        writeBatch(batch);
+    }
+}
+
+// Render a record once and hand the same bytes to every output
+void LoggerHandler::writeRecord(const LogLineContext& line, std::string_view message, float sampleRate) {
+    std::uint64_t formatStarted = metrics.startTimer();
+    LogLineBuffer& formattedLine = beginLine(line);
+    formattedLine.append(message.data(), message.size());
+    appendSampleRate(formattedLine, sampleRate);
+    metrics.recordFormat(formatStarted);
+    writeLine(formattedLine, line);
+}
+
+// Render a queued record into a batch
+void LoggerHandler::addRecord(LogSinkBatch& batch, const LogRecord& record) {
+    LogReclaimer::ReadGuard guard;
+    std::string_view message = record.message();
+    if (record.batch) {
+        addBatchLines(batch, message, record.thread);
+        return;
+    }
+
+    std::uint64_t formatStarted = metrics.startTimer();
+
+    LogLineContext line{record.timestamp, record.level, record.thread, record.callSite};
+    LogLineBuffer& formattedLine = beginLine(line);
+    if (record.format == nullptr) {
+        formattedLine.append(message.data(), message.size());
+    } else {
+        // Deferred record: the arguments are formatted here, on the writer thread
+        LogFormatter::formatEncoded(formattedLine, record.format, message.data(), message.size());
+    }
+    appendSampleRate(formattedLine, record.sampleRate);
+    std::string_view fields = record.fields();
+    if (fields.empty()) {
+        metrics.recordFormat(formatStarted);
+        addLine(batch, formattedLine, line);
+        return;
+    }
+
+    std::size_t messageLength = formattedLine.size() - formattedLine.messageOffset();
+    LogStructuredFormat::appendLogfmtFields(formattedLine, fields.data(), fields.size());
+    metrics.recordFormat(formatStarted);
+    addLine(batch, formattedLine, line, messageLength, fields);
+}
+
+// Start a line in this thread's buffer with the timestamp, name and level fields
+// (the caller holds a LogReclaimer guard)
+LogLineBuffer& LoggerHandler::beginLine(const LogLineContext& line) {
+    // Reused for every line this thread formats, so the steady state never allocates
+    thread_local LogLineBuffer formattedLine;
+    formatPrefix(line, formattedLine);
+    return formattedLine;
+}
+
+// Hand a finished line to every sink as a batch of one
+void LoggerHandler::writeLine(const LogLineBuffer& formattedLine, const LogLineContext& line) {
+    LogSinkBatch& batch = threadTextBatch();
+    batch.clear();
+    addLine(batch, formattedLine, line);
+    writeBatch(batch);
+}
+
+void LoggerHandler::addLine(LogSinkBatch& batch, const LogLineBuffer& formattedLine, const LogLineContext& line,
+                            std::size_t messageLength, std::string_view fields) {
+    batch.appendLine(line.timestamp, line.level, formattedLine.data(), formattedLine.size(),
+                     formattedLine.messageOffset(), messageLength, fields.data(), fields.size(),
+                     line.thread, line.callSite);
+}
+
+// Deliver a batch to every sink, encoding it once per format the sinks use
+void LoggerHandler::writeBatch(const LogSinkBatch& textBatch) {
+    std::unique_lock<std::mutex> sinkLock(sinkMutex);
+
+    const LogSinkBatch* binaryBatch = nullptr;
+    const LogSinkBatch* jsonBatch = nullptr;
+    const LogSinkBatch* logfmtBatch = nullptr;
+    for (const auto& sink : sinks) {
+        const LogSinkBatch* batch = &textBatch;
+        if (sink->getFormat() == LogSinkFormat::Binary) {
+            if (binaryBatch == nullptr) {
+                binaryBatch = &encodeBinaryBatch(textBatch);
+            }
+            batch = binaryBatch;
+        } else if (sink->getFormat() == LogSinkFormat::Json) {
+            if (jsonBatch == nullptr) {
+                jsonBatch = &encodeStructuredBatch(textBatch, LogSinkFormat::Json, loggerName);
+            }
+            batch = jsonBatch;
+        } else if (sink->getFormat() == LogSinkFormat::Logfmt) {
+            if (logfmtBatch == nullptr) {
+                logfmtBatch = &encodeStructuredBatch(textBatch, LogSinkFormat::Logfmt, loggerName);
+            }
+            batch = logfmtBatch;
+        }
+
+        std::uint64_t writeStarted = metrics.startTimer();
+        try {
+            sink->write(*batch);
+        } catch (const std::exception& e) {
+            std::lock_guard<std::mutex> consoleLock(consoleMutex);
+            std::cerr << "ERROR: Failed to write to log sink: " << e.what() << std::endl;
+        }
+        metrics.recordWrite(writeStarted);
+        countSinkWrite(*sink, *batch);
+    }
+
+    sinkLock.unlock();
+    writeMetricsIfDue();
+}
+
+// Self-metrics – what a sink takes of a batch (the records passing its level)
+void LoggerHandler::countSinkWrite(LogSink& sink, const LogSinkBatch& batch) {
+    if (sink.acceptsAll(batch)) {
+        sink.countWritten(batch.count(), batch.size());
+        return;
+    }
+
+    std::uint64_t records = 0;
+    std::uint64_t bytes = 0;
+    for (const LogSinkEntry& entry : batch.entries()) {
+        if (sink.accepts(entry.level)) {
+            ++records;
+            bytes += entry.length;
+        }
+    }
+    sink.countWritten(records, bytes);
+}
+
+// Self-metrics – snapshot and settings
+LogMetricsSnapshot LoggerHandler::getMetrics() const {
+    LogMetricsSnapshot snapshot;
+    metrics.snapshot(snapshot);
+    snapshot.queueCapacity = getQueueCapacity();
+
+    std::lock_guard<std::mutex> sinkLock(sinkMutex);
+    for (const auto& sink : sinks) {
+        snapshot.sinks.push_back(LogSinkMetrics{sink.get(), sink->getFormat(), sink->getWrittenRecords(),
+                                                sink->getWrittenBytes(), sink->getFlushes()});
+    }
+    return snapshot;
+}
+
+void LoggerHandler::setLatencyMetrics(bool enabled) {
+    metrics.setTiming(enabled);
+}
+
+void LoggerHandler::setMetricsInterval(std::chrono::milliseconds interval) {
+    std::uint64_t nanoseconds = interval.count() > 0
+        ? static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(interval).count())
+        : 0;
+    nextMetricsLine.store(LogMetrics::now() + nanoseconds, std::memory_order_relaxed);
+    metricsInterval.store(nanoseconds, std::memory_order_relaxed);
+}
+
+// Self-metrics – the periodic summary line, written by whichever thread
+// first finds it due (the caller must not hold sinkMutex)
+void LoggerHandler::writeMetricsIfDue() {
+    std::uint64_t interval = metricsInterval.load(std::memory_order_relaxed);
+    if (interval == 0) {
+        return;
+    }
+
+    std::uint64_t now = LogMetrics::now();
+    std::uint64_t due = nextMetricsLine.load(std::memory_order_relaxed);
+    if (now < due || !nextMetricsLine.compare_exchange_strong(due, now + interval, std::memory_order_relaxed)) {
+        return;
+    }
+
+    std::string summary = "Logger metrics: " + getMetrics().summary();
+    LogLineContext line{std::chrono::system_clock::now(), LogLevel::Message, logThreadId()};
+    LogReclaimer::ReadGuard guard;
+    LogLineBuffer& formattedLine = beginLine(line);
+    formattedLine.append(summary);
+
+    // Not the thread's text batch: the caller may still be using it
+    thread_local LogSinkBatch metricsBatch(LogSinkFormat::Text);
+    metricsBatch.clear();
+    addLine(metricsBatch, formattedLine, line);
+    writeBatch(metricsBatch);
+}
+
+// Runtime level filtering
+void LoggerHandler::setMinLevel(LogLevel level) {
+    updateConfig([level](LogConfig& next) { next.minLevel = level; });
+}
+
+LogLevel LoggerHandler::getMinLevel() const {
+    LogReclaimer::ReadGuard guard;
+    return currentConfig().minLevel;
+}
+
+// Configuration – snapshots are never changed once published. A replaced
+// one goes to the reclaimer, since a logging thread may still be reading
+// it; publishing a snapshot equal to the current one changes nothing.
+LogConfig LoggerHandler::getConfig() const {
+    LogReclaimer::ReadGuard guard;
+    return currentConfig();
+}
+
+void LoggerHandler::setConfig(const LogConfig& newConfig) {
+    if (!newConfig.collapseRepeats) {
+        flushRepeats();
+    }
+    std::lock_guard<std::mutex> configLock(configMutex);
+    publishConfig(newConfig);
+}
+
+void LoggerHandler::publishConfig(const LogConfig& newConfig) {
+    if (*config.load(std::memory_order_relaxed) == newConfig) {
+        return;
+    }
+
+    std::shared_ptr<const LogConfig> replaced = std::move(publishedConfig);
+    publishedConfig = newConfig == defaultConfig ? nullptr : std::make_shared<const LogConfig>(newConfig);
+    publishedMinLevel.store(static_cast<std::uint8_t>(newConfig.minLevel), std::memory_order_release);
+    config.store(publishedConfig ? publishedConfig.get() : &defaultConfig, std::memory_order_seq_cst);
+    reclaimer.retire(std::move(replaced));
+}
+
+std::size_t LoggerHandler::getRetiredSnapshots() const {
+    return reclaimer.getRetiredCount();
+}
+
+// Configuration – a config file's settings for this logger
+bool LoggerHandler::applyConfig(const LogConfigFile& file) {
+    if (!file.isValid()) {
+        std::lock_guard<std::mutex> sinkLock(sinkMutex);
+        logToConsole(LogLevel::Error, "Config not applied: " + file.error());
+        return false;
+    }
+    LogConfigSettings settings = file.settingsFor(loggerName);
+
+    // Level, sampling and repeat collapsing change together
+    if (settings.collapseRepeats && !*settings.collapseRepeats) {
+        flushRepeats();
+    }
+    updateConfig([&settings](LogConfig& next) {
+        if (settings.minLevel) {
+            next.minLevel = *settings.minLevel;
+        }
+        for (std::size_t index = 0; index < levelCount; ++index) {
+            if (settings.sampling[index]) {
+                next.sampleRates[index] = settings.sampling[index]->rate;
+                next.sampleCounted[index] = settings.sampling[index]->counted;
+            }
+        }
+        if (settings.collapseRepeats) {
+            next.collapseRepeats = *settings.collapseRepeats;
+        }
+    });
+    if (settings.metricsInterval) {
+        setMetricsInterval(*settings.metricsInterval);
+    }
+
+    // The layout and the file change only with the file's values
+    bool newPattern = false;
+    bool newFile = false;
+    {
+        std::lock_guard<std::mutex> configLock(configMutex);
+        newPattern = settings.pattern && settings.pattern != configuredPattern;
+        newFile = settings.filePath && settings.filePath != configuredFile;
+        if (newPattern) {
+            configuredPattern = settings.pattern;
+        }
+        if (newFile) {
+            configuredFile = settings.filePath;
+        }
+    }
+
+    bool applied = true;
+    if (newPattern) {
+        applied = setLayout(*settings.pattern);
+    }
+    if (newFile && settings.filePath->empty()) {
+        disableFileLogging();
+    } else if (newFile) {
+        enableFileLogging(*settings.filePath);
+    }
+    return applied;
+}
+
+bool LoggerHandler::loadConfig(const std::string& path) {
+    LogConfigFile file;
+    file.load(path);
+    return applyConfig(file);
+}
+
+// Line layouts – a replaced one goes to the reclaimer, since another thread
+// may still be formatting a line with it
+bool LoggerHandler::setLayout(const std::string& pattern) {
+    auto parsed = std::make_unique<LogRuntimeLayout>(pattern, loggerName);
+    if (!parsed->isValid()) {
+        std::lock_guard<std::mutex> sinkLock(sinkMutex);
+        logToConsole(LogLevel::Error, "Invalid line pattern: " + pattern);
+        return false;
+    }
+    installLayout(std::move(parsed));
+    return true;
+}
+
+void LoggerHandler::installLayout(std::unique_ptr<LogLayout> newLayout) {
+    std::lock_guard<std::mutex> sinkLock(sinkMutex);
+    std::shared_ptr<const LogLayout> replaced = std::move(installedLayout);
+    installedLayout = std::move(newLayout);
+    layout.store(installedLayout.get(), std::memory_order_seq_cst);
+    reclaimer.retire(std::move(replaced));
+}
+
+// Sampling – settings (each change publishes a new snapshot)
+void LoggerHandler::setSampleEvery(LogLevel level, std::uint32_t n) {
+    std::size_t index = static_cast<std::size_t>(level);
+    updateConfig([index, n](LogConfig& next) {
+        next.sampleCounted[index] = true;
+        next.sampleRates[index] = n > 1 ? 1.0f / static_cast<float>(n) : 1.0f;
+    });
+}
+
+void LoggerHandler::setSampleEvery(std::uint32_t n) {
+    updateConfig([n](LogConfig& next) {
+        for (std::size_t index = 0; index < levelCount; ++index) {
+            next.sampleCounted[index] = true;
+            next.sampleRates[index] = n > 1 ? 1.0f / static_cast<float>(n) : 1.0f;
+        }
+    });
+}
+
+void LoggerHandler::setSampleProbability(LogLevel level, double probability) {
+    std::size_t index = static_cast<std::size_t>(level);
+    float rate = static_cast<float>(std::clamp(probability, 0.0, 1.0));
+    updateConfig([index, rate](LogConfig& next) {
+        next.sampleCounted[index] = false;
+        next.sampleRates[index] = rate;
+    });
+}
+
+void LoggerHandler::setSampleProbability(double probability) {
+    float rate = static_cast<float>(std::clamp(probability, 0.0, 1.0));
+    updateConfig([rate](LogConfig& next) {
+        for (std::size_t index = 0; index < levelCount; ++index) {
+            next.sampleCounted[index] = false;
+            next.sampleRates[index] = rate;
+        }
+    });
+}
+
+std::uint64_t LoggerHandler::getSampledOutRecords() const {
+    return metrics.getSampledOutRecords();
+}
+
+// Sampling – decide for one record with thread-local state only: a counter
+// per level for 1-in-n, a xorshift generator for probabilities
+bool LoggerHandler::drawSample(LogLevel level, float sampleRate, bool counted) {
+    std::size_t index = static_cast<std::size_t>(level);
+    bool keep;
+
+    if (counted) {
+        thread_local std::uint32_t counters[levelCount] = {};
+        std::uint32_t every = static_cast<std::uint32_t>(std::lround(1.0f / sampleRate));
+        keep = counters[index]++ % every == 0;
+    } else {
+        thread_local std::uint64_t state =
+            std::hash<std::thread::id>()(std::this_thread::get_id()) * 0x9E3779B97F4A7C15ull | 1;
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        // Top 24 bits give a uniform float in [0, 1)
+        keep = static_cast<float>(state >> 40) * (1.0f / 16777216.0f) < sampleRate;
+    }
+
+    if (!keep) {
+        metrics.countSampledOut();
+    }
+    return keep;
+}
+
+// Sampling – annotate a kept line: " [sample rate 1/n]" when the rate is a
+// whole fraction, otherwise the probability itself
+void LoggerHandler::appendSampleRate(LogLineBuffer& formattedLine, float sampleRate) {
+    if (sampleRate >= 1.0f) {
+        return;
+    }
+
+    char digits[32];
+    char* end;
+    float inverse = 1.0f / sampleRate;
+    if (sampleRate > 0.0f && std::fabs(inverse - std::round(inverse)) < 1e-3f * inverse) {
+        digits[0] = '1';
+        digits[1] = '/';
+        end = std::to_chars(digits + 2, digits + sizeof(digits), std::lround(inverse)).ptr;
+    } else {
+        end = std::to_chars(digits, digits + sizeof(digits), sampleRate).ptr;
+    }
+
+    formattedLine.append(" [sample rate ", 14);
+    formattedLine.append(digits, static_cast<std::size_t>(end - digits));
+    formattedLine.append(']');
+}
+
+// Rate limiting – admit or count one record at a limited call site
+bool LoggerHandler::passesRateLimit(LogRateLimiter& limiter, LogLevel level) {
+    if (!limiter.tryAcquire()) {
+        metrics.countRateLimited();
+        return false;
+    }
+
+    std::uint64_t suppressed = limiter.takeSuppressed();
+    if (suppressed > 0) {
+        writeNotice(level, "", suppressed, " similar records suppressed by the rate limit");
+    }
+    return true;
+}
+
+std::uint64_t LoggerHandler::getRateLimitedRecords() const {
+    return metrics.getRateLimitedRecords();
+}
+
+// Repeat collapsing – settings
+void LoggerHandler::setCollapseRepeats(bool enabled) {
+    if (!enabled) {
+        flushRepeats();
+    }
+    updateConfig([enabled](LogConfig& next) { next.collapseRepeats = enabled; });
+}
+
+bool LoggerHandler::getCollapseRepeats() const {
+    LogReclaimer::ReadGuard guard;
+    return currentConfig().collapseRepeats;
+}
+
+std::uint64_t LoggerHandler::getCollapsedRecords() const {
+    return metrics.getCollapsedRecords();
+}
+
+// Repeat collapsing – true if the record matches the previous one and was
+// counted. Otherwise it becomes the record to compare against, after the
+// previous one's repeat count (if any) has been written out.
+bool LoggerHandler::isRepeat(std::uint64_t hash, LogLevel level) {
+    hash = logMessageHash(&level, sizeof(level), hash) | 1; // never 0
+    std::uint64_t previous = lastRecordHash.exchange(hash, std::memory_order_relaxed);
+    if (previous == hash) {
+        repeatCount.fetch_add(1, std::memory_order_relaxed);
+        metrics.countCollapsed();
+        return true;
+    }
+
+    LogLevel previousLevel = static_cast<LogLevel>(
+        lastRecordLevel.exchange(static_cast<std::uint8_t>(level), std::memory_order_relaxed));
+    std::uint64_t repeats = repeatCount.exchange(0, std::memory_order_relaxed);
+    if (repeats > 0) {
+        writeNotice(previousLevel, "Last message repeated ", repeats, " times");
+    }
+    return false;
+}
+
+// Repeat collapsing – write out a pending repeat count and start afresh
+void LoggerHandler::flushRepeats() {
+    lastRecordHash.store(0, std::memory_order_relaxed);
+    std::uint64_t repeats = repeatCount.exchange(0, std::memory_order_relaxed);
+    if (repeats > 0) {
+        LogLevel level = static_cast<LogLevel>(lastRecordLevel.load(std::memory_order_relaxed));
+        writeNotice(level, "Last message repeated ", repeats, " times");
+    }
+}
+
+// Rate limit and repeat notices bypass both filters
+void LoggerHandler::writeNotice(LogLevel level, const char* prefix, std::uint64_t count, const char* suffix) {
+    LogReclaimer::ReadGuard guard;
+    submitRecord(level, prefix + std::to_string(count) + suffix);
+}
+
+// Filter, then route a record to the writer thread or write it on the caller's thread
+void LoggerHandler::log(LogLevel level, std::string_view message) {
+    logText(LogCallSites::none, level, message);
+}
+
+void LoggerHandler::logAt(LogCallSiteHandle& site, LogLevel level, std::string_view message) {
+    if (isEnabled(level)) {
+        logText(site.id(nullptr), level, message);
+    }
+}
+
+void LoggerHandler::logText(std::uint32_t callSite, LogLevel level, std::string_view message) {
+    LogReclaimer::ReadGuard guard;
+    float sampleRate;
+    if (admits(level, message, sampleRate)) {
+        submitRecord(level, message, sampleRate, callSite);
+    }
+}
+
+void LoggerHandler::log(LogLevel level, const char* message) {
+    log(level, std::string_view(message));
+}
+
+// A message bigger than an arena block is queued in the caller's own buffer
+void LoggerHandler::log(LogLevel level, std::string&& message) {
+    LogReclaimer::ReadGuard guard;
+    float sampleRate;
+    if (!admits(level, message, sampleRate)) {
+        return;
+    }
+
+    if (message.size() > LogArena::largestSlabBlock && asyncEnabled.load(std::memory_order_acquire)) {
+        LogRecord record;
+        record.timestamp = std::chrono::system_clock::now();
+        record.level = level;
+        record.thread = logThreadId();
+        record.ownedMessage = std::move(message);
+        record.sampleRate = sampleRate;
+        if (!enqueueRecord(std::move(record))) {
+            writeRecord(LogLineContext{record.timestamp, level, record.thread}, record.ownedMessage, sampleRate);
+        }
+        return;
+    }
+    submitRecord(level, message, sampleRate);
+}
+
+// Level, sampling and repeat filters, in that order (the caller holds a
+// LogReclaimer guard for the whole record)
+bool LoggerHandler::admits(LogLevel level, std::string_view message, float& sampleRate) {
+    const LogConfig& current = currentConfig();
+    if (!keepRecord(current, level, sampleRate)) {
+        return false;
+    }
+    return !current.collapseRepeats ||
+           !isRepeat(logMessageHash(message.data(), message.size()), level);
+}
+
+void LoggerHandler::submitRecord(LogLevel level, std::string_view message, float sampleRate,
+                                 std::uint32_t callSite) {
+    metrics.countRecord(level);
+    if (asyncEnabled.load(std::memory_order_acquire)) {
+        LogRecord record = arenaRecord(std::chrono::system_clock::now(), level, message, std::string_view(),
+                                       sampleRate);
+        record.callSite = callSite;
+        if (enqueueRecord(std::move(record))) {
+            return;
+        }
+    }
+
+    writeRecord(LogLineContext{std::chrono::system_clock::now(), level, logThreadId(), callSite},
+                message, sampleRate);
+}
+
+// Structured records take the same route with their fields alongside
+void LoggerHandler::submitStructured(LogLevel level, std::string_view message, const std::string& fields,
+                                     float sampleRate, std::uint32_t callSite) {
+    metrics.countRecord(level);
+    LogLineContext line{std::chrono::system_clock::now(), level, logThreadId(), callSite};
+    if (asyncEnabled.load(std::memory_order_acquire)) {
+        LogRecord record = arenaRecord(line.timestamp, level, message, fields, sampleRate);
+        record.callSite = callSite;
+        if (enqueueRecord(std::move(record))) {
+            return;
+        }
+    }
+
+    std::uint64_t formatStarted = metrics.startTimer();
+    LogLineBuffer& formattedLine = beginLine(line);
+    formattedLine.append(message.data(), message.size());
+    appendSampleRate(formattedLine, sampleRate);
+    std::size_t messageLength = formattedLine.size() - formattedLine.messageOffset();
+    LogStructuredFormat::appendLogfmtFields(formattedLine, fields.data(), fields.size());
+    metrics.recordFormat(formatStarted);
+
+    LogSinkBatch& batch = threadTextBatch();
+    batch.clear();
+    addLine(batch, formattedLine, line, messageLength, fields);
+    writeBatch(batch);
+}
+
+// Batches – pack one line into a batch payload
+void LoggerHandler::appendBatchLine(std::string& payload, std::chrono::system_clock::time_point timestamp,
+                                    LogLevel level, const char* message, std::size_t length) {
+    std::int64_t ticks = static_cast<std::int64_t>(timestamp.time_since_epoch().count());
+    std::uint32_t messageLength = static_cast<std::uint32_t>(length);
+
+    char header[sizeof(ticks) + 1 + sizeof(messageLength)];
+    std::memcpy(header, &ticks, sizeof(ticks));
+    header[sizeof(ticks)] = static_cast<char>(level);
+    std::memcpy(header + sizeof(ticks) + 1, &messageLength, sizeof(messageLength));
+
+    payload.append(header, sizeof(header));
+    payload.append(message, messageLength);
+}
+
+// Batches – write every line of a payload with one delivery to the sinks.
+// In asynchronous mode the payload travels as a single queued record, so its
+// lines stay together and in order with the caller's other records.
+void LoggerHandler::commitBatch(std::string& payload, LogLevel highestLevel) {
+    if (payload.empty()) {
+        return;
+    }
+
+    if (asyncEnabled.load(std::memory_order_acquire)) {
+        LogRecord record = arenaRecord(std::chrono::system_clock::now(), highestLevel, payload);
+        record.batch = true;
+        if (enqueueRecord(std::move(record))) {
+            payload.clear();
+            return;
+        }
+    }
+
+    LogSinkBatch& batch = threadTextBatch();
+    batch.clear();
+    {
+        LogReclaimer::ReadGuard guard;
+        addBatchLines(batch, payload, logThreadId());
+    }
+    writeBatch(batch);
+    payload.clear();
+}
+
+// Batches – render every line of a payload into a sink batch
+void LoggerHandler::addBatchLines(LogSinkBatch& batch, std::string_view payload, std::uint32_t thread) {
+    constexpr std::size_t headerSize = sizeof(std::int64_t) + 1 + sizeof(std::uint32_t);
+    std::size_t position = 0;
+
+    while (position + headerSize <= payload.size()) {
+        std::int64_t ticks;
+        std::uint32_t messageLength;
+        std::memcpy(&ticks, payload.data() + position, sizeof(ticks));
+        LogLevel level = static_cast<LogLevel>(payload[position + sizeof(ticks)]);
+        std::memcpy(&messageLength, payload.data() + position + sizeof(ticks) + 1, sizeof(messageLength));
+        position += headerSize;
+
+        std::chrono::system_clock::time_point timestamp{std::chrono::system_clock::duration(ticks)};
+        metrics.countRecord(level);
+        LogLineContext line{timestamp, level, thread};
+        LogLineBuffer& formattedLine = beginLine(line);
+        formattedLine.append(payload.data() + position, messageLength);
+        addLine(batch, formattedLine, line);
+        position += messageLength;
+    }
+}
+
+void LoggerHandler::logMany(LogLevel level, const std::vector<std::string>& messages) {
+    if (!isEnabled(level) || level == LogLevel::Off) {
+        return;
+    }
+
+    thread_local std::string payload;
+    payload.clear();
+    auto timestamp = std::chrono::system_clock::now();
+    for (const std::string& message : messages) {
+        appendBatchLine(payload, timestamp, level, message.data(), message.size());
+    }
+    commitBatch(payload, level);
+}
+
+// Crash dumps – write out buffered data and every queued record. The logger's
+// locks may be held by the crashed thread, so nothing here takes them, and
+// no reclaimer guard either (a first guard on a thread allocates): the dump
+// uses the layout current when the process crashed.
+void LoggerHandler::writeCrashDump(const char* reason, LogTimestampCache& timestampCache) {
+    for (const auto& slot : crashSinks) {
+        if (LogSink* sink = slot.load(std::memory_order_acquire)) {
+            sink->crashFlush();
+        }
+    }
+
+    if (asyncQueue) {
+        asyncQueue->peekAll([this, &timestampCache](const LogRecord& record) {
+            writeCrashRecord(record, timestampCache);
+        });
+    }
+    for (const auto& slot : crashThreadBuffers) {
+        if (ThreadBuffer* buffer = slot.load(std::memory_order_acquire)) {
+            buffer->records.peekAll([this, &timestampCache](const LogRecord& record) {
+                writeCrashRecord(record, timestampCache);
+            });
+        }
+    }
+
+    static LogLineBuffer marker;
+    marker.truncateAtInlineCapacity();
+    LogLineContext line{std::chrono::system_clock::now(), LogLevel::Error, logThreadId()};
+    layout.load(std::memory_order_seq_cst)->formatPrefix(marker, line, timestampCache);
+    marker.append(reason, std::strlen(reason));
+    writeCrashLine(line, marker, timestampCache);
+}
+
+void LoggerHandler::writeCrashRecord(const LogRecord& record, LogTimestampCache& timestampCache) {
+    static LogLineBuffer formattedLine;
+    formattedLine.truncateAtInlineCapacity();
+
+    if (!record.batch) {
+        LogLineContext line{record.timestamp, record.level, record.thread, record.callSite};
+        layout.load(std::memory_order_seq_cst)->formatPrefix(formattedLine, line, timestampCache);
+        std::string_view message = record.message();
+        std::string_view fields = record.fields();
+        if (record.format == nullptr) {
+            formattedLine.append(message.data(), message.size());
+        } else {
+            LogFormatter::formatEncoded(formattedLine, record.format, message.data(), message.size());
+        }
+        appendSampleRate(formattedLine, record.sampleRate);
+        std::size_t messageLength = formattedLine.size() - formattedLine.messageOffset();
+        LogStructuredFormat::appendLogfmtFields(formattedLine, fields.data(), fields.size());
+        writeCrashLine(line, formattedLine, timestampCache, messageLength, fields);
+        return;
+    }
+
+    // A queued LogBatch: same layout as addBatchLines
+    constexpr std::size_t headerSize = sizeof(std::int64_t) + 1 + sizeof(std::uint32_t);
+    std::string_view payload = record.message();
+    std::size_t position = 0;
+    while (position + headerSize <= payload.size()) {
+        std::int64_t ticks;
+        std::uint32_t messageLength;
+        std::memcpy(&ticks, payload.data() + position, sizeof(ticks));
+        LogLevel level = static_cast<LogLevel>(payload[position + sizeof(ticks)]);
+        std::memcpy(&messageLength, payload.data() + position + sizeof(ticks) + 1, sizeof(messageLength));
+        position += headerSize;
+
+        std::chrono::system_clock::time_point timestamp{std::chrono::system_clock::duration(ticks)};
+        LogLineContext line{timestamp, level, record.thread};
+        layout.load(std::memory_order_seq_cst)->formatPrefix(formattedLine, line, timestampCache);
+        formattedLine.append(payload.data() + position, messageLength);
+        writeCrashLine(line, formattedLine, timestampCache);
+        position += messageLength;
+    }
+}
+
+// Hand one line to every sink that takes its level, in the sink's format
+void LoggerHandler::writeCrashLine(const LogLineContext& line, LogLineBuffer& formattedLine, LogTimestampCache& timestampCache,
+                                   std::size_t messageLength, std::string_view fields) {
+    static LogLineBuffer encodedRecord;
+    encodedRecord.truncateAtInlineCapacity();
+    LogSinkFormat encodedFormat = LogSinkFormat::Text;
+
+    // Text sinks take the newline in the same write
+    std::size_t textLength = formattedLine.size();
+    std::size_t messageOffset = formattedLine.messageOffset();
+    if (messageLength == LogSinkBatch::noMessageLength) {
+        messageLength = textLength - messageOffset;
+    }
+    formattedLine.append('\n');
+
+    for (const auto& slot : crashSinks) {
+        LogSink* sink = slot.load(std::memory_order_acquire);
+        if (sink == nullptr || !sink->accepts(line.level)) {
+            continue;
+        }
+
+        LogSinkFormat format = sink->getFormat();
+        if (format == LogSinkFormat::Text) {
+            sink->crashWrite(formattedLine.data(), formattedLine.size());
+            continue;
+        }
+
+        if (format != encodedFormat) {
+            std::string_view message(formattedLine.data() + messageOffset, messageLength);
+            const char* fieldData = fields.data();
+            std::size_t fieldsLength = fields.size();
+            encodedRecord.clear();
+
+            if (format == LogSinkFormat::Binary) {
+                auto nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(line.timestamp.time_since_epoch());
+                LogBinaryFormat::appendRecord(encodedRecord, nanoseconds.count(), line.level, 0,
+                                              formattedLine.data() + messageOffset,
+                                              textLength - messageOffset);
+            } else {
+                if (format == LogSinkFormat::Json) {
+                    LogStructuredFormat::appendJsonRecord(encodedRecord, line.timestamp, line.level, loggerName, message,
+                                                          fieldData, fieldsLength, timestampCache,
+                                                          line.thread, line.callSite);
+                } else {
+                    LogStructuredFormat::appendLogfmtRecord(encodedRecord, line.timestamp, line.level, loggerName, message,
+                                                            fieldData, fieldsLength, timestampCache,
+                                                            line.thread, line.callSite);
+                }
+                encodedRecord.append('\n');
+            }
+            encodedFormat = format;
+        }
+        sink->crashWrite(encodedRecord.data(), encodedRecord.size());
+    }
+}
+
+// Timestamp helpers
+std::string LoggerHandler::getCurrentTimestamp() {
+    return formatTimestamp(std::chrono::system_clock::now());
+}
+
+std::string LoggerHandler::formatTimestamp(std::chrono::system_clock::time_point timestamp) {
+    char buffer[logTimestampLength];
+    threadTimestampCache().format(timestamp, buffer);
+    return std::string(buffer, logTimestampLength);
+}
+
+// Format the prefix of a line in the current layout
+void LoggerHandler::formatPrefix(const LogLineContext& line, LogLineBuffer& formattedLine) {
+    layout.load(std::memory_order_seq_cst)->formatPrefix(formattedLine, line, threadTimestampCache());
+}
+
+// Format a single log line into the caller's buffer
+void LoggerHandler::formatLogLine(std::chrono::system_clock::time_point timestamp,
+                                  LogLevel level, const std::string& message,
+                                  LogLineBuffer& formattedLine) {
+    formatPrefix(LogLineContext{timestamp, level, logThreadId()}, formattedLine);
+    formattedLine.append(message);
+}
+
+// Log a status line to the console only (the caller holds sinkMutex)
+void LoggerHandler::logToConsole(LogLevel level, const std::string& message) {
+    if (!consoleSink || !isAttached(consoleSink)) {
+        return;
+    }
+
+    auto timestamp = std::chrono::system_clock::now();
+    LogLineBuffer formattedLine;
+    {
+        LogReclaimer::ReadGuard guard;
+        formatLogLine(timestamp, level, message, formattedLine);
+    }
+
+    LogSinkBatch batch(LogSinkFormat::Text);
+    addLine(batch, formattedLine, LogLineContext{timestamp, level, logThreadId()});
+    consoleSink->write(batch);
+}
+
+// Public logging methods
+void LoggerHandler::logMessage(std::string_view message) {
+    log(LogLevel::Message, message);
+}
+
+void LoggerHandler::logSuccess(std::string_view message) {
+    log(LogLevel::Success, message);
+}
+
+void LoggerHandler::logWarning(std::string_view message) {
+    log(LogLevel::Warning, message);
+}
+
+// Error records are flushed by the file's flush policy (LogFlushPolicy::flushLevel)
+void LoggerHandler::logError(std::string_view message) {
+    log(LogLevel::Error, message);
 }
\ No newline at end of file
@@ -0,0 +1,123 @@
+#include "LoggerHandler.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+
+// Count every global allocation made while counting is switched on
+static std::atomic<bool> countingEnabled{false};
+static std::atomic<long> allocationCount{0};
+
+void* operator new(std::size_t size) {
+    if (countingEnabled.load(std::memory_order_relaxed)) {
+        allocationCount.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (void* memory = std::malloc(size ? size : 1)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+// Number of allocations made by logging the message count times
+static long countAllocations(LoggerHandler& log, const std::string& message, int count) {
+    allocationCount = 0;
+    countingEnabled = true;
+    for (int i = 0; i < count; ++i) {
+        log.logMessage(message);
+        log.logWarning(message);
+    }
+    countingEnabled = false;
+    return allocationCount.load();
+}
+
+int main() {
+    int failures = 0;
+
+    LoggerHandler log("AllocLogger");
+    log.enableFileLogging("logs/test_alloc_log.txt");
+
+    const std::string shortMessage = "A message long enough to defeat the small string optimisation";
+    const std::string longMessage(LogLineBuffer::inlineCapacity + 512, 'x');
+
+    // Warm up: thread-local buffers and the timestamp cache are set up on first use
+    countAllocations(log, shortMessage, 4);
+    countAllocations(log, longMessage, 4);
+
+    long shortAllocations = countAllocations(log, shortMessage, 100);
+    long longAllocations = countAllocations(log, longMessage, 10);
+
+    allocationCount = 0;
+    countingEnabled = true;
+    for (int i = 0; i < 100; ++i) {
+        log.logMessage("Deferred line {} of {} with {} and {}", i, 100, 2.5, shortMessage);
+    }
+    countingEnabled = false;
+    long deferredAllocations = allocationCount.load();
+
+    log.disableFileLogging();
+
+    // Asynchronous records: payloads come from the thread's arena, whose
+    // slabs the writer thread hands back once their records are written
+    LoggerHandler queued("AsyncAllocLogger");
+    queued.removeSink(queued.getConsoleSink());
+    queued.enableFileLogging("logs/test_alloc_async_log.txt");
+    queued.enableAsyncLogging(1024);
+
+    countAllocations(queued, shortMessage, 20000);
+    queued.flush();
+    long queuedAllocations = countAllocations(queued, shortMessage, 20000);
+    queued.flush();
+
+    std::string borrowed = shortMessage;
+    long viewAllocations = 0;
+    for (int round = 0; round < 2; ++round) {
+        allocationCount = 0;
+        countingEnabled = true;
+        for (int i = 0; i < 10000; ++i) {
+            queued.log(LogLevel::Message, std::string_view(borrowed));
+            queued.logMessage("Deferred line {} of {} with {}", i, 10000, borrowed);
+        }
+        queued.flush();
+        countingEnabled = false;
+        viewAllocations = allocationCount.load(); // the first round warms up
+    }
+
+    queued.disableAsyncLogging();
+    queued.disableFileLogging();
+
+    std::cout << "Allocations for short lines: " << shortAllocations << std::endl;
+    std::cout << "Allocations for oversized lines: " << longAllocations << std::endl;
+    std::cout << "Allocations for deferred lines: " << deferredAllocations << std::endl;
+    std::cout << "Allocations for queued lines: " << queuedAllocations << std::endl;
+    std::cout << "Allocations for queued views and deferred lines: " << viewAllocations << std::endl;
+
+    if (shortAllocations != 0) {
+        std::cerr << "FAIL: formatting short lines allocated" << std::endl;
+        ++failures;
+    }
+    if (longAllocations != 0) {
+        std::cerr << "FAIL: formatting oversized lines allocated after warm-up" << std::endl;
+        ++failures;
+    }
+
+    if (deferredAllocations != 0) {
+        std::cerr << "FAIL: deferred formatting allocated" << std::endl;
+        ++failures;
+    }
+
+    if (queuedAllocations != 0 || viewAllocations != 0) {
+        std::cerr << "FAIL: queueing records allocated after warm-up" << std::endl;
+        ++failures;
+    }
+
+    return failures == 0 ? 0 : 1;
+}
@@ -1,53 +1,1302 @@
-#include "Logger.hpp"
-#include <iostream>
-#include <thread>
-#include <vector>
-#include <cstdlib>
-
-int main() {
-    // Test 1: Basic console logging (internal mutex)
-    {
-        Logger log("TestLogger");
-        log.logMessage("Starting test");
-        log.logSuccess("All good");
-        log.logWarning("Something might be off");
-        log.logError("Critical failure");
-    }
-
-    std::cout << "\n--- File logging test ---\n" << std::endl;
-
-    // Test 2: File logging
-    {
-        Logger log("FileLogger");
-        log.enableFileLogging("logs/test_log.txt");
-
-        log.logMessage("This goes to file and console");
-        log.logSuccess("Success logged");
-        log.logWarning("Warning logged");
-        log.logError("Error logged");
-
-        log.disableFileLogging();
-    }
-
-    std::cout << "\n--- Multi-thread test ---\n" << std::endl;
-
-    // Test 3: Shared console mutex across threads
-    std::mutex sharedMutex;
-    std::vector<std::thread> threads;
-
-    for (int i = 0; i < 5; ++i) {
-        threads.emplace_back([&sharedMutex, i]() {
-            Logger log("Thread" + std::to_string(i), sharedMutex);
-            log.logMessage("Hello from thread " + std::to_string(i));
-            log.logSuccess("Thread success");
-        });
-    }
-
-    for (auto& t : threads) {
-        t.join();
-    }
-
-    std::cout << "\nAll tests completed.\n";
-    system("pause");
-    return 0;
+#include "LoggerHandler.hpp"
+#include "LogBatch.hpp"
+#include "LogRegistry.hpp"
+#include "LogCrashHandler.hpp"
+#include "LogNetworkSink.hpp"
+#include "LogSharedMemorySink.hpp"
+#include "LogCollector.hpp"
+#include <iostream>
+#include <thread>
+#include <vector>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <csignal>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+// A compile-time line pattern (the template argument needs linkage)
+constexpr char utcThreadPattern[] = "{utc} tid={thread} {level}: ";
+
+int main(int argc, char* argv[]) {
+    // Test 1: Basic console logging (internal mutex)
+    {
+        LoggerHandler log("TestLogger");
+        log.logMessage("Starting test");
+        log.logSuccess("All good");
+        log.logWarning("Something might be off");
+        log.logError("Critical failure");
+    }
+
+    std::cout << "\n--- File logging test ---\n" << std::endl;
+
+    // Test 2: File logging
+    {
+        LoggerHandler log("FileLogger");
+        log.enableFileLogging("logs/test_log.txt");
+
+        log.logMessage("This goes to file and console");
+        log.logSuccess("Success logged");
+        log.logWarning("Warning logged");
+        log.logError("Error logged");
+
+        log.disableFileLogging();
+    }
+
+    std::cout << "\n--- Multi-thread test ---\n" << std::endl;
+
+    // Test 3: Shared console mutex across threads
+    std::mutex sharedMutex;
+    std::vector<std::thread> threads;
+
+    for (int i = 0; i < 5; ++i) {
+        threads.emplace_back([&sharedMutex, i]() {
+            LoggerHandler log("Thread" + std::to_string(i), sharedMutex);
+            log.logMessage("Hello from thread " + std::to_string(i));
+            log.logSuccess("Thread success");
+        });
+    }
+
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    std::cout << "\n--- Async logging test ---\n" << std::endl;
+
+    // Test 4: Asynchronous mode drains everything before the file is closed
+    {
+        std::filesystem::remove("logs/test_async_log.txt");
+        LoggerHandler log("AsyncLogger");
+        log.enableFileLogging("logs/test_async_log.txt");
+        log.enableAsyncLogging(64, LogOverflowPolicy::Block);
+
+        std::vector<std::thread> producers;
+        for (int i = 0; i < 4; ++i) {
+            producers.emplace_back([&log, i]() {
+                for (int j = 0; j < 50; ++j) {
+                    log.logMessage("Async line " + std::to_string(j) + " from producer " + std::to_string(i));
+                }
+            });
+        }
+        for (auto& t : producers) {
+            t.join();
+        }
+
+        log.disableFileLogging();
+
+        // Every line reached the file, each producer's in the order it logged them
+        std::ifstream asyncLog("logs/test_async_log.txt");
+        std::string line;
+        int nextLine[4] = {0, 0, 0, 0};
+        bool ordered = true;
+        while (std::getline(asyncLog, line)) {
+            std::size_t text = line.find("Async line ");
+            if (text == std::string::npos) {
+                continue;
+            }
+            int lineNumber = std::atoi(line.c_str() + text + 11);
+            int producer = std::atoi(line.c_str() + line.rfind(' ') + 1);
+            if (producer < 0 || producer >= 4 || lineNumber != nextLine[producer]) {
+                ordered = false;
+                break;
+            }
+            ++nextLine[producer];
+        }
+
+        int asyncLines = nextLine[0] + nextLine[1] + nextLine[2] + nextLine[3];
+        std::cout << "Async lines written: " << asyncLines << " (expected 200)" << std::endl;
+        if (!ordered || asyncLines != 200) {
+            return 1;
+        }
+
+        // Switching async mode off under the producers keeps each one's order
+        auto memory = std::make_shared<LogMemorySink>(LogSinkFormat::Text);
+        LoggerHandler switching("SwitchingLogger", {memory});
+        switching.enableAsyncLogging(16, LogOverflowPolicy::Block);
+        std::vector<std::thread> late;
+        for (int i = 0; i < 4; ++i) {
+            late.emplace_back([&switching, i]() {
+                for (int j = 0; j < 500; ++j) {
+                    switching.logMessage("Switch {} {}", i, j);
+                }
+            });
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        switching.disableAsyncLogging();
+        for (auto& t : late) {
+            t.join();
+        }
+
+        int nextSwitch[4] = {0, 0, 0, 0};
+        for (const std::string& record : memory->getRecords()) {
+            std::size_t text = record.find("Switch ");
+            int producer = text == std::string::npos ? -1 : std::atoi(record.c_str() + text + 7);
+            int recordNumber = std::atoi(record.c_str() + record.rfind(' ') + 1);
+            if (producer < 0 || producer >= 4 || recordNumber != nextSwitch[producer]) {
+                ordered = false;
+                break;
+            }
+            ++nextSwitch[producer];
+        }
+        if (!ordered || nextSwitch[0] + nextSwitch[1] + nextSwitch[2] + nextSwitch[3] != 2000) {
+            return 1;
+        }
+    }
+
+    std::cout << "\n--- Async overflow test ---\n" << std::endl;
+
+    // Test 5: A tiny ring with the drop-newest policy counts what it discards
+    {
+        auto memory = std::make_shared<LogMemorySink>();
+        LoggerHandler log("DropLogger", {memory});
+        log.enableAsyncLogging(4, LogOverflowPolicy::DropNewest);
+
+        for (int i = 0; i < 1000; ++i) {
+            log.logMessage("Burst line " + std::to_string(i));
+        }
+
+        std::cout << "Queue capacity: " << log.getQueueCapacity()
+                  << ", depth: " << log.getQueueDepth()
+                  << ", dropped: " << log.getDroppedRecords() << std::endl;
+        log.disableAsyncLogging();
+
+        // Each record was either written or counted as dropped
+        std::size_t written = 0;
+        for (const auto& record : memory->getRecords()) {
+            written += record.find("Burst line ") != std::string::npos ? 1 : 0;
+        }
+        std::cout << "Written: " << written << std::endl;
+        if (log.getDroppedRecords() == 0 || log.getDroppedRecords() + written != 1000) {
+            return 1;
+        }
+    }
+
+    std::cout << "\n--- Level filtering test ---\n" << std::endl;
+
+    // Test 6: Filtered calls never evaluate their message argument
+    {
+        LoggerHandler log("LevelLogger");
+        int evaluations = 0;
+        auto buildMessage = [&evaluations](const char* text) {
+            ++evaluations;
+            return std::string(text);
+        };
+
+        log.setMinLevel(LogLevel::Warning);
+        LOGGER_MESSAGE(log, buildMessage("Filtered at runtime"));
+        LOGGER_WARNING(log, buildMessage("Warning passes the runtime filter"));
+
+        log.setMinLevel(LogLevel::Message);
+#undef LOGGER_COMPILE_LEVEL
+#define LOGGER_COMPILE_LEVEL LOGGER_LEVEL_ERROR
+        LOGGER_SUCCESS(log, buildMessage("Compiled out"));
+        LOGGER_ERROR(log, buildMessage("Error passes the compile-time filter"));
+#undef LOGGER_COMPILE_LEVEL
+#define LOGGER_COMPILE_LEVEL LOGGER_LEVEL_MESSAGE
+
+        std::cout << "Message arguments evaluated: " << evaluations << " (expected 2)" << std::endl;
+        if (evaluations != 2) {
+            return 1;
+        }
+    }
+
+    std::cout << "\n--- Deferred formatting test ---\n" << std::endl;
+
+    // Test 7: "{}" formatting on the caller's thread and on the writer thread
+    {
+        auto memory = std::make_shared<LogMemorySink>();
+        LoggerHandler log("FormatLogger", {memory});
+        log.setLayout("{level}: ");
+        log.logMessage("Request {} took {} ms ({})", 42, 3.5, "ok");
+        log.logWarning("Escaped {{braces}}, flag {}, char {}", true, 'x');
+
+        log.enableAsyncLogging();
+        std::string user = "alice";
+        log.logSuccess("User {} logged in from {} after {} attempts", user, "10.0.0.1", 3u);
+        log.logError("Missing argument keeps its placeholder: {} {}", -7);
+        log.disableAsyncLogging();
+
+        std::vector<std::string> expected = {
+            "MESSAGE: Request 42 took 3.5 ms (ok)",
+            "WARNING: Escaped {braces}, flag true, char x",
+            "SUCCESS: User alice logged in from 10.0.0.1 after 3 attempts",
+            "ERROR..: Missing argument keeps its placeholder: -7 {}",
+        };
+        std::vector<std::string> records = memory->getRecords();
+        for (const auto& record : records) {
+            std::cout << record << std::endl;
+        }
+        if (records != expected) {
+            std::cout << "Formatted lines do not match" << std::endl;
+            return 1;
+        }
+    }
+
+    std::cout << "\n--- Buffered file test ---\n" << std::endl;
+
+    // Test 8: Lines stay in the sink's buffer until the flush policy or flush() says so
+    {
+        LogFlushPolicy flushPolicy;
+        flushPolicy.maxBufferedBytes = 1024 * 1024;
+        flushPolicy.maxDelay = std::chrono::milliseconds(0);
+        flushPolicy.flushLevel = LogLevel::Off;
+
+        LoggerHandler log("BufferedLogger");
+        log.enableFileLogging("logs/test_buffered_log.txt", flushPolicy);
+        auto sizeAfterBanner = std::filesystem::file_size("logs/test_buffered_log.txt");
+
+        for (int i = 0; i < 10; ++i) {
+            log.logWarning("Buffered line {}", i);
+        }
+        auto sizeBeforeFlush = std::filesystem::file_size("logs/test_buffered_log.txt");
+        log.flush();
+        auto sizeAfterFlush = std::filesystem::file_size("logs/test_buffered_log.txt");
+
+        std::cout << "File size after banner: " << sizeAfterBanner
+                  << ", before flush: " << sizeBeforeFlush
+                  << ", after flush: " << sizeAfterFlush << std::endl;
+        if (sizeBeforeFlush != sizeAfterBanner || sizeAfterFlush <= sizeBeforeFlush) {
+            return 1;
+        }
+    }
+
+    std::cout << "\n--- Memory-mapped file test ---\n" << std::endl;
+
+    // Test 9: A mapped file is truncated to the bytes written when it is closed
+    {
+        std::filesystem::remove("logs/test_mmap_log.txt");
+
+        LoggerHandler log("MappedLogger");
+        log.enableMappedFileLogging("logs/test_mmap_log.txt", 4096);
+        for (int i = 0; i < 200; ++i) {
+            log.logMessage("Mapped line {} spans several chunks over time", i);
+        }
+        log.disableFileLogging();
+
+        std::ifstream mapped("logs/test_mmap_log.txt", std::ios::binary);
+        std::string content((std::istreambuf_iterator<char>(mapped)), std::istreambuf_iterator<char>());
+        std::size_t lines = 0;
+        for (char c : content) {
+            lines += c == '\n' ? 1 : 0;
+        }
+
+        std::cout << "Mapped file size: " << content.size() << ", lines: " << lines << std::endl;
+        if (content.find('\0') != std::string::npos || content.find("Mapped line 199") == std::string::npos) {
+            return 1;
+        }
+    }
+
+    std::cout << "\n--- Log rotation test ---\n" << std::endl;
+
+    // Test 10: Size-based rotation keeps at most maxFiles rotated files
+    {
+        std::filesystem::remove_all("logs/rotation");
+        std::filesystem::create_directories("logs/rotation");
+        std::ofstream("logs/rotation/rotating_log.txt.bak") << "not a rotated file\n";
+        std::ofstream("logs/rotation/rotating_log.txt.20260101-000000.old") << "nor this one\n";
+
+        LogRotationPolicy rotationPolicy;
+        rotationPolicy.maxFileBytes = 2048;
+        rotationPolicy.maxFiles = 3;
+
+        LoggerHandler log("RotatingLogger");
+        log.enableFileLogging("logs/rotation/rotating_log.txt", LogFlushPolicy(), rotationPolicy);
+        log.enableAsyncLogging();
+        for (int i = 0; i < 400; ++i) {
+            log.logMessage("Rotating line {} with some padding to fill the file", i);
+        }
+        log.disableFileLogging();
+
+        std::size_t rotatedFiles = 0;
+        for (const auto& entry : std::filesystem::directory_iterator("logs/rotation")) {
+            std::string name = entry.path().filename().string();
+            rotatedFiles += name != "rotating_log.txt" && name != "rotating_log.txt.bak" &&
+                            name != "rotating_log.txt.20260101-000000.old" ? 1 : 0;
+        }
+        bool othersKept = std::filesystem::exists("logs/rotation/rotating_log.txt.bak") &&
+                          std::filesystem::exists("logs/rotation/rotating_log.txt.20260101-000000.old");
+
+        std::cout << "Rotated files kept: " << rotatedFiles << std::endl;
+        if (rotatedFiles == 0 || rotatedFiles > rotationPolicy.maxFiles || !othersKept) {
+            return 1;
+        }
+    }
+
+    std::cout << "\n--- Compression test ---\n" << std::endl;
+
+    // Test 11: Rotated files are compressed, and a streaming sink writes gzip members
+    if (LogCompressor::isAvailable(LogCompression::Gzip)) {
+        std::filesystem::remove_all("logs/compressed");
+
+        LogRotationPolicy rotationPolicy;
+        rotationPolicy.maxFileBytes = 4096;
+        LogCompressionPolicy compressionPolicy;
+        compressionPolicy.rotatedFiles = LogCompression::Gzip;
+
+        LoggerHandler rotating("GzipRotation");
+        rotating.enableFileLogging("logs/compressed/rotated_log.txt", LogFlushPolicy(),
+                                   rotationPolicy, compressionPolicy);
+        for (int i = 0; i < 200; ++i) {
+            rotating.logMessage("Compressible line {} compressible line compressible line", i);
+        }
+        rotating.disableFileLogging();
+
+        LogCompressionPolicy streamPolicy;
+        streamPolicy.stream = LogCompression::Gzip;
+
+        LoggerHandler streaming("GzipStream");
+        streaming.enableFileLogging("logs/compressed/stream_log.txt.gz", LogFlushPolicy(),
+                                    LogRotationPolicy(), streamPolicy);
+        for (int i = 0; i < 200; ++i) {
+            streaming.logMessage("Streamed line {}", i);
+        }
+        streaming.disableFileLogging();
+
+        std::size_t gzipFiles = 0;
+        for (const auto& entry : std::filesystem::directory_iterator("logs/compressed")) {
+            gzipFiles += entry.path().extension() == ".gz" ? 1 : 0;
+        }
+
+        std::ifstream stream("logs/compressed/stream_log.txt.gz", std::ios::binary);
+        unsigned char magic[2] = {};
+        stream.read(reinterpret_cast<char*>(magic), 2);
+
+        std::cout << "Compressed files: " << gzipFiles << std::endl;
+        if (gzipFiles < 2 || magic[0] != 0x1f || magic[1] != 0x8b) {
+            return 1;
+        }
+    }
+
+    // Test 12: Binary records read back with the original messages and levels
+    {
+        std::filesystem::remove("logs/binary_log.bin");
+
+        LoggerHandler binary("BinaryLogger");
+        binary.enableBinaryFileLogging("logs/binary_log.bin");
+        for (int i = 0; i < 100; ++i) {
+            binary.logWarning("Binary record {}", i);
+        }
+        binary.disableFileLogging();
+
+        std::ifstream input("logs/binary_log.bin", std::ios::binary);
+        LogBinaryReader reader(input);
+        LogBinaryRecord record;
+        int records = 0;
+        bool matches = true;
+        while (reader.next(record)) {
+            matches = matches && record.message == "Binary record " + std::to_string(records) &&
+                      record.level == LogLevel::Warning &&
+                      reader.loggerName(record.loggerId) == "BinaryLogger";
+            ++records;
+        }
+
+        std::cout << "Binary records read: " << records << std::endl;
+        if (records != 100 || !matches || reader.failed()) {
+            return 1;
+        }
+    }
+
+    // Test 13: Fan-out to several sinks, each with its own level and format
+    {
+        auto everything = std::make_shared<LogMemorySink>();
+        auto errorsOnly = std::make_shared<LogMemorySink>();
+        auto binaryRecords = std::make_shared<LogMemorySink>(LogSinkFormat::Binary);
+        errorsOnly->setMinLevel(LogLevel::Error);
+
+        LoggerHandler fanOut("FanOutLogger");
+        fanOut.removeSink(fanOut.getConsoleSink());
+        fanOut.addSink(everything);
+        fanOut.addSink(errorsOnly);
+        fanOut.addSink(binaryRecords);
+
+        fanOut.enableAsyncLogging();
+        for (int i = 0; i < 50; ++i) {
+            fanOut.logMessage("Fan-out record {}", i);
+            if (i % 10 == 0) {
+                fanOut.logError("Fan-out error {}", i);
+            }
+        }
+        fanOut.flush();
+
+        std::vector<std::string> lines = everything->getRecords();
+        std::vector<std::string> errors = errorsOnly->getRecords();
+        bool textMatches = lines.size() == 55 && lines[0].find("Fan-out record 0") != std::string::npos &&
+                           errors.size() == 5 && errors[4].find("[ERROR..] Fan-out error 40") != std::string::npos;
+
+        std::cout << "Fan-out: " << lines.size() << " lines, " << errors.size() << " errors, "
+                  << binaryRecords->getRecordCount() << " binary records" << std::endl;
+        if (!textMatches || binaryRecords->getRecordCount() != 55) {
+            return 1;
+        }
+    }
+
+    // Test 14: Lines of a batch stay together while other threads log
+    {
+        auto memory = std::make_shared<LogMemorySink>();
+        LoggerHandler batched("BatchLogger");
+        batched.removeSink(batched.getConsoleSink());
+        batched.addSink(memory);
+        batched.enableAsyncLogging();
+
+        std::vector<std::thread> writers;
+        for (int t = 0; t < 4; ++t) {
+            writers.emplace_back([&batched, t]() {
+                for (int b = 0; b < 10; ++b) {
+                    LogBatch batch(batched);
+                    for (int i = 0; i < 50; ++i) {
+                        batch.log(LogLevel::Message, "batch {}.{} line {}", t, b, i);
+                    }
+                }
+                batched.logMany(LogLevel::Warning, {"many 1", "many 2", "many 3"});
+            });
+        }
+        for (auto& writer : writers) {
+            writer.join();
+        }
+        batched.flush();
+
+        std::vector<std::string> lines = memory->getRecords();
+        bool contiguous = lines.size() == 4 * (10 * 50 + 3);
+        for (std::size_t i = 0; contiguous && i < lines.size(); ++i) {
+            std::size_t start = lines[i].find("batch ");
+            if (start == std::string::npos) {
+                continue;
+            }
+            // The first line of every batch is followed by its 49 siblings
+            std::string batchName = lines[i].substr(start, lines[i].find(" line ") - start);
+            if (lines[i].find(" line 0") != std::string::npos) {
+                for (std::size_t j = 1; j < 50; ++j) {
+                    contiguous = contiguous && i + j < lines.size() &&
+                                 lines[i + j].find(batchName + " line " + std::to_string(j)) != std::string::npos;
+                }
+            }
+        }
+
+        std::cout << "Batched lines: " << lines.size() << (contiguous ? " (contiguous)" : " (interleaved)") << std::endl;
+        if (!contiguous) {
+            return 1;
+        }
+    }
+
+    // Test 15: Registry loggers share one sink (and one banner) per file
+    {
+        std::filesystem::remove("logs/registry_log.txt");
+        LogRegistry& registry = LogRegistry::instance();
+
+        {
+            std::shared_ptr<LogSink> sharedFile = registry.getFileSink("logs/registry_log.txt");
+            std::shared_ptr<LogSink> samePath = registry.getFileSink("logs/../logs/registry_log.txt");
+            if (sharedFile != samePath) {
+                return 1;
+            }
+
+            std::vector<std::thread> workers;
+            for (int t = 0; t < 5; ++t) {
+                workers.emplace_back([&registry, &sharedFile, t]() {
+                    auto worker = registry.createLogger("Thread" + std::to_string(t));
+                    worker->removeSink(worker->getConsoleSink());
+                    worker->addSink(sharedFile);
+                    for (int i = 0; i < 20; ++i) {
+                        worker->logMessage("Registry line {} from thread {}", i, t);
+                    }
+                });
+            }
+            for (auto& worker : workers) {
+                worker.join();
+            }
+
+            // The level set on the sink the registry returns is the file's level
+            sharedFile->setMinLevel(LogLevel::Warning);
+            auto filtered = registry.createLogger("RegistryLevel");
+            filtered->removeSink(filtered->getConsoleSink());
+            filtered->addSink(sharedFile);
+            filtered->logMessage("Registry level below the sink");
+            filtered->logWarning("Registry level kept by the sink");
+        }
+
+        if (registry.getLogger("Shared") != registry.getLogger("Shared")) {
+            return 1;
+        }
+        registry.dropLogger("Shared");
+
+        std::ifstream logFile("logs/registry_log.txt");
+        std::string line;
+        int banners = 0;
+        int lines = 0;
+        int belowLevel = 0;
+        int keptLevel = 0;
+        while (std::getline(logFile, line)) {
+            banners += line.find("Log Started") != std::string::npos ? 1 : 0;
+            lines += line.find("Registry line") != std::string::npos ? 1 : 0;
+            belowLevel += line.find("Registry level below") != std::string::npos ? 1 : 0;
+            keptLevel += line.find("Registry level kept") != std::string::npos ? 1 : 0;
+        }
+
+        std::cout << "Registry file: " << banners << " banner, " << lines << " lines" << std::endl;
+        if (banners != 1 || lines != 100 || belowLevel != 0 || keptLevel != 1) {
+            return 1;
+        }
+    }
+
+    // Test 16: Thread-buffered logging keeps every record and each thread's order
+    for (LogMergeOrder order : {LogMergeOrder::Timestamp, LogMergeOrder::PerThread}) {
+        auto memory = std::make_shared<LogMemorySink>();
+        LoggerHandler buffered("BufferedLogger");
+        buffered.removeSink(buffered.getConsoleSink());
+        buffered.addSink(memory);
+        buffered.enableThreadBufferedLogging(64, order);
+
+        std::vector<std::thread> producers;
+        for (int t = 0; t < 4; ++t) {
+            producers.emplace_back([&buffered, t]() {
+                for (int i = 0; i < 200; ++i) {
+                    buffered.logMessage("producer {} record {}", t, i);
+                }
+            });
+        }
+        for (auto& producer : producers) {
+            producer.join();
+        }
+        buffered.disableAsyncLogging();
+
+        std::vector<std::string> lines = memory->getRecords();
+        int nextRecord[4] = {0, 0, 0, 0};
+        bool ordered = lines.size() == 800;
+        for (const std::string& line : lines) {
+            std::size_t at = line.find("producer ");
+            int producer = line[at + 9] - '0';
+            ordered = ordered && line.compare(at + 10, std::string::npos,
+                                              " record " + std::to_string(nextRecord[producer]++)) == 0;
+        }
+
+        std::cout << "Thread-buffered lines: " << lines.size() << (ordered ? " (in order)" : " (out of order)")
+                  << std::endl;
+        if (!ordered) {
+            return 1;
+        }
+    }
+
+    // Test 17: A crashing process still writes out its buffered lines
+#ifndef _WIN32
+    {
+        std::filesystem::remove("logs/crash_log.txt");
+        std::cout.flush();
+
+        pid_t child = fork();
+        if (child == 0) {
+            LogFlushPolicy keepEverything;
+            keepEverything.maxBufferedBytes = 1024 * 1024;
+            keepEverything.maxDelay = std::chrono::milliseconds(0);
+            keepEverything.flushLevel = LogLevel::Off;
+
+            LoggerHandler crashing("CrashLogger");
+            crashing.removeSink(crashing.getConsoleSink());
+            crashing.enableFileLogging("logs/crash_log.txt", keepEverything);
+            LogCrashHandler::install();
+            for (int i = 0; i < 100; ++i) {
+                crashing.logMessage("Line {} before the crash", i);
+            }
+            std::raise(SIGSEGV);
+            _exit(0);
+        }
+
+        int status = 0;
+        waitpid(child, &status, 0);
+
+        std::ifstream crashLog("logs/crash_log.txt");
+        std::string line;
+        int lines = 0;
+        bool marker = false;
+        while (std::getline(crashLog, line)) {
+            lines += line.find("before the crash") != std::string::npos ? 1 : 0;
+            marker = marker || line.find("Crash: SIGSEGV") != std::string::npos;
+        }
+
+        // The crash path's fixed UTC offset renders the same local time without localtime_r
+        auto now = std::chrono::system_clock::now();
+        LogTimestampCache zoneCache;
+        LogTimestampCache fixedCache;
+        fixedCache.setFixedUtcOffset(LogTimestampCache::utcOffsetAt(now));
+        bool timestampsMatch = true;
+        for (auto offset : {std::chrono::seconds(0), std::chrono::seconds(1), std::chrono::seconds(150)}) {
+            char zoneText[logTimestampLength];
+            char fixedText[logTimestampLength];
+            zoneCache.format(now + offset, zoneText);
+            fixedCache.format(now + offset, fixedText);
+            timestampsMatch = timestampsMatch && std::string(zoneText, logTimestampLength) ==
+                                                     std::string(fixedText, logTimestampLength);
+        }
+
+        std::cout << "Lines recovered after crash: " << lines << std::endl;
+        if (!WIFSIGNALED(status) || WTERMSIG(status) != SIGSEGV || lines != 100 || !marker || !timestampsMatch) {
+            return 1;
+        }
+    }
+#endif
+
+    // Test 18: Rate-limited call sites and collapsed repeats
+    {
+        auto memory = std::make_shared<LogMemorySink>();
+        LoggerHandler limited("LimitedLogger");
+        limited.removeSink(limited.getConsoleSink());
+        limited.addSink(memory);
+
+        int evaluated = 0;
+        for (int i = 0; i < 1000; ++i) {
+            LOGGER_WARNING_LIMITED(limited, 1.0, 5, "Limited record {}", ++evaluated);
+        }
+        std::size_t admitted = memory->getRecordCount();
+        std::cout << "Rate limit admitted " << admitted << " of 1000 records ("
+                  << limited.getRateLimitedRecords() << " suppressed)" << std::endl;
+        if (admitted < 5 || admitted > 6 || evaluated != static_cast<int>(admitted) ||
+            admitted + limited.getRateLimitedRecords() != 1000) {
+            return 1;
+        }
+
+        // A zero rate with a large burst saturates instead of overflowing
+        LogRateLimiter stopped(0.0, 100);
+        std::size_t stoppedAdmitted = 0;
+        for (int i = 0; i < 1000; ++i) {
+            stoppedAdmitted += stopped.tryAcquire() ? 1 : 0;
+        }
+        if (stoppedAdmitted == 0 || stoppedAdmitted > 100 || stopped.takeSuppressed() != 1000 - stoppedAdmitted) {
+            return 1;
+        }
+
+        memory->clear();
+        limited.setCollapseRepeats(true);
+        for (int i = 0; i < 100; ++i) {
+            limited.logMessage("Same message");
+        }
+        for (int i = 0; i < 10; ++i) {
+            limited.logMessage("Same format {}", 7);
+        }
+        limited.logError("Different message");
+        limited.flush();
+
+        std::vector<std::string> lines = memory->getRecords();
+        bool collapsed = lines.size() == 5 &&
+                         lines[0].find("Same message") != std::string::npos &&
+                         lines[1].find("Last message repeated 99 times") != std::string::npos &&
+                         lines[2].find("Same format 7") != std::string::npos &&
+                         lines[3].find("Last message repeated 9 times") != std::string::npos &&
+                         lines[4].find("Different message") != std::string::npos;
+        std::cout << "Collapsed " << limited.getCollapsedRecords() << " repeated records" << std::endl;
+        if (!collapsed || limited.getCollapsedRecords() != 108) {
+            return 1;
+        }
+    }
+
+    // Test 19: Sampling keeps 1 in N (or a fraction) and labels kept lines
+    {
+        auto memory = std::make_shared<LogMemorySink>();
+        LoggerHandler sampled("SampledLogger");
+        sampled.removeSink(sampled.getConsoleSink());
+        sampled.addSink(memory);
+
+        sampled.setSampleEvery(LogLevel::Message, 10);
+        sampled.setSampleProbability(LogLevel::Success, 0.25);
+        for (int i = 0; i < 1000; ++i) {
+            sampled.logMessage("Chatter {}", i);
+            sampled.logSuccess("Progress");
+        }
+        sampled.logError("Never sampled");
+
+        std::size_t every = 0;
+        std::size_t fraction = 0;
+        bool labelled = true;
+        for (const std::string& line : memory->getRecords()) {
+            if (line.find("Chatter") != std::string::npos) {
+                ++every;
+                labelled = labelled && line.find("[sample rate 1/10]") != std::string::npos;
+            } else if (line.find("Progress") != std::string::npos) {
+                ++fraction;
+                labelled = labelled && line.find("[sample rate 1/4]") != std::string::npos;
+            } else {
+                labelled = labelled && line.find("[sample rate") == std::string::npos;
+            }
+        }
+
+        std::cout << "Sampled lines kept: " << every << " of 1000 (1/10), "
+                  << fraction << " of 1000 (p=0.25)" << std::endl;
+        if (every != 100 || fraction < 180 || fraction > 320 || !labelled ||
+            sampled.getSampledOutRecords() != 2000 - every - fraction) {
+            return 1;
+        }
+    }
+
+    // Test 20: Structured records as JSON lines, logfmt and text
+    {
+        auto json = std::make_shared<LogMemorySink>(LogSinkFormat::Json);
+        auto logfmt = std::make_shared<LogMemorySink>(LogSinkFormat::Logfmt);
+        auto text = std::make_shared<LogMemorySink>();
+        LoggerHandler structured("StructuredLogger");
+        structured.removeSink(structured.getConsoleSink());
+        structured.addSink(json);
+        structured.addSink(logfmt);
+        structured.addSink(text);
+
+        std::string user = "ann \"quoted\"\n";
+        structured.logFields(LogLevel::Warning, "Login slow", logField("user", user),
+                             logField("ms", 250), logField("ok", false), logField("ratio", 0.5));
+        structured.enableAsyncLogging();
+        structured.logFields(LogLevel::Message, "Queued", logField("id", 7u));
+        structured.flush();
+
+        std::vector<std::string> jsonLines = json->getRecords();
+        std::vector<std::string> logfmtLines = logfmt->getRecords();
+        std::vector<std::string> textLines = text->getRecords();
+        bool encoded = jsonLines.size() == 2 && logfmtLines.size() == 2 && textLines.size() == 2 &&
+            jsonLines[0].find("\"level\":\"warning\",\"logger\":\"StructuredLogger\",\"msg\":\"Login slow\","
+                              "\"user\":\"ann \\\"quoted\\\"\\n\",\"ms\":250,\"ok\":false,\"ratio\":0.5}") != std::string::npos &&
+            jsonLines[1].find("\"msg\":\"Queued\",\"id\":7}") != std::string::npos &&
+            logfmtLines[0].find("level=warning logger=StructuredLogger msg=\"Login slow\" "
+                                "user=\"ann \\\"quoted\\\"\\n\" ms=250 ok=false ratio=0.5") != std::string::npos &&
+            textLines[1].find("Queued id=7") != std::string::npos &&
+            jsonLines[1].back() == '}' && logfmtLines[0].back() == '5';
+
+        // UTC times with a zone designator, and keys that cannot break a logfmt line
+        bool zoned = jsonLines[0].compare(0, 9, "{\"time\":\"") == 0 && jsonLines[0].size() > 35 &&
+                     jsonLines[0][19] == 'T' && jsonLines[0].compare(32, 3, "Z\",") == 0 &&
+                     logfmtLines[0].compare(0, 5, "time=") == 0 && logfmtLines[0].size() > 29 &&
+                     logfmtLines[0].compare(28, 2, "Z ") == 0;
+        std::string badKeyFields;
+        LogStructuredFormat::encodeFields(badKeyFields, logField("bad key=\"x\"", 1), logField("", 2));
+        LogLineBuffer keyLine;
+        LogStructuredFormat::appendLogfmtFields(keyLine, badKeyFields.data(), badKeyFields.size());
+        bool keysSafe = std::string(keyLine.data(), keyLine.size()) == " bad_key__x_=1 _=2";
+
+        std::cout << "Structured JSON line: " << jsonLines.front() << std::endl;
+        if (!encoded || !zoned || !keysSafe) {
+            return 1;
+        }
+    }
+
+    // Test 21: Network sink ships syslog over TCP and counts what it cannot deliver
+#ifndef _WIN32
+    {
+        int listener = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t addressLength = sizeof(address);
+        bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+        listen(listener, 1);
+        getsockname(listener, reinterpret_cast<sockaddr*>(&address), &addressLength);
+
+        LogNetworkOptions options;
+        options.port = ntohs(address.sin_port);
+        options.protocol = LogNetworkProtocol::SyslogTcp;
+        options.hostname = "testhost";
+        options.appName = "test_logger";
+
+        std::string received;
+        {
+            auto network = std::make_shared<LogNetworkSink>(options);
+            LoggerHandler shipping("NetworkLogger");
+            shipping.removeSink(shipping.getConsoleSink());
+            shipping.addSink(network);
+            for (int i = 0; i < 100; ++i) {
+                shipping.logWarning("Shipped record {}", i);
+            }
+            shipping.flush();
+
+            int connection = accept(listener, nullptr, nullptr);
+            timeval timeout{2, 0};
+            setsockopt(connection, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+            char chunk[4096];
+            while (received.find("Shipped record 99") == std::string::npos) {
+                ssize_t length = recv(connection, chunk, sizeof(chunk), 0);
+                if (length <= 0) {
+                    break;
+                }
+                received.append(chunk, static_cast<std::size_t>(length));
+            }
+            close(connection);
+        }
+        close(listener);
+
+        // Octet-counted frames: "LENGTH <12>1 TIMESTAMP testhost test_logger PID - - MSG"
+        std::size_t frames = 0;
+        std::size_t position = 0;
+        bool framed = true;
+        while (position < received.size()) {
+            std::size_t space = received.find(' ', position);
+            std::size_t length = std::stoul(received.substr(position, space - position));
+            std::string frame = received.substr(space + 1, length);
+            framed = framed && frame.compare(0, 6, "<12>1 ") == 0 &&
+                     frame.find(" testhost test_logger ") != std::string::npos &&
+                     frame.find("- - Shipped record " + std::to_string(frames)) != std::string::npos;
+            position = space + 1 + length;
+            ++frames;
+        }
+
+        // Nobody listening: records wait in the spill buffer, then overflow it
+        LogNetworkOptions unreachable = options;
+        unreachable.spillBytes = 2048;
+        unreachable.flushTimeout = std::chrono::milliseconds(0);
+        auto stranded = std::make_shared<LogNetworkSink>(unreachable);
+        LoggerHandler dropping("DroppingLogger");
+        dropping.removeSink(dropping.getConsoleSink());
+        dropping.addSink(stranded);
+        for (int i = 0; i < 100; ++i) {
+            dropping.logMessage("Undeliverable record {}", i);
+        }
+
+        std::cout << "Network frames received: " << frames << ", dropped while unreachable: "
+                  << stranded->getDroppedRecords() << std::endl;
+        if (frames != 100 || !framed || stranded->getDroppedRecords() == 0 ||
+            stranded->getSpilledBytes() > unreachable.spillBytes) {
+            return 1;
+        }
+    }
+#endif
+
+    // Test 22: The asynchronous I/O backend keeps several writes in flight, in order
+    {
+        std::filesystem::remove_all("logs/async_io");
+
+        LogFlushPolicy inFlight;
+        inFlight.maxBufferedBytes = 4096;
+        inFlight.ioBackend = LogFileIoBackend::Async;
+        inFlight.buffersInFlight = 8;
+
+        LoggerHandler submitting("AsyncIoLogger");
+        submitting.removeSink(submitting.getConsoleSink());
+        submitting.enableStructuredFileLogging("logs/async_io/records.jsonl", LogSinkFormat::Json, inFlight);
+        submitting.enableAsyncLogging();
+        for (int i = 0; i < 20000; ++i) {
+            submitting.logFields(LogLevel::Message, "Submitted", logField("seq", i));
+        }
+        submitting.disableFileLogging();
+
+        std::ifstream records("logs/async_io/records.jsonl");
+        std::string line;
+        int expected = 0;
+        bool ordered = true;
+        while (std::getline(records, line)) {
+            ordered = ordered && line.find(",\"seq\":" + std::to_string(expected) + "}") != std::string::npos;
+            ++expected;
+        }
+
+        std::cout << "Async I/O records written: " << expected << (ordered ? " (in order)" : " (out of order)") << std::endl;
+        if (expected != 20000 || !ordered) {
+            return 1;
+        }
+    }
+
+    // Test 23: Queued payloads live in per-thread arenas that outlive their threads
+    {
+        std::filesystem::remove("logs/arena_log.txt");
+
+        LoggerHandler arenaLogger("ArenaLogger");
+        arenaLogger.removeSink(arenaLogger.getConsoleSink());
+        arenaLogger.enableFileLogging("logs/arena_log.txt");
+        arenaLogger.enableAsyncLogging(1 << 14);
+
+        // These threads are gone before the writer has released their records
+        std::vector<std::thread> producers;
+        for (int t = 0; t < 4; ++t) {
+            producers.emplace_back([&arenaLogger, t]() {
+                std::string line = "Arena thread " + std::to_string(t) + " record";
+                for (int i = 0; i < 2000; ++i) {
+                    arenaLogger.log(LogLevel::Message, std::string_view(line));
+                }
+            });
+        }
+        for (auto& producer : producers) {
+            producer.join();
+        }
+
+        std::string large(LogArena::largestSlabBlock * 2, 'L');
+        arenaLogger.log(LogLevel::Warning, std::move(large));
+        arenaLogger.disableAsyncLogging();
+        arenaLogger.disableFileLogging();
+
+        std::ifstream arenaFile("logs/arena_log.txt");
+        std::string line;
+        int threadLines = 0;
+        bool sawLarge = false;
+        while (std::getline(arenaFile, line)) {
+            threadLines += line.find("Arena thread") != std::string::npos;
+            sawLarge = sawLarge || line.find(std::string(LogArena::largestSlabBlock * 2, 'L')) != std::string::npos;
+        }
+
+        std::cout << "Arena records: " << threadLines << (sawLarge ? " plus the handed-over message" : "")
+                  << ", slabs held: " << LogArena::getAllocatedSlabs() << std::endl;
+        if (threadLines != 8000 || !sawLarge) {
+            return 1;
+        }
+    }
+
+    // Test 24: Self-metrics count records, sink bytes and latencies, and log a summary line
+    {
+        std::filesystem::remove("logs/metrics_log.txt");
+
+        LoggerHandler measured("MetricsLogger");
+        measured.removeSink(measured.getConsoleSink());
+        measured.enableFileLogging("logs/metrics_log.txt");
+        measured.setLatencyMetrics(true);
+        measured.enableAsyncLogging(256, LogOverflowPolicy::DropNewest);
+
+        std::vector<std::thread> producers;
+        for (int t = 0; t < 4; ++t) {
+            producers.emplace_back([&measured]() {
+                for (int i = 0; i < 1000; ++i) {
+                    measured.logMessage("Measured record {}", i);
+                    if (i % 10 == 0) {
+                        measured.logWarning("Measured warning");
+                    }
+                }
+            });
+        }
+        for (auto& producer : producers) {
+            producer.join();
+        }
+        measured.flush();
+
+        LogMetricsSnapshot snapshot = measured.getMetrics();
+        std::uint64_t written = snapshot.records[static_cast<std::size_t>(LogLevel::Message)] +
+                                snapshot.records[static_cast<std::size_t>(LogLevel::Warning)];
+        std::cout << "Metrics: " << snapshot.summary() << std::endl;
+
+        bool countsMatch = written == 4400 && snapshot.droppedRecords == measured.getDroppedRecords() &&
+                           snapshot.queueHighWater > 0 && snapshot.queueCapacity == 256 &&
+                           snapshot.enqueueLatency.count + snapshot.droppedRecords == 4400 &&
+                           snapshot.formatLatency.count == 4400 - snapshot.droppedRecords &&
+                           snapshot.writeLatency.count > 0 && snapshot.totalBytes() > 0 &&
+                           snapshot.totalFlushes() > 0;
+        if (!countsMatch || LogMetrics::globalSnapshot().totalRecords() < written) {
+            std::cout << "Metrics do not add up" << std::endl;
+            return 1;
+        }
+
+        // The periodic line goes to the sinks like any other record
+        measured.setMetricsInterval(std::chrono::milliseconds(1));
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        measured.logMessage("After the interval");
+        measured.disableAsyncLogging();
+        measured.disableFileLogging();
+
+        std::ifstream metricsFile("logs/metrics_log.txt");
+        std::string line;
+        bool sawSummary = false;
+        while (std::getline(metricsFile, line)) {
+            sawSummary = sawSummary || line.find("Logger metrics: records=") != std::string::npos;
+        }
+        if (!sawSummary) {
+            std::cout << "No periodic metrics line" << std::endl;
+            return 1;
+        }
+    }
+
+    // Test 25: Line layouts from compile-time and runtime patterns
+    {
+        auto textSink = std::make_shared<LogMemorySink>();
+        auto jsonSink = std::make_shared<LogMemorySink>(LogSinkFormat::Json);
+        LoggerHandler laidOut("LayoutLogger", {textSink, jsonSink});
+
+        laidOut.logMessage("Default layout");
+        laidOut.setLayout<utcThreadPattern>();
+        laidOut.logWarning("Compiled layout");
+
+        // Queued records keep the id of the thread that logged them
+        std::uint32_t producerId = 0;
+        laidOut.enableAsyncLogging();
+        std::thread producer([&laidOut, &producerId]() {
+            producerId = logThreadId();
+            laidOut.logFields(LogLevel::Error, "Queued layout", logField("n", 1));
+        });
+        producer.join();
+        laidOut.disableAsyncLogging();
+
+        bool rejected = !laidOut.setLayout("{name} {nope} ");
+        bool parsed = laidOut.setLayout("{{{name}}} {level} | ");
+        laidOut.logMessage("Runtime layout");
+
+        std::vector<std::string> lines = textSink->getRecords();
+        std::vector<std::string> json = jsonSink->getRecords();
+        for (const auto& line : lines) {
+            std::cout << "Layout line: " << line << std::endl;
+        }
+
+        std::string compiledPrefix = " tid=" + std::to_string(logThreadId()) + " WARNING: Compiled layout";
+        std::string queuedPrefix = " tid=" + std::to_string(producerId) + " ERROR..: Queued layout n=1";
+        bool layoutsMatch =
+            lines.size() == 4 && json.size() == 4 &&
+            lines[0].size() > 26 && lines[0][0] == '[' && lines[0][24] == ']' &&
+            lines[0].substr(25) == " [LayoutLogger...] [MESSAGE] Default layout" &&
+            lines[1].size() > 24 && lines[1][10] == 'T' && lines[1][23] == 'Z' &&
+            lines[1].substr(24) == compiledPrefix &&
+            lines[2].substr(24) == queuedPrefix &&
+            lines[3] == "{LayoutLogger...} MESSAGE | Runtime layout" &&
+            json[2].find("\"msg\":\"Queued layout\"") != std::string::npos &&
+            rejected && parsed;
+        if (!layoutsMatch) {
+            std::cout << "Line layouts do not match" << std::endl;
+            return 1;
+        }
+    }
+
+    // Test 26: Call sites interned once per statement and resolved by each sink
+    {
+        std::filesystem::remove("logs/call_site_log.bin");
+
+        auto textSink = std::make_shared<LogMemorySink>();
+        auto jsonSink = std::make_shared<LogMemorySink>(LogSinkFormat::Json);
+        LoggerHandler sited("CallSiteLogger", {textSink, jsonSink});
+        sited.setLayout("{file}:{line} {function} {level}: ");
+
+        std::uint32_t sitesBefore = LogCallSites::count();
+        std::uint32_t siteLine = 0;
+        for (int i = 0; i < 3; ++i) {
+            siteLine = __LINE__ + 1;
+            LOGGER_WARNING_AT(sited, "Site record {}", i);
+        }
+        sited.logMessage("No site");
+        std::uint32_t sitesAdded = LogCallSites::count() - sitesBefore;
+
+        // Binary files define each site once, before its first record
+        sited.enableBinaryFileLogging("logs/call_site_log.bin");
+        sited.enableAsyncLogging();
+        std::uint32_t producerId = 0;
+        std::thread producer([&sited, &producerId]() {
+            producerId = logThreadId();
+            LOGGER_ERROR_AT(sited, "From a thread");
+        });
+        producer.join();
+        LOGGER_MESSAGE_AT(sited, "From main");
+        sited.disableAsyncLogging();
+        sited.disableFileLogging();
+
+        std::vector<std::string> lines = textSink->getRecords();
+        std::vector<std::string> json = jsonSink->getRecords();
+        for (const auto& line : lines) {
+            std::cout << "Call-site line: " << line << std::endl;
+        }
+
+        std::string siteSuffix = ":" + std::to_string(siteLine) + " main WARNING: Site record 2";
+        bool linesMatch =
+            sitesAdded == 1 && lines.size() >= 4 && json.size() >= 4 &&
+            lines[2].find("test_logger.cpp") != std::string::npos &&
+            lines[2].size() > siteSuffix.size() &&
+            lines[2].compare(lines[2].size() - siteSuffix.size(), siteSuffix.size(), siteSuffix) == 0 &&
+            lines[3] == ":  MESSAGE: No site" &&
+            json[0].find("\"line\":" + std::to_string(siteLine)) != std::string::npos &&
+            json[0].find("\"function\":\"main\"") != std::string::npos &&
+            json[3].find("\"file\":") == std::string::npos;
+
+        std::ifstream input("logs/call_site_log.bin", std::ios::binary);
+        LogBinaryReader reader(input);
+        LogBinaryRecord record;
+        std::vector<LogBinaryRecord> records;
+        while (reader.next(record)) {
+            records.push_back(record);
+        }
+        const LogBinaryCallSite* threadSite = records.size() == 2 ? reader.callSite(records[0].callSite) : nullptr;
+        const LogBinaryCallSite* mainSite = records.size() == 2 ? reader.callSite(records[1].callSite) : nullptr;
+        bool binaryMatches =
+            threadSite != nullptr && mainSite != nullptr && threadSite != mainSite &&
+            records[0].thread == producerId && records[1].thread == logThreadId() &&
+            records[0].message == "From a thread" && threadSite->level == LogLevel::Error &&
+            threadSite->format == "From a thread" && mainSite->function == "main" &&
+            !reader.failed();
+
+        if (!linesMatch || !binaryMatches) {
+            std::cout << "Call sites do not match" << std::endl;
+            return 1;
+        }
+    }
+
+    // Test 27: Config snapshots swapped while logging, from a file and on SIGHUP
+    {
+        auto memory = std::make_shared<LogMemorySink>();
+        LoggerHandler configured("ConfigLogger", {memory});
+        const std::string configPath = "logs/config_test.conf";
+        auto writeConfig = [&configPath](const std::string& text) {
+            std::ofstream(configPath, std::ios::trunc) << text;
+        };
+
+        writeConfig("level = error\n[ConfigLogger]\nlevel = warning\npattern = \"{level}: \"\n");
+        bool loaded = configured.loadConfig(configPath);
+        configured.logMessage("Filtered by the file");
+        configured.logWarning("Kept by the section");
+
+        LogConfigFile broken;
+        bool rejected = !broken.parse("# comment\nlevel = loud\n") &&
+                        broken.error() == "line 2: bad value for level: 'loud'";
+        bool unchanged = !configured.applyConfig(broken) && configured.getMinLevel() == LogLevel::Warning;
+
+        // A writer keeps logging while the reloader swaps the snapshot under it
+        std::atomic<bool> running{true};
+        std::thread writer([&configured, &running]() {
+            for (int i = 0; i < 20000 && running; ++i) {
+                configured.logError("Busy");
+            }
+        });
+        LogConfigReloader reloader(configPath);
+        reloader.watch(configured);
+        writeConfig("[ConfigLogger]\nlevel = message\nsample_every.error = 2\n");
+#ifndef _WIN32
+        std::raise(SIGHUP);
+        for (int wait = 0; wait < 500 && reloader.getReloadCount() == 0; ++wait) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+#else
+        reloader.reload();
+#endif
+        running = false;
+        writer.join();
+        reloader.unwatch(configured);
+
+        LogConfig snapshot = configured.getConfig();
+        configured.logMessage("Raised by SIGHUP");
+
+        // Distinct snapshots and layouts swapped in under a logging thread are freed, not kept
+        auto churnSink = std::make_shared<LogMemorySink>(LogSinkFormat::Text, 16);
+        LoggerHandler churning("ChurnLogger", {churnSink});
+        std::atomic<bool> churn{true};
+        std::thread churnWriter([&churning, &churn]() {
+            while (churn) {
+                churning.logError("Churn");
+            }
+        });
+        for (int i = 1; i <= 2000; ++i) {
+            churning.setSampleProbability(LogLevel::Error, 0.5 + i / 10000.0);
+            churning.setLayout(i % 2 == 0 ? "{level}: " : "{level} {name}: ");
+        }
+        churn = false;
+        churnWriter.join();
+        std::size_t retired = churning.getRetiredSnapshots();
+        std::cout << "Retired snapshots still held: " << retired << std::endl;
+
+        std::vector<std::string> records = memory->getRecords();
+        std::cout << "Config reloads: " << reloader.getReloadCount() << ", records: " << records.size() << std::endl;
+        bool configMatches =
+            loaded && rejected && unchanged && reloader.getReloadCount() == 1 && retired <= 8 &&
+            snapshot.minLevel == LogLevel::Message && snapshot.sampleCounted[3] && snapshot.sampleRates[3] == 0.5f &&
+            !snapshot.sampleCounted[2] && records.size() >= 2 &&
+            records.front() == "WARNING: Kept by the section" &&
+            records.back() == "MESSAGE: Raised by SIGHUP";
+        for (const auto& record : records) {
+            configMatches = configMatches && record.find("Filtered") == std::string::npos;
+        }
+        if (!configMatches) {
+            std::cout << "Config reload does not match" << std::endl;
+            return 1;
+        }
+    }
+
+#ifndef _WIN32
+    // Test 28: Worker processes logging through shared-memory rings to one collector
+    {
+        LogCollectorOptions collectorOptions;
+        collectorOptions.channelName = "logger_test_" + std::to_string(getpid());
+        collectorOptions.ringCount = 4;
+        collectorOptions.ringBytes = 4096;
+        collectorOptions.reclaimInterval = std::chrono::milliseconds(0);
+        LogCollector collector(collectorOptions);
+        auto collected = std::make_shared<LogMemorySink>();
+        bool sinksMatch = collector.addSink(collected) &&
+                          !collector.addSink(std::make_shared<LogMemorySink>(LogSinkFormat::Json));
+
+        auto ringSink = std::make_shared<LogSharedMemorySink>(collectorOptions.channelName);
+        LoggerHandler worker("RingWorker", {ringSink});
+        worker.setLayout("{level}: ");
+        worker.logMessage("Parent first");
+        worker.logMessage(std::string(3000, 'x')); // more than half the ring: dropped
+
+        // The child inherits the parent's sink and claims a ring of its own,
+        // then exits without releasing it
+        std::cout.flush();
+        pid_t child = fork();
+        if (child == 0) {
+            worker.logWarning("From the child");
+            worker.flush();
+            _exit(ringSink->isAttached() ? 0 : 1);
+        }
+        int status = 0;
+        waitpid(child, &status, 0);
+        worker.logError("Parent last");
+        worker.flush();
+
+        std::size_t records = collector.collect();
+        std::vector<std::string> lines = collected->getRecords();
+        std::cout << "Collected " << records << " records from " << collector.getProducerCount()
+                  << " producers, dropped " << collector.getDroppedRecords() << std::endl;
+        bool collectedMatch =
+            collector.isOpen() && sinksMatch && WIFEXITED(status) && WEXITSTATUS(status) == 0 &&
+            records == 3 && lines.size() == 3 && lines[0] == "MESSAGE: Parent first" &&
+            lines[1] == "WARNING: From the child" && lines[2] == "ERROR..: Parent last" &&
+            collector.getProducerCount() == 1 && collector.getDroppedRecords() == 1 &&
+            ringSink->getDroppedRecords() == 1 && ringSink->isAttached();
+        if (!collectedMatch) {
+            std::cout << "Shared-memory collection does not match" << std::endl;
+            return 1;
+        }
+    }
+#endif
+
+#ifndef _WIN32
+    // Test 29: Console output off a terminal is written out by age, in order across loggers sharing a mutex
+    {
+        std::filesystem::remove("logs/console_log.txt");
+        std::cout.flush();
+
+        pid_t child = fork();
+        if (child == 0) {
+            int captured = open("logs/console_log.txt", O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            dup2(captured, STDOUT_FILENO);
+
+            LogFlushPolicy collect;
+            collect.maxBufferedBytes = 64 * 1024;
+            collect.maxDelay = std::chrono::milliseconds(50);
+            collect.flushLevel = LogLevel::Off;
+
+            std::mutex console;
+            LoggerHandler first("ConsoleFirst", console);
+            LoggerHandler second("ConsoleSecond", console);
+            first.getConsoleSink()->setFlushPolicy(collect);
+            second.getConsoleSink()->setFlushPolicy(collect);
+            first.logMessage("Console line 1");
+            second.logMessage("Console line 2");
+            first.logMessage("Console line 3");
+
+            // Nothing logs after this: only the flusher can write the lines
+            std::this_thread::sleep_for(std::chrono::milliseconds(500));
+            _exit(0);
+        }
+        int status = 0;
+        waitpid(child, &status, 0);
+
+        std::ifstream consoleLog("logs/console_log.txt");
+        std::string line;
+        std::vector<std::string> lines;
+        while (std::getline(consoleLog, line)) {
+            if (line.find("Console line") != std::string::npos) {
+                lines.push_back(line.substr(line.find("Console line")));
+            }
+        }
+        std::cout << "Console lines flushed by age: " << lines.size() << std::endl;
+        if (lines != std::vector<std::string>{"Console line 1", "Console line 2", "Console line 3"}) {
+            std::cout << "Console output does not match" << std::endl;
+            return 1;
+        }
+    }
+#endif
+
+    std::cout << "\nAll tests completed.\n";
+
+    // Keep a console window open when asked; never under ctest
+    if (argc > 1 && std::string(argv[1]) == "--pause") {
+        std::cout << "Press Enter to exit..." << std::flush;
+        std::cin.get();
+    }
+    return 0;
 }
\ No newline at end of file
@@ -0,0 +1,138 @@
+// log_collector – the one writer for worker processes that log through
+// LogSharedMemorySink: creates the shared-memory channel and drains every
+// worker's ring into a file (with rotation) and, if asked, a network
+// collector, until SIGINT or SIGTERM.
+//
+// Usage: log_collector <channel> [options]
+//   --file <path>           output file (default: <channel>.log; "-" for none)
+//   --max-bytes <n>         rotate the file once it reaches n bytes
+//   --hourly | --daily      rotate the file on the hour / at midnight
+//   --keep <n>              rotated files to keep
+//   --tcp <host:port>       also ship the records as a length-prefixed TCP stream
+//   --syslog <host:port>    also ship the records as syslog over UDP
+//   --console               also print the records
+//   --json | --logfmt       the channel carries JSON or logfmt lines (default: text)
+//   --rings <n>             worker processes at once (default 64)
+//   --ring-bytes <n>        ring size per worker (default 1 MiB)
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "LogCollector.hpp"
+#include "LogConsoleSink.hpp"
+#include "LogFileSink.hpp"
+#include "LogNetworkSink.hpp"
+
+static std::atomic<bool> stopRequested{false};
+
+static void handleStop(int) {
+    stopRequested.store(true);
+}
+
+static bool splitAddress(const std::string& address, LogNetworkOptions& options) {
+    std::size_t colon = address.rfind(':');
+    if (colon == std::string::npos || colon == 0 || colon + 1 == address.size()) {
+        return false;
+    }
+    options.host = address.substr(0, colon);
+    options.port = static_cast<std::uint16_t>(std::strtoul(address.c_str() + colon + 1, nullptr, 10));
+    return options.port != 0;
+}
+
+static int usage(const char* program) {
+    std::cerr << "Usage: " << program << " <channel> [--file path|-] [--max-bytes n] [--hourly|--daily]"
+              << " [--keep n] [--tcp host:port] [--syslog host:port] [--console] [--json|--logfmt]"
+              << " [--rings n] [--ring-bytes n]" << std::endl;
+    return 2;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2 || argv[1][0] == '-') {
+        return usage(argv[0]);
+    }
+
+    LogCollectorOptions options;
+    options.channelName = argv[1];
+    std::string filePath = options.channelName + ".log";
+    LogRotationPolicy rotation;
+    std::vector<LogNetworkOptions> destinations;
+    bool console = false;
+
+    for (int i = 2; i < argc; ++i) {
+        std::string option = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (option == "--file" && hasValue) {
+            filePath = argv[++i];
+        } else if (option == "--max-bytes" && hasValue) {
+            rotation.maxFileBytes = std::strtoull(argv[++i], nullptr, 10);
+        } else if (option == "--hourly") {
+            rotation.interval = LogRotationInterval::Hourly;
+        } else if (option == "--daily") {
+            rotation.interval = LogRotationInterval::Daily;
+        } else if (option == "--keep" && hasValue) {
+            rotation.maxFiles = std::strtoull(argv[++i], nullptr, 10);
+        } else if ((option == "--tcp" || option == "--syslog") && hasValue) {
+            LogNetworkOptions destination;
+            destination.protocol = option == "--tcp" ? LogNetworkProtocol::Stream : LogNetworkProtocol::SyslogUdp;
+            if (!splitAddress(argv[++i], destination)) {
+                return usage(argv[0]);
+            }
+            destinations.push_back(destination);
+        } else if (option == "--console") {
+            console = true;
+        } else if (option == "--json") {
+            options.format = LogSinkFormat::Json;
+        } else if (option == "--logfmt") {
+            options.format = LogSinkFormat::Logfmt;
+        } else if (option == "--rings" && hasValue) {
+            options.ringCount = std::strtoull(argv[++i], nullptr, 10);
+        } else if (option == "--ring-bytes" && hasValue) {
+            options.ringBytes = std::strtoull(argv[++i], nullptr, 10);
+        } else {
+            return usage(argv[0]);
+        }
+    }
+
+    LogCollector collector(options);
+    if (!collector.isOpen()) {
+        std::cerr << "Cannot create the shared-memory channel " << options.channelName << std::endl;
+        return 1;
+    }
+
+    if (filePath != "-") {
+        auto fileSink = std::make_shared<LogFileSink>(options.format);
+        fileSink->setRotationPolicy(rotation);
+        if (!fileSink->open(filePath)) {
+            std::cerr << "Cannot open " << filePath << std::endl;
+            return 1;
+        }
+        collector.addSink(fileSink);
+    }
+    for (const LogNetworkOptions& destination : destinations) {
+        collector.addSink(std::make_shared<LogNetworkSink>(destination, options.format));
+    }
+    if (console) {
+        collector.addSink(std::make_shared<LogConsoleSink>());
+    }
+
+    std::signal(SIGINT, handleStop);
+    std::signal(SIGTERM, handleStop);
+    collector.start();
+    std::cerr << "Collecting channel " << options.channelName << " (" << options.ringCount << " rings)" << std::endl;
+
+    while (!stopRequested.load()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+
+    collector.stop();
+    std::cerr << "Collected " << collector.getCollectedRecords() << " records, "
+              << collector.getDroppedRecords() << " dropped by workers" << std::endl;
+    return 0;
+}
@@ -0,0 +1,89 @@
+// log_decode – turn a binary log (LoggerHandler::enableBinaryFileLogging)
+// back into the text layout the logger writes to its text files.
+//
+// Usage: log_decode <binary-log> [text-output]
+// Without an output file the text goes to standard output. Records logged
+// through the LOGGER_*_AT macros get their thread and call site after the
+// prefix: "[1234 main.cpp:42 run] ".
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "LogBinaryFormat.hpp"
+#include "LogTextLayout.hpp"
+#include "LogTimestamp.hpp"
+
+int main(int argc, char* argv[]) {
+    if (argc < 2 || argc > 3) {
+        std::cerr << "Usage: " << argv[0] << " <binary-log> [text-output]" << std::endl;
+        return 2;
+    }
+
+    std::ifstream input(argv[1], std::ios::binary);
+    if (!input.is_open()) {
+        std::cerr << "Cannot open " << argv[1] << std::endl;
+        return 1;
+    }
+
+    std::ofstream outputFile;
+    if (argc == 3) {
+        outputFile.open(argv[2], std::ios::binary | std::ios::trunc);
+        if (!outputFile.is_open()) {
+            std::cerr << "Cannot create " << argv[2] << std::endl;
+            return 1;
+        }
+    }
+    std::ostream& output = argc == 3 ? static_cast<std::ostream&>(outputFile) : std::cout;
+
+    LogBinaryReader reader(input);
+    LogBinaryRecord record;
+    LogTimestampCache timestampCache;
+    LogLineBuffer line;
+    std::vector<std::string> paddedNames;
+    std::vector<std::string> paddedFrom;
+    std::uint64_t records = 0;
+
+    while (reader.next(record)) {
+        // Pad each interned name once (and again if a later header redefines it)
+        const std::string& name = reader.loggerName(record.loggerId);
+        if (record.loggerId >= paddedNames.size()) {
+            paddedNames.resize(record.loggerId + 1);
+            paddedFrom.resize(record.loggerId + 1);
+        }
+        if (paddedNames[record.loggerId].empty() || paddedFrom[record.loggerId] != name) {
+            paddedNames[record.loggerId] = LogTextLayout::padName(name);
+            paddedFrom[record.loggerId] = name;
+        }
+
+        std::chrono::system_clock::time_point timestamp(
+            std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                std::chrono::nanoseconds(record.timestampNanoseconds)));
+
+        LogTextLayout::formatPrefix(line, timestamp, paddedNames[record.loggerId], record.level, timestampCache);
+        if (const LogBinaryCallSite* site = reader.callSite(record.callSite)) {
+            line.append('[');
+            line.append(std::to_string(record.thread));
+            line.append(' ');
+            line.append(site->file);
+            line.append(':');
+            line.append(std::to_string(site->line));
+            line.append(' ');
+            line.append(site->function);
+            line.append("] ", 2);
+        }
+        line.append(record.message);
+        line.append('\n');
+        output.write(line.data(), static_cast<std::streamsize>(line.size()));
+        ++records;
+    }
+
+    output.flush();
+    if (reader.failed()) {
+        std::cerr << "Stopped at corrupt data after " << records << " records" << std::endl;
+        return 1;
+    }
+    return 0;
+}